@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/Linux/AssetBankImpl.h"
+#include "third_party/facebook/Audio360/Linux/AudioFormatDecoderFactory.h"
+#include "third_party/facebook/Audio360/Linux/MemoryStream.h"
+
+#include <string.h>
+
+namespace TBE {
+namespace {
+const char kMagic[4] = {'T', 'B', 'E', 'B'};
+const size_t kOffsetField = kAssetBankNameSize;
+const size_t kLengthField = kOffsetField + 8;
+const size_t kCodecField = kLengthField + 8;
+const size_t kChannelsField = kCodecField + 4;
+
+uint32_t readLE32(const char* data) {
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+  return static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8) |
+      (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+uint64_t readLE64(const char* data) {
+  return static_cast<uint64_t>(readLE32(data)) | (static_cast<uint64_t>(readLE32(data + 4)) << 32);
+}
+} // namespace
+
+AssetBankImpl::AssetBankImpl() {}
+
+AssetBankImpl::~AssetBankImpl() {}
+
+EngineError AssetBankImpl::open(const char* nameAndPath) {
+  file_.reset();
+  numAssets_ = 0;
+  headers_.clear();
+
+  std::shared_ptr<MappedFile> file;
+  const EngineError error = MappedFile::open(file, nameAndPath);
+  if (error != EngineError::OK) {
+    return error;
+  }
+
+  const char* data = file->getData();
+  const size_t size = file->getSize();
+  if (size < kAssetBankHeaderSize || memcmp(data, kMagic, sizeof(kMagic)) != 0 ||
+      readLE32(data + 4) != kAssetBankVersion) {
+    return EngineError::INVALID_HEADER;
+  }
+  const size_t numAssets = readLE32(data + 8);
+  if (numAssets > (size - kAssetBankHeaderSize) / kAssetBankEntrySize) {
+    return EngineError::INVALID_HEADER;
+  }
+
+  file_ = file;
+  numAssets_ = numAssets;
+  const size_t indexEnd = kAssetBankHeaderSize + numAssets * kAssetBankEntrySize;
+  for (size_t i = 0; i < numAssets; ++i) {
+    // Sorted names are what lets findAsset() binary search the index in place
+    if (!checkEntry(i, indexEnd) ||
+        (i > 0 && strcmp(getEntry(i - 1).name, getEntry(i).name) >= 0)) {
+      file_.reset();
+      numAssets_ = 0;
+      return EngineError::INVALID_HEADER;
+    }
+  }
+  headers_.resize(numAssets);
+  return EngineError::OK;
+}
+
+bool AssetBankImpl::checkEntry(size_t index, size_t indexEnd) const {
+  const char* entry = file_->getData() + kAssetBankHeaderSize + index * kAssetBankEntrySize;
+  if (entry[0] == '\0' || memchr(entry, '\0', kAssetBankNameSize) == nullptr) {
+    return false;
+  }
+
+  const uint64_t offset = readLE64(entry + kOffsetField);
+  const uint64_t length = readLE64(entry + kLengthField);
+  const uint32_t codec = readLE32(entry + kCodecField);
+  const uint32_t numChannels = readLE32(entry + kChannelsField);
+  const uint64_t size = file_->getSize();
+  return offset >= indexEnd && offset <= size && length <= size - offset &&
+      codec <= static_cast<uint32_t>(AssetCodec::TBE) && numChannels <= INT32_MAX;
+}
+
+AssetBankEntry AssetBankImpl::getEntry(size_t index) const {
+  const char* entry = file_->getData() + kAssetBankHeaderSize + index * kAssetBankEntrySize;
+  AssetBankEntry result;
+  result.name = entry;
+  result.descriptor.offsetInBytes = static_cast<size_t>(readLE64(entry + kOffsetField));
+  result.descriptor.lengthInBytes = static_cast<size_t>(readLE64(entry + kLengthField));
+  result.codec = static_cast<AssetCodec>(readLE32(entry + kCodecField));
+  result.numChannels = static_cast<int32_t>(readLE32(entry + kChannelsField));
+  return result;
+}
+
+size_t AssetBankImpl::getNumAssets() const {
+  return numAssets_;
+}
+
+EngineError AssetBankImpl::getAsset(size_t index, AssetBankEntry& entry) const {
+  if (index >= numAssets_) {
+    return EngineError::NO_ASSET;
+  }
+  entry = getEntry(index);
+  return EngineError::OK;
+}
+
+bool AssetBankImpl::findIndex(const char* name, size_t& index) const {
+  if (name == nullptr) {
+    return false;
+  }
+
+  size_t first = 0;
+  size_t last = numAssets_;
+  while (first < last) {
+    const size_t middle = first + (last - first) / 2;
+    const int order = strcmp(getEntry(middle).name, name);
+    if (order == 0) {
+      index = middle;
+      return true;
+    }
+    if (order < 0) {
+      first = middle + 1;
+    } else {
+      last = middle;
+    }
+  }
+  return false;
+}
+
+EngineError AssetBankImpl::findAsset(const char* name, AssetBankEntry& entry) const {
+  size_t index = 0;
+  if (!findIndex(name, index)) {
+    return EngineError::NO_ASSET;
+  }
+  entry = getEntry(index);
+  return EngineError::OK;
+}
+
+EngineError AssetBankImpl::openStream(const char* name, IOStream*& stream) {
+  stream = nullptr;
+  AssetBankEntry entry;
+  const EngineError error = findAsset(name, entry);
+  if (error != EngineError::OK) {
+    return error;
+  }
+  stream = new MemoryStream(
+      file_->getData() + entry.descriptor.offsetInBytes, entry.descriptor.lengthInBytes, file_);
+  return EngineError::OK;
+}
+
+EngineError AssetBankImpl::createDecoder(
+    AudioFormatDecoder*& decoder,
+    const char* name,
+    int32_t maxBufferSizePerChannel,
+    float outputSampleRate) {
+  decoder = nullptr;
+  size_t index = 0;
+  if (!findIndex(name, index)) {
+    return EngineError::NO_ASSET;
+  }
+  const AssetBankEntry entry = getEntry(index);
+  MemoryStream* stream = new MemoryStream(
+      file_->getData() + entry.descriptor.offsetInBytes, entry.descriptor.lengthInBytes, file_);
+  if (entry.codec != AssetCodec::WAV) {
+    return createAudioFormatDecoder(
+        decoder, stream, true, entry.codec, maxBufferSizePerChannel, outputSampleRate);
+  }
+
+  // The mapping never changes, so neither does the header or the result of parsing it
+  CachedHeader cached;
+  {
+    std::lock_guard<std::mutex> lock(headersMutex_);
+    if (!headers_[index].parsed) {
+      headers_[index].error = WavFormatDecoder::parseHeader(*stream, headers_[index].header);
+      headers_[index].parsed = true;
+    }
+    cached = headers_[index];
+  }
+  if (cached.error != EngineError::OK) {
+    delete stream;
+    return cached.error;
+  }
+
+  WavFormatDecoder* wav = new WavFormatDecoder(maxBufferSizePerChannel, outputSampleRate);
+  const EngineError error = wav->open(stream, true, cached.header);
+  if (error != EngineError::OK) {
+    delete wav;
+    return error;
+  }
+  decoder = wav;
+  return EngineError::OK;
+}
+} // namespace TBE
+
+extern "C" {
+
+TBE::EngineError TBE_CreateAssetBank(TBE::AssetBank*& bank, const char* nameAndPath) {
+  bank = nullptr;
+  TBE::AssetBankImpl* impl = new TBE::AssetBankImpl();
+  const TBE::EngineError error = impl->open(nameAndPath);
+  if (error != TBE::EngineError::OK) {
+    delete impl;
+    return error;
+  }
+  bank = impl;
+  return TBE::EngineError::OK;
+}
+}
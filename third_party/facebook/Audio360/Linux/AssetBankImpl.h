@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include "third_party/facebook/Audio360/Linux/MappedFile.h"
+#include "third_party/facebook/Audio360/Linux/WavFormatDecoder.h"
+#include "third_party/facebook/Audio360/include/TBE_AssetBank.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace TBE {
+/// AssetBank that reads its index and assets straight from a memory mapping of the bank file.
+class AssetBankImpl : public AssetBank {
+ public:
+  AssetBankImpl();
+  ~AssetBankImpl() override;
+
+  /// Map a bank file and check its header and index.
+  /// \return EngineError::OK, EngineError::ERROR_OPENING_FILE, EngineError::MEMORY_MAP_FAIL or
+  /// EngineError::INVALID_HEADER
+  EngineError open(const char* nameAndPath);
+
+  size_t getNumAssets() const override;
+  EngineError getAsset(size_t index, AssetBankEntry& entry) const override;
+  EngineError findAsset(const char* name, AssetBankEntry& entry) const override;
+  EngineError openStream(const char* name, IOStream*& stream) override;
+  EngineError createDecoder(
+      AudioFormatDecoder*& decoder,
+      const char* name,
+      int32_t maxBufferSizePerChannel,
+      float outputSampleRate) override;
+
+ private:
+  /// Header of a WAV asset, parsed on first use
+  struct CachedHeader {
+    bool parsed{false};
+    EngineError error{EngineError::OK}; /// Result of parsing the header
+    WavFormatDecoder::Header header;
+  };
+
+  /// Decode an entry of the index. The index must have been checked.
+  AssetBankEntry getEntry(size_t index) const;
+
+  /// Binary search the index for an asset.
+  /// \return true if the asset was found
+  bool findIndex(const char* name, size_t& index) const;
+
+  /// \return true if an entry of the index is well formed
+  bool checkEntry(size_t index, size_t indexEnd) const;
+
+  std::shared_ptr<MappedFile> file_;
+  size_t numAssets_{0};
+  std::mutex headersMutex_;
+  std::vector<CachedHeader> headers_; /// One per asset, guarded by headersMutex_
+};
+} // namespace TBE
@@ -0,0 +1,905 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/Linux/AudioEngineImpl.h"
+#include "third_party/facebook/Audio360/include/TBE_SpatialBatch.hh"
+
+#include <algorithm>
+#include <chrono>
+
+namespace TBE {
+namespace {
+const float kDefaultSampleRate = 44100.f;
+const int32_t kDefaultBufferSize = 1024;
+const size_t kEventQueueSize = 256;
+const auto kDecoderInterval = std::chrono::milliseconds(10);
+const size_t kPoseQueueSize = 256;
+
+template <typename Duration>
+double toMilliseconds(Duration duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+/// Add one block to the timing of a stage.
+void addToStage(DSPStageStatistics& stage, double ms) {
+  ++stage.numBlocks;
+  stage.totalMs += ms;
+  stage.maxMs = std::max(stage.maxMs, ms);
+
+  // Bucket i counts 2^i to 2^(i+1) microseconds
+  const double microseconds = ms * 1000.0;
+  int32_t bucket = 0;
+  while (bucket < kNumDSPHistogramBuckets - 1 && microseconds >= static_cast<double>(2 << bucket)) {
+    ++bucket;
+  }
+  ++stage.histogram[bucket];
+}
+} // namespace
+
+AudioEngineImpl::AudioEngineImpl(const EngineInitSettings& settings) : settings_(settings) {}
+
+AudioEngineImpl::~AudioEngineImpl() {
+  // The workers of the engine's own cache wake the decoder thread
+  pcmCache_.reset();
+
+  if (decoderThread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(jobsMutex_);
+      quit_ = true;
+    }
+    decoderCondition_.notify_one();
+    decoderThread_.join();
+  }
+
+  // Stop dispatching before the objects that own the callbacks go away
+  events_.reset();
+}
+
+EngineError AudioEngineImpl::init() {
+  AudioSettings& audio = settings_.audioSettings;
+  if (audio.deviceType != AudioDeviceType::DISABLED) {
+    return EngineError::NO_AUDIO_DEVICE;
+  }
+  if (audio.sampleRate < 0.f) {
+    return EngineError::INVALID_SAMPLE_RATE;
+  }
+  if (audio.bufferSize < 0) {
+    return EngineError::INVALID_BUFFER_SIZE;
+  }
+  audio.sampleRate = audio.sampleRate == 0.f ? kDefaultSampleRate : audio.sampleRate;
+  audio.bufferSize = audio.bufferSize == 0 ? kDefaultBufferSize : audio.bufferSize;
+
+  const MemorySettings& memory = settings_.memorySettings;
+  const size_t numAudioObjects = static_cast<size_t>(std::max(0, memory.audioObjectPoolSize));
+  const size_t numQueues = static_cast<size_t>(std::max(0, memory.spatDecoderQueuePoolSize));
+  const size_t numFiles = static_cast<size_t>(std::max(0, memory.spatDecoderFilePoolSize));
+  const size_t queueSize = static_cast<size_t>(std::max(0, memory.spatQueueSizePerChannel));
+  const size_t bufferSize = static_cast<size_t>(audio.bufferSize);
+
+  events_.reset(new EventDispatcher(settings_.threads.useEventThread, kEventQueueSize));
+  loudness_.reset(new LoudnessMeter(audio.sampleRate));
+
+  audioObjects_.allocate(numAudioObjects, [this] { return new AudioObjectImpl(*this); });
+  queues_.allocate(numQueues, [this, queueSize] {
+    return new SpatDecoderQueueImpl(*events_, settings_.audioSettings.sampleRate, queueSize);
+  });
+  files_.allocate(numFiles, [this] { return new SpatDecoderFileImpl(*this); });
+  virtualizers_.allocate(
+      memory.speakersVirtualizersPoolSize, [this] { return new SpeakersVirtualizerImpl(*this); });
+
+  // Reserve everything the audio thread touches so that it never allocates
+  const size_t numSources = numAudioObjects + numQueues + numFiles;
+  sources_.reserve(numSources);
+  jobs_.reserve(numSources);
+  decoderJobs_.reserve(numSources);
+  mix_.resize(bufferSize * 2);
+  gains_.resize(bufferSize);
+  scratch_.resize(bufferSize * kMaxChannels);
+  spatial_.x.resize(numSources);
+  spatial_.y.resize(numSources);
+  spatial_.z.resize(numSources);
+  spatial_.azimuth.resize(numSources);
+  spatial_.elevation.resize(numSources);
+  spatial_.distance.resize(numSources);
+  spatial_.index.resize(numSources);
+  poses_.resize(kPoseQueueSize);
+  voices_.priority.resize(numSources);
+  voices_.gain.resize(numSources);
+  voices_.culled.resize(numSources);
+  voices_.candidates.resize(numSources);
+
+  if (settings_.threads.useDecoderThread) {
+    decoderThread_ = std::thread(&AudioEngineImpl::decoderThreadLoop, this);
+  }
+  if (settings_.extensions.pcmCacheSizeInBytes > 0) {
+    pcmCache_.reset(new PcmCache(
+        settings_.extensions.pcmCacheSizeInBytes,
+        settings_.extensions.numCacheThreads,
+        audio.bufferSize,
+        audio.sampleRate,
+        [this] { wakeDecoderThread(); }));
+  }
+  return EngineError::OK;
+}
+
+EngineError AudioEngineImpl::start() {
+  return EngineError::OK;
+}
+
+EngineError AudioEngineImpl::suspend() {
+  return EngineError::OK;
+}
+
+void AudioEngineImpl::setListenerRotation(TBVector forwardVector, TBVector upVector) {
+  setListenerRotation(TBQuat::getQuatFromForwardAndUpVectors(forwardVector, upVector));
+}
+
+void AudioEngineImpl::setListenerRotation(TBQuat quat) {
+  listenerRotation_.store(QuatValue(quat));
+}
+
+void AudioEngineImpl::setListenerRotation(float yaw, float pitch, float roll) {
+  const float toRadians = M_PIF / 180.f;
+  setListenerRotation(
+      TBQuat::getQuatFromEulerAngles(-pitch * toRadians, yaw * toRadians, -roll * toRadians));
+}
+
+void AudioEngineImpl::setListenerPosition(TBVector position) {
+  listenerPosition_.store(position);
+}
+
+TBVector AudioEngineImpl::getListenerPosition() const {
+  return listenerPosition_.load();
+}
+
+TBQuat AudioEngineImpl::getListenerRotation() const {
+  return listenerRotation_.load().toQuat();
+}
+
+TBVector AudioEngineImpl::getListenerForward() const {
+  return TBQuat::getForwardFromQuat(getListenerRotation());
+}
+
+TBVector AudioEngineImpl::getListenerUp() const {
+  return TBQuat::getUpFromQuat(getListenerRotation());
+}
+
+EngineError AudioEngineImpl::enablePositionalTracking(
+    bool enable,
+    TBVector initialListenerPosition) {
+  positionalTracking_.store(enable);
+  if (enable) {
+    listenerPosition_.store(initialListenerPosition);
+  }
+  return EngineError::OK;
+}
+
+bool AudioEngineImpl::positionalTrackingEnabled() const {
+  return positionalTracking_.load();
+}
+
+EngineError AudioEngineImpl::setListenerPoseSettings(ListenerPoseSettings settings) {
+  if (settings.subBlockSize < 0) {
+    return EngineError::INVALID_BUFFER_SIZE;
+  }
+  settings.predictionMs = std::max(0.f, settings.predictionMs);
+  poseSettings_.store(settings);
+  return EngineError::OK;
+}
+
+ListenerPoseSettings AudioEngineImpl::getListenerPoseSettings() const {
+  return poseSettings_.load();
+}
+
+EngineError AudioEngineImpl::pushListenerPose(const ListenerPose& pose) {
+  if (!poseSettings_.load().enabled) {
+    return EngineError::NOT_SUPPORTED;
+  }
+  // Producers are serialised rather than lock-free: poses_ has a single producer, and the order
+  // check and the push must be atomic for the poses to be queued in order of DSP time
+  std::lock_guard<std::mutex> lock(poseMutex_);
+  if (pose.dspTime <= lastPoseTime_) {
+    return EngineError::FAIL;
+  }
+
+  PoseSample sample;
+  sample.rotation = QuatValue(pose.rotation);
+  sample.position = pose.position;
+  sample.dspTime = pose.dspTime;
+  if (!poses_.push(sample)) {
+    return EngineError::QUEUE_FULL;
+  }
+  lastPoseTime_ = pose.dspTime;
+  return EngineError::OK;
+}
+
+int AudioEngineImpl::getBufferSize() const {
+  return settings_.audioSettings.bufferSize;
+}
+
+float AudioEngineImpl::getSampleRate() const {
+  return settings_.audioSettings.sampleRate;
+}
+
+EngineError AudioEngineImpl::getAudioMix(float* buffer, int numOfSamples, int numOfChannels) {
+  if (numOfChannels != 2) {
+    return EngineError::INVALID_CHANNEL_COUNT;
+  }
+  if (buffer == nullptr || numOfSamples < 0 || numOfSamples % numOfChannels != 0) {
+    return EngineError::INVALID_BUFFER_SIZE;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(renderMutex_);
+    // Render in sub-blocks so that the listener's pose is updated more often than once a buffer
+    const ListenerPoseSettings poseSettings = poseSettings_.load();
+    size_t bufferSize = static_cast<size_t>(getBufferSize());
+    if (poseSettings.enabled && poseSettings.subBlockSize > 0) {
+      bufferSize = std::min(bufferSize, static_cast<size_t>(poseSettings.subBlockSize));
+    }
+    size_t numFrames = static_cast<size_t>(numOfSamples / numOfChannels);
+    while (numFrames > 0) {
+      const size_t blockSize = std::min(numFrames, bufferSize);
+      renderBlock(buffer, blockSize);
+      buffer += blockSize * 2;
+      numFrames -= blockSize;
+    }
+  }
+  wakeDecoderThread();
+  return EngineError::OK;
+}
+
+void AudioEngineImpl::renderBlock(float* output, size_t numFrames) {
+  const Clock::time_point blockStart = Clock::now();
+  BlockStatistics blockStatistics;
+  MixContext context;
+  context.numFrames = numFrames;
+  context.sampleRate = getSampleRate();
+  context.dspTime = dspTime_.load(std::memory_order_relaxed);
+
+  // The renderers ramp towards the pose over the block, so it is the pose at the end of the block
+  const ListenerPoseSettings poseSettings = poseSettings_.load();
+  if (!poseSettings.enabled ||
+      !getListenerPose(
+          context.dspTime + static_cast<int64_t>(numFrames),
+          poseSettings,
+          context.listenerRotation,
+          context.listenerPosition)) {
+    context.listenerRotation = listenerRotation_.load().toQuat();
+    context.listenerPosition = listenerPosition_.load();
+  }
+  context.gains = gains_.data();
+  context.scratch = scratch_.data();
+  context.statistics = &blockStatistics;
+
+  // Spatial parameters of all sources in one batch rather than one at a time while rendering
+  size_t numSpatial = 0;
+  for (size_t i = 0; i < sources_.size(); ++i) {
+    TBVector position;
+    spatial_.index[i] = -1;
+    if (sources_[i]->getRelativePosition(context, position)) {
+      spatial_.x[numSpatial] = position.x;
+      spatial_.y[numSpatial] = position.y;
+      spatial_.z[numSpatial] = position.z;
+      spatial_.index[i] = static_cast<int32_t>(numSpatial++);
+    }
+  }
+  TBSpatialBatch::getAedFromQuat(
+      context.listenerRotation,
+      TBVector::zero(),
+      spatial_.x.data(),
+      spatial_.y.data(),
+      spatial_.z.data(),
+      numSpatial,
+      spatial_.azimuth.data(),
+      spatial_.elevation.data(),
+      spatial_.distance.data());
+  selectVoices(context);
+  const Clock::time_point decodeStart = Clock::now();
+
+  // Culled sources keep time without decoding
+  for (size_t i = 0; i < sources_.size(); ++i) {
+    if (!voices_.culled[i] && sources_[i]->decodesInAudioCallback()) {
+      sources_[i]->runDecoderJob();
+    }
+  }
+  const Clock::time_point decodeEnd = Clock::now();
+
+  float* mix = mix_.data();
+  std::fill(mix, mix + numFrames * 2, 0.f);
+  const Clock::time_point spatialiseStart = Clock::now();
+  for (size_t i = 0; i < sources_.size(); ++i) {
+    Aed aed;
+    context.sourceAed = getSourceAed(i, aed);
+    if (voices_.culled[i]) {
+      sources_[i]->renderVirtual(context, mix);
+      ++blockStatistics.numVirtualVoices;
+    } else {
+      sources_[i]->render(context, mix);
+      ++blockStatistics.numVoices;
+    }
+  }
+  const Clock::time_point spatialiseEnd = Clock::now();
+
+  const TestTone tone = testTone_.load();
+  if (tone.enabled) {
+    const double increment = 2.0 * M_PI * tone.frequency / context.sampleRate;
+    for (size_t i = 0; i < numFrames; ++i) {
+      const float sample = tone.gain * static_cast<float>(std::sin(testTonePhase_));
+      mix[2 * i] = sample;
+      mix[2 * i + 1] = sample;
+      testTonePhase_ = std::fmod(testTonePhase_ + increment, 2.0 * M_PI);
+    }
+  }
+
+  if (loudnessEnabled_.load(std::memory_order_relaxed)) {
+    loudness_->process(mix, numFrames);
+  }
+
+  const MixCallbackInfo callback = mixCallback_.load();
+  if (callback.callback) {
+    callback.callback(mix, 2, numFrames, callback.userData);
+  }
+
+  std::copy(mix, mix + numFrames * 2, output);
+  const Clock::time_point mixEnd = Clock::now();
+
+  publishDSPStatistics(
+      context,
+      blockStatistics,
+      toMilliseconds(decodeEnd - decodeStart),
+      toMilliseconds(spatialiseEnd - spatialiseStart),
+      toMilliseconds((spatialiseStart - decodeEnd) + (mixEnd - spatialiseEnd)),
+      toMilliseconds(mixEnd - blockStart));
+  dspTime_.fetch_add(static_cast<int64_t>(numFrames), std::memory_order_relaxed);
+}
+
+bool AudioEngineImpl::getListenerPose(
+    int64_t dspTime,
+    const ListenerPoseSettings& settings,
+    TBQuat& rotation,
+    TBVector& position) {
+  // Move on to the poses that are due
+  PoseSample next;
+  while (poses_.peek(next) && next.dspTime <= dspTime) {
+    poses_.pop(next);
+    poseHistory_[0] = poseHistory_[1];
+    poseHistory_[1] = next;
+    numPoseHistory_ = std::min(numPoseHistory_ + 1, 2);
+  }
+  const bool haveNext = poses_.peek(next);
+
+  if (numPoseHistory_ == 0) {
+    // Before the first pose
+    if (!haveNext) {
+      return false;
+    }
+    rotation = next.rotation.toQuat();
+    position = next.position;
+    return true;
+  }
+
+  const PoseSample& latest = poseHistory_[1];
+  if (haveNext) {
+    const float t = static_cast<float>(dspTime - latest.dspTime) /
+        static_cast<float>(next.dspTime - latest.dspTime);
+    rotation = TBQuat::slerp(latest.rotation.toQuat(), next.rotation.toQuat(), t);
+    position = latest.position + (next.position - latest.position) * t;
+    return true;
+  }
+
+  // Past the newest pose: carry on at the velocity of the last two poses, up to the horizon
+  const int64_t horizon =
+      static_cast<int64_t>(settings.predictionMs * getSampleRate() / 1000.f);
+  const int64_t ahead = std::min(dspTime - latest.dspTime, horizon);
+  if (numPoseHistory_ < 2 || ahead <= 0) {
+    rotation = latest.rotation.toQuat();
+    position = latest.position;
+    return true;
+  }
+  const PoseSample& previous = poseHistory_[0];
+  const float t =
+      1.f + static_cast<float>(ahead) / static_cast<float>(latest.dspTime - previous.dspTime);
+  rotation = TBQuat::slerp(previous.rotation.toQuat(), latest.rotation.toQuat(), t);
+  position = previous.position + (latest.position - previous.position) * t;
+  return true;
+}
+
+const Aed* AudioEngineImpl::getSourceAed(size_t index, Aed& aed) const {
+  const int32_t batchIndex = spatial_.index[index];
+  if (batchIndex < 0) {
+    return nullptr;
+  }
+  aed.set(
+      spatial_.azimuth[batchIndex], spatial_.elevation[batchIndex], spatial_.distance[batchIndex]);
+  return &aed;
+}
+
+void AudioEngineImpl::selectVoices(MixContext& context) {
+  size_t numCandidates = 0;
+  for (size_t i = 0; i < sources_.size(); ++i) {
+    Aed aed;
+    context.sourceAed = getSourceAed(i, aed);
+    voices_.culled[i] = 0;
+    if (sources_[i]->getAudibility(context, voices_.priority[i], voices_.gain[i])) {
+      if (voices_.gain[i] > 0.f) {
+        voices_.candidates[numCandidates++] = static_cast<uint32_t>(i);
+      } else {
+        voices_.culled[i] = 1;
+      }
+    }
+  }
+  context.sourceAed = nullptr;
+
+  const size_t maxVoices =
+      static_cast<size_t>(std::max(0, settings_.extensions.maxActiveVoices));
+  if (maxVoices == 0 || numCandidates <= maxVoices) {
+    return;
+  }
+
+  // Partition rather than sort: only the set of voices that make the cut matters
+  uint32_t* candidates = voices_.candidates.data();
+  const std::vector<int32_t>& priority = voices_.priority;
+  const std::vector<float>& gain = voices_.gain;
+  std::nth_element(
+      candidates,
+      candidates + maxVoices,
+      candidates + numCandidates,
+      [&priority, &gain](uint32_t a, uint32_t b) {
+        if (priority[a] != priority[b]) {
+          return priority[a] > priority[b];
+        }
+        if (gain[a] != gain[b]) {
+          return gain[a] > gain[b];
+        }
+        return a < b;
+      });
+  for (size_t i = maxVoices; i < numCandidates; ++i) {
+    voices_.culled[candidates[i]] = 1;
+  }
+}
+
+void AudioEngineImpl::publishDSPStatistics(
+    const MixContext& context,
+    const BlockStatistics& block,
+    double decodeMs,
+    double spatialiseMs,
+    double mixMs,
+    double blockMs) {
+  if (resetDSPStatistics_.exchange(false)) {
+    statistics_ = DSPStatistics();
+  }
+
+  addToStage(statistics_.decode, decodeMs);
+  addToStage(statistics_.spatialise, spatialiseMs);
+  addToStage(statistics_.mix, mixMs);
+  addToStage(statistics_.block, blockMs);
+  if (blockMs > static_cast<double>(context.numFrames) * 1000.0 / context.sampleRate) {
+    ++statistics_.numOverruns;
+  }
+  statistics_.numStarvations += block.numStarvations;
+  statistics_.numVoices = block.numVoices;
+  statistics_.numActiveVoices = block.numActiveVoices;
+  statistics_.decoderBacklog = block.decoderBacklog;
+  statistics_.numVirtualVoices = block.numVirtualVoices;
+  dspStatistics_.store(statistics_);
+
+  if (dspTraceEnabled_.load(std::memory_order_relaxed)) {
+    DSPTraceEntry entry;
+    entry.dspTime = context.dspTime;
+    entry.numFrames = static_cast<int32_t>(context.numFrames);
+    entry.numActiveVoices = block.numActiveVoices;
+    entry.decoderBacklog = block.decoderBacklog;
+    entry.decodeMs = static_cast<float>(decodeMs);
+    entry.spatialiseMs = static_cast<float>(spatialiseMs);
+    entry.mixMs = static_cast<float>(mixMs);
+    entry.blockMs = static_cast<float>(blockMs);
+    const uint64_t index = dspTraceIndex_.load(std::memory_order_relaxed);
+    dspTrace_[index % kDSPTraceSize].store(entry);
+    dspTraceIndex_.store(index + 1, std::memory_order_release);
+  }
+}
+
+EngineError AudioEngineImpl::setAudioMixCallback(AudioMixCallback callback, void* userData) {
+  MixCallbackInfo info;
+  info.callback = callback;
+  info.userData = userData;
+  mixCallback_.store(info);
+  return EngineError::OK;
+}
+
+void AudioEngineImpl::addSource(MixerSource* source) {
+  {
+    std::lock_guard<std::mutex> lock(renderMutex_);
+    sources_.push_back(source);
+  }
+  std::lock_guard<std::mutex> lock(jobsMutex_);
+  jobs_.push_back(source);
+}
+
+void AudioEngineImpl::removeSource(MixerSource* source) {
+  {
+    std::lock_guard<std::mutex> lock(renderMutex_);
+    sources_.erase(std::remove(sources_.begin(), sources_.end(), source), sources_.end());
+  }
+  // Without the render lock, so that the audio thread is not held up by a decode in progress
+  std::unique_lock<std::mutex> lock(jobsMutex_);
+  jobs_.erase(std::remove(jobs_.begin(), jobs_.end(), source), jobs_.end());
+  ++numRemovedJobs_;
+  retireCondition_.wait(lock, [this, source] { return decodingJob_ != source; });
+}
+
+EngineError AudioEngineImpl::createSpatDecoderQueue(SpatDecoderQueue*& spatDecoder) {
+  SpatDecoderQueueImpl* queue = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(poolMutex_);
+    queue = queues_.acquire();
+  }
+  if (queue == nullptr) {
+    spatDecoder = nullptr;
+    return EngineError::NO_OBJECTS_IN_POOL;
+  }
+  queue->reset();
+  addSource(queue);
+  spatDecoder = queue;
+  return EngineError::OK;
+}
+
+void AudioEngineImpl::destroySpatDecoderQueue(SpatDecoderQueue*& spatDecoder) {
+  SpatDecoderQueueImpl* queue = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(poolMutex_);
+    queue = queues_.find(spatDecoder);
+  }
+  if (queue == nullptr) {
+    return;
+  }
+  // The pool lock is not held here as the object may be destroyed from an event callback
+  removeSource(queue);
+  events_->removeOwner(spatDecoder);
+  {
+    std::lock_guard<std::mutex> lock(poolMutex_);
+    queues_.release(queue);
+  }
+  spatDecoder = nullptr;
+}
+
+EngineError AudioEngineImpl::createSpeakersVirtualizer(
+    SpeakersVirtualizer*& virtualizer,
+    SpeakerPosition const* layout,
+    size_t channelBufferSizeInSamples) {
+  SpeakersVirtualizerImpl* impl = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(poolMutex_);
+    impl = virtualizers_.acquire();
+  }
+  virtualizer = nullptr;
+  if (impl == nullptr) {
+    return EngineError::NO_OBJECTS_IN_POOL;
+  }
+
+  const EngineError error = impl->create(layout, channelBufferSizeInSamples);
+  if (error != EngineError::OK) {
+    std::lock_guard<std::mutex> lock(poolMutex_);
+    virtualizers_.release(impl);
+    return error;
+  }
+  virtualizer = impl;
+  return EngineError::OK;
+}
+
+void AudioEngineImpl::destroySpeakersVirtualizer(SpeakersVirtualizer*& virtualizer) {
+  SpeakersVirtualizerImpl* impl = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(poolMutex_);
+    impl = virtualizers_.find(virtualizer);
+  }
+  if (impl == nullptr) {
+    return;
+  }
+  impl->release();
+  events_->removeOwner(virtualizer);
+  {
+    std::lock_guard<std::mutex> lock(poolMutex_);
+    virtualizers_.release(impl);
+  }
+  virtualizer = nullptr;
+}
+
+EngineError AudioEngineImpl::createSpatDecoderFile(SpatDecoderFile*& spatDecoder, Options options) {
+  SpatDecoderFileImpl* file = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(poolMutex_);
+    file = files_.acquire();
+  }
+  if (file == nullptr) {
+    spatDecoder = nullptr;
+    return EngineError::NO_OBJECTS_IN_POOL;
+  }
+  file->reset(options);
+  addSource(file);
+  spatDecoder = file;
+  return EngineError::OK;
+}
+
+void AudioEngineImpl::destroySpatDecoderFile(SpatDecoderFile*& spatDecoder) {
+  SpatDecoderFileImpl* file = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(poolMutex_);
+    file = files_.find(spatDecoder);
+  }
+  if (file == nullptr) {
+    return;
+  }
+  removeSource(file);
+  events_->removeOwner(spatDecoder);
+  file->release();
+  {
+    std::lock_guard<std::mutex> lock(poolMutex_);
+    files_.release(file);
+  }
+  spatDecoder = nullptr;
+}
+
+EngineError AudioEngineImpl::createAudioObject(AudioObject*& audioObject, Options options) {
+  AudioObjectImpl* object = acquireAudioObject(options);
+  audioObject = object;
+  return object ? EngineError::OK : EngineError::NO_OBJECTS_IN_POOL;
+}
+
+void AudioEngineImpl::destroyAudioObject(AudioObject*& audioObject) {
+  AudioObjectImpl* object = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(poolMutex_);
+    object = audioObjects_.find(audioObject);
+  }
+  if (object != nullptr) {
+    releaseAudioObject(object);
+    audioObject = nullptr;
+  }
+}
+
+EngineError AudioEngineImpl::preloadAsset(const char* nameAndPath, AssetDescriptor ad) {
+  if (!pcmCache_) {
+    return EngineError::NOT_SUPPORTED;
+  }
+  return pcmCache_->preload(nameAndPath, ad);
+}
+
+AudioObjectImpl* AudioEngineImpl::acquireAudioObject(Options options) {
+  AudioObjectImpl* object = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(poolMutex_);
+    object = audioObjects_.acquire();
+  }
+  if (object != nullptr) {
+    object->reset(options);
+    addSource(object);
+  }
+  return object;
+}
+
+void AudioEngineImpl::releaseAudioObject(AudioObjectImpl* object) {
+  removeSource(object);
+  events_->removeOwner(static_cast<AudioObject*>(object));
+  object->release();
+  std::lock_guard<std::mutex> lock(poolMutex_);
+  audioObjects_.release(object);
+}
+
+EngineError AudioEngineImpl::setEventCallback(EventCallback callback, void* userData) {
+  EventCallbackInfo info;
+  info.callback = callback;
+  info.userData = userData;
+  callback_.store(info);
+  return EngineError::OK;
+}
+
+void AudioEngineImpl::enableTestTone(bool enable, float frequency, float gain) {
+  TestTone tone;
+  tone.enabled = enable;
+  tone.frequency = frequency;
+  tone.gain = gain;
+  testTone_.store(tone);
+}
+
+int AudioEngineImpl::getVersionMajor() const {
+  return TBE_AUDIOENGINE_VERSION_MAJOR;
+}
+
+int AudioEngineImpl::getVersionMinor() const {
+  return TBE_AUDIOENGINE_VERSION_MINOR;
+}
+
+int AudioEngineImpl::getVersionPatch() const {
+  return TBE_AUDIOENGINE_VERSION_PATCH;
+}
+
+const char* AudioEngineImpl::getVersionHash() const {
+  return "host";
+}
+
+LoudnessStatistics AudioEngineImpl::getRenderedLoudness() {
+  return loudness_->getStatistics();
+}
+
+void AudioEngineImpl::resetLoudness() {
+  loudness_->reset();
+}
+
+void AudioEngineImpl::enableLoudness(bool enabled) {
+  loudnessEnabled_.store(enabled);
+}
+
+EngineError AudioEngineImpl::processEventsOnThisThread() {
+  return events_->processEventsOnThisThread();
+}
+
+int64_t AudioEngineImpl::getDSPTime() const {
+  return dspTime_.load(std::memory_order_relaxed);
+}
+
+DSPStatistics AudioEngineImpl::getDSPStatistics() const {
+  DSPStatistics statistics = dspStatistics_.load();
+  statistics.decoderThread = decoderStatistics_.load();
+  return statistics;
+}
+
+void AudioEngineImpl::resetDSPStatistics() {
+  resetDSPStatistics_.store(true);
+  resetDecoderStatistics_.store(true);
+}
+
+void AudioEngineImpl::enableDSPTrace(bool enabled) {
+  dspTraceEnabled_.store(enabled);
+}
+
+size_t AudioEngineImpl::getDSPTrace(DSPTraceEntry* entries, size_t maxEntries) const {
+  if (entries == nullptr) {
+    return 0;
+  }
+  const uint64_t traceSize = static_cast<uint64_t>(kDSPTraceSize);
+  const uint64_t end = dspTraceIndex_.load(std::memory_order_acquire);
+  const uint64_t count = std::min(std::min(end, traceSize), static_cast<uint64_t>(maxEntries));
+  const uint64_t begin = end - count;
+  for (uint64_t i = begin; i < end; ++i) {
+    entries[i - begin] = dspTrace_[i % traceSize].load();
+  }
+
+  // Drop the oldest entries if the audio thread wrapped around onto them during the copy
+  std::atomic_thread_fence(std::memory_order_acquire);
+  const uint64_t written = dspTraceIndex_.load(std::memory_order_relaxed);
+  const uint64_t firstValid = written + 1 > traceSize ? written + 1 - traceSize : 0;
+  const uint64_t numDropped = firstValid > begin ? std::min(count, firstValid - begin) : 0;
+  std::copy(entries + numDropped, entries + count, entries);
+  return static_cast<size_t>(count - numDropped);
+}
+
+EngineError AudioEngineImpl::setNumOutputBuffers(unsigned int numOfBuffers) {
+  (void)numOfBuffers;
+  return EngineError::NOT_SUPPORTED;
+}
+
+unsigned int AudioEngineImpl::getNumOutputBuffers() const {
+  return 1;
+}
+
+int32_t AudioEngineImpl::getOutputLatencySamples() const {
+  return 0;
+}
+
+double AudioEngineImpl::getOutputLatencyMs() const {
+  return 0.0;
+}
+
+const char* AudioEngineImpl::getOutputAudioDeviceName() const {
+  return "";
+}
+
+EventDispatcher& AudioEngineImpl::getEventDispatcher() {
+  return *events_;
+}
+
+std::unique_lock<std::mutex> AudioEngineImpl::lockRender() {
+  return std::unique_lock<std::mutex>(renderMutex_);
+}
+
+void AudioEngineImpl::wakeDecoderThread() {
+  if (decoderThread_.joinable()) {
+    decoderWake_.store(true);
+    decoderCondition_.notify_one();
+  }
+}
+
+bool AudioEngineImpl::usesDecoderThread() const {
+  return settings_.threads.useDecoderThread;
+}
+
+PcmCache* AudioEngineImpl::getPcmCache() {
+  return pcmCache_.get();
+}
+
+void AudioEngineImpl::setPcmCache(std::shared_ptr<PcmCache> cache) {
+  pcmCache_ = std::move(cache);
+}
+
+void AudioEngineImpl::decoderThreadLoop() {
+  std::unique_lock<std::mutex> lock(jobsMutex_);
+  while (!quit_) {
+    decoderJobs_.assign(jobs_.begin(), jobs_.end());
+    const uint64_t numRemovedJobs = numRemovedJobs_;
+    lock.unlock();
+
+    const Clock::time_point start = Clock::now();
+    for (MixerSource* job : decoderJobs_) {
+      {
+        // Skip the jobs removed since the copy was taken. Once decodingJob_ is set, removing
+        // the job waits for it to finish.
+        std::lock_guard<std::mutex> jobLock(jobsMutex_);
+        if (numRemovedJobs_ != numRemovedJobs &&
+            std::find(jobs_.begin(), jobs_.end(), job) == jobs_.end()) {
+          continue;
+        }
+        decodingJob_ = job;
+      }
+      if (!job->decodesInAudioCallback()) {
+        job->runDecoderJob();
+      }
+      {
+        std::lock_guard<std::mutex> jobLock(jobsMutex_);
+        decodingJob_ = nullptr;
+      }
+      retireCondition_.notify_all();
+    }
+    if (resetDecoderStatistics_.exchange(false)) {
+      decoderThreadStatistics_ = DSPStageStatistics();
+    }
+    addToStage(decoderThreadStatistics_, toMilliseconds(Clock::now() - start));
+    decoderStatistics_.store(decoderThreadStatistics_);
+
+    // The audio thread wakes us without the lock, so also poll in case a wake up is missed
+    lock.lock();
+    decoderCondition_.wait_for(lock, kDecoderInterval, [this] { return quit_ || decoderWake_; });
+    decoderWake_.store(false);
+  }
+}
+
+int32_t AudioEngine::getNumAudioDevices() {
+  return 0;
+}
+
+const char* AudioEngine::getAudioDeviceName(int index) {
+  (void)index;
+  return "";
+}
+
+const char* AudioEngine::getAudioDeviceNameFromId(wchar_t* id) {
+  (void)id;
+  return "";
+}
+} // namespace TBE
+
+TBE::EngineError TBE_CreateAudioEngine(
+    TBE::AudioEngine*& engine,
+    TBE::EngineInitSettings initSettings) {
+  TBE::AudioEngineImpl* impl = new TBE::AudioEngineImpl(initSettings);
+  const TBE::EngineError error = impl->init();
+  if (error != TBE::EngineError::OK) {
+    delete impl;
+    engine = nullptr;
+    return error;
+  }
+  engine = impl;
+  return TBE::EngineError::OK;
+}
+
+void TBE_DestroyAudioEngine(TBE::AudioEngine*& engine) {
+  delete engine;
+  engine = nullptr;
+}
+
+TBE::AudioEngineExtensions* TBE_GetAudioEngineExtensions(TBE::AudioEngine* engine) {
+  // Every AudioEngine is created by TBE_CreateAudioEngine or a SessionGroup
+  return engine != nullptr ? static_cast<TBE::AudioEngineImpl*>(engine) : nullptr;
+}
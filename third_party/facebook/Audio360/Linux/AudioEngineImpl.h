@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include "third_party/facebook/Audio360/Linux/AudioObjectImpl.h"
+#include "third_party/facebook/Audio360/Linux/EventDispatcher.h"
+#include "third_party/facebook/Audio360/Linux/LoudnessMeter.h"
+#include "third_party/facebook/Audio360/Linux/ObjectPool.h"
+#include "third_party/facebook/Audio360/Linux/PcmCache.h"
+#include "third_party/facebook/Audio360/Linux/RingBuffer.h"
+#include "third_party/facebook/Audio360/Linux/SpatDecoderFileImpl.h"
+#include "third_party/facebook/Audio360/Linux/SpatDecoderQueueImpl.h"
+#include "third_party/facebook/Audio360/Linux/SpeakersVirtualizerImpl.h"
+#include "third_party/facebook/Audio360/include/TBE_AudioEngine.h"
+#include "third_party/facebook/Audio360/include/TBE_AudioEngineExtensions.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace TBE {
+/// Engine for hosts without an audio device. Only AudioDeviceType::DISABLED is supported: the mix
+/// is rendered on the thread that calls getAudioMix(), as fast as the caller pulls it, which makes
+/// the engine suitable for offline rendering and for running on build and test machines.
+class AudioEngineImpl : public AudioEngine, public AudioEngineExtensions {
+ public:
+  explicit AudioEngineImpl(const EngineInitSettings& settings);
+  ~AudioEngineImpl() override;
+
+  /// Validate the settings, allocate the object pools and start the worker threads.
+  EngineError init();
+
+  EngineError start() override;
+  EngineError suspend() override;
+  void setListenerRotation(TBVector forwardVector, TBVector upVector) override;
+  void setListenerRotation(TBQuat quat) override;
+  void setListenerRotation(float yaw, float pitch, float roll) override;
+  void setListenerPosition(TBVector position) override;
+  TBVector getListenerPosition() const override;
+  TBQuat getListenerRotation() const override;
+  TBVector getListenerForward() const override;
+  TBVector getListenerUp() const override;
+  EngineError enablePositionalTracking(bool enable, TBVector initialListenerPosition) override;
+  bool positionalTrackingEnabled() const override;
+  int getBufferSize() const override;
+  float getSampleRate() const override;
+  EngineError getAudioMix(float* buffer, int numOfSamples, int numOfChannels) override;
+  EngineError setAudioMixCallback(AudioMixCallback callback, void* userData) override;
+  EngineError createSpatDecoderQueue(SpatDecoderQueue*& spatDecoder) override;
+  void destroySpatDecoderQueue(SpatDecoderQueue*& spatDecoder) override;
+  EngineError createSpeakersVirtualizer(
+      SpeakersVirtualizer*& virtualizer,
+      SpeakerPosition const* layout,
+      size_t channelBufferSizeInSamples) override;
+  void destroySpeakersVirtualizer(SpeakersVirtualizer*& virtualizer) override;
+  EngineError createSpatDecoderFile(SpatDecoderFile*& spatDecoder, Options options) override;
+  void destroySpatDecoderFile(SpatDecoderFile*& spatDecoder) override;
+  EngineError createAudioObject(AudioObject*& audioObject, Options options) override;
+  void destroyAudioObject(AudioObject*& audioObject) override;
+  EngineError setEventCallback(EventCallback callback, void* userData) override;
+  void enableTestTone(bool enable, float frequency, float gain) override;
+  int getVersionMajor() const override;
+  int getVersionMinor() const override;
+  int getVersionPatch() const override;
+  const char* getVersionHash() const override;
+  LoudnessStatistics getRenderedLoudness() override;
+  void resetLoudness() override;
+  void enableLoudness(bool enabled) override;
+  EngineError processEventsOnThisThread() override;
+  int64_t getDSPTime() const override;
+  EngineError setNumOutputBuffers(unsigned int numOfBuffers) override;
+  unsigned int getNumOutputBuffers() const override;
+  int32_t getOutputLatencySamples() const override;
+  double getOutputLatencyMs() const override;
+  const char* getOutputAudioDeviceName() const override;
+
+  // AudioEngineExtensions
+  EngineError preloadAsset(const char* nameAndPath, AssetDescriptor ad) override;
+  DSPStatistics getDSPStatistics() const override;
+  void resetDSPStatistics() override;
+  void enableDSPTrace(bool enabled) override;
+  size_t getDSPTrace(DSPTraceEntry* entries, size_t maxEntries) const override;
+  EngineError setListenerPoseSettings(ListenerPoseSettings settings) override;
+  ListenerPoseSettings getListenerPoseSettings() const override;
+  EngineError pushListenerPose(const ListenerPose& pose) override;
+
+  // Services for the engine's objects
+
+  EventDispatcher& getEventDispatcher();
+
+  /// Lock that excludes rendering. Taken by the client thread while attaching or detaching
+  /// sources. Must not be held when calling back into the engine's public interface.
+  std::unique_lock<std::mutex> lockRender();
+
+  /// Ask the decoder thread to top up the streaming buffers.
+  void wakeDecoderThread();
+
+  /// \return true if decoding happens on a separate thread
+  bool usesDecoderThread() const;
+
+  /// \return The cache of decoded assets, or nullptr if it is disabled
+  PcmCache* getPcmCache();
+
+  /// Use a cache shared with other engines instead of the engine's own. Must be called before any
+  /// object is created.
+  void setPcmCache(std::shared_ptr<PcmCache> cache);
+
+  /// Take an audio object from the pool and add it to the mix. Used by SpeakersVirtualizer.
+  /// \return The object or nullptr if the pool is exhausted
+  AudioObjectImpl* acquireAudioObject(Options options);
+
+  /// Remove an audio object from the mix and return it to the pool.
+  void releaseAudioObject(AudioObjectImpl* object);
+
+ private:
+  typedef std::chrono::steady_clock Clock;
+
+  struct MixCallbackInfo {
+    AudioMixCallback callback{nullptr};
+    void* userData{nullptr};
+  };
+
+  struct TestTone {
+    bool enabled{false};
+    float frequency{440.f};
+    float gain{0.5f};
+  };
+
+  /// Structure-of-arrays spatial parameters of the sources rendered in a block.
+  struct SpatialBatch {
+    std::vector<float> x, y, z;
+    std::vector<float> azimuth, elevation, distance;
+    std::vector<int32_t> index; /// Per source in sources_: index in the batch, or -1
+  };
+
+  /// Listener pose queued by pushListenerPose().
+  struct PoseSample {
+    QuatValue rotation;
+    TBVector position;
+    int64_t dspTime{0};
+  };
+
+  /// Voices ranked for virtualisation, per source in sources_.
+  struct VoiceSelection {
+    std::vector<int32_t> priority;
+    std::vector<float> gain;
+    std::vector<uint8_t> culled; /// If the source is rendered virtually this block
+    std::vector<uint32_t> candidates; /// Sources that can be culled
+  };
+
+  void addSource(MixerSource* source);
+  void removeSource(MixerSource* source);
+  void renderBlock(float* output, size_t numFrames);
+  /// Audio thread: the listener's pose at a DSP time from the queued poses.
+  /// \return false if no pose has been queued
+  bool getListenerPose(
+      int64_t dspTime,
+      const ListenerPoseSettings& settings,
+      TBQuat& rotation,
+      TBVector& position);
+  /// Audio thread: spatial parameters of a source of the current block, or nullptr if it has none.
+  const Aed* getSourceAed(size_t index, Aed& aed) const;
+  /// Audio thread: pick the sources to render this block and the ones to cull: the inaudible ones
+  /// and, beyond maxActiveVoices, the least important ones.
+  void selectVoices(MixContext& context);
+  /// Audio thread: add a block to the DSP statistics and the trace, and publish them.
+  /// \param spatialiseMs Time spent rendering the sources into the mix
+  /// \param mixMs Time spent clearing the mix before the sources and processing it after them
+  /// \param blockMs Time spent on the whole block, including the spatial parameters and voice
+  /// selection that come before the stages
+  void publishDSPStatistics(
+      const MixContext& context,
+      const BlockStatistics& block,
+      double decodeMs,
+      double spatialiseMs,
+      double mixMs,
+      double blockMs);
+  void decoderThreadLoop();
+
+  EngineInitSettings settings_;
+  std::unique_ptr<EventDispatcher> events_;
+  ObjectPool<AudioObjectImpl> audioObjects_;
+  ObjectPool<SpatDecoderQueueImpl> queues_;
+  ObjectPool<SpatDecoderFileImpl> files_;
+  ObjectPool<SpeakersVirtualizerImpl> virtualizers_;
+  std::mutex poolMutex_;
+
+  SeqLock<QuatValue> listenerRotation_;
+  SeqLock<TBVector> listenerPosition_;
+  std::atomic<bool> positionalTracking_{false};
+  SeqLock<ListenerPoseSettings> poseSettings_;
+  RingBuffer<PoseSample> poses_;
+  std::mutex poseMutex_; /// Serialises the producers of poses_
+  int64_t lastPoseTime_{INT64_MIN}; /// DSP time of the newest queued pose. Guarded by poseMutex_.
+  SeqLock<EventCallbackInfo> callback_;
+  SeqLock<MixCallbackInfo> mixCallback_;
+  SeqLock<TestTone> testTone_;
+  std::unique_ptr<LoudnessMeter> loudness_;
+  std::atomic<bool> loudnessEnabled_{false};
+  std::atomic<int64_t> dspTime_{0};
+  std::shared_ptr<PcmCache> pcmCache_;
+
+  // DSP statistics, published by the audio and decoder threads for any thread to read
+  SeqLock<DSPStatistics> dspStatistics_;
+  SeqLock<DSPStageStatistics> decoderStatistics_;
+  std::atomic<bool> resetDSPStatistics_{false};
+  std::atomic<bool> resetDecoderStatistics_{false};
+  std::atomic<bool> dspTraceEnabled_{false};
+  SeqLock<DSPTraceEntry> dspTrace_[kDSPTraceSize];
+  std::atomic<uint64_t> dspTraceIndex_{0}; /// Number of blocks recorded in the trace
+
+  // Rendering. The render mutex is taken before the jobs mutex.
+  std::mutex renderMutex_;
+  std::vector<MixerSource*> sources_;
+  std::vector<float> mix_;
+  std::vector<float> gains_;
+  std::vector<float> scratch_;
+  SpatialBatch spatial_;
+  VoiceSelection voices_;
+  PoseSample poseHistory_[2]; /// The two newest poses that are due, oldest first
+  int32_t numPoseHistory_{0};
+  double testTonePhase_{0.0};
+  DSPStatistics statistics_;
+
+  // Decoding. The decoder thread works from a copy of the jobs, so that sources can be added and
+  // removed without waiting for a whole pass. A source being removed waits until the decoder
+  // thread is done with it.
+  std::mutex jobsMutex_;
+  std::vector<MixerSource*> jobs_;
+  uint64_t numRemovedJobs_{0}; /// Guarded by the jobs mutex
+  MixerSource* decodingJob_{nullptr}; /// Job being run by the decoder thread, guarded by the jobs
+                                      /// mutex
+  std::condition_variable retireCondition_; /// Notified when the decoder thread finishes a job
+  std::vector<MixerSource*> decoderJobs_; /// Decoder thread: the jobs of the current pass
+  std::condition_variable decoderCondition_;
+  std::atomic<bool> decoderWake_{false};
+  bool quit_{false};
+  DSPStageStatistics decoderThreadStatistics_; /// Decoder thread
+  std::thread decoderThread_;
+};
+} // namespace TBE
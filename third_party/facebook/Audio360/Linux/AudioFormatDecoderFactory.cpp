@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/Linux/AudioFormatDecoderFactory.h"
+#include "third_party/facebook/Audio360/Linux/FileStream.h"
+#include "third_party/facebook/Audio360/Linux/WavFormatDecoder.h"
+
+#include <string.h>
+#include <strings.h>
+
+namespace TBE {
+namespace {
+bool hasExtension(const char* name, const char* extension) {
+  if (name == nullptr) {
+    return false;
+  }
+  const size_t nameLength = strlen(name);
+  const size_t extensionLength = strlen(extension);
+  return nameLength >= extensionLength &&
+      strcasecmp(name + nameLength - extensionLength, extension) == 0;
+}
+} // namespace
+
+AssetCodec getAssetCodec(const char* assetName) {
+  if (hasExtension(assetName, ".opus")) {
+    return AssetCodec::OPUS;
+  }
+  if (hasExtension(assetName, ".tbe")) {
+    return AssetCodec::TBE;
+  }
+  return AssetCodec::WAV;
+}
+
+EngineError createAudioFormatDecoder(
+    AudioFormatDecoder*& decoder,
+    IOStream* stream,
+    bool shouldOwnStream,
+    AssetCodec codec,
+    int32_t maxBufferSizePerChannel,
+    float outputSampleRate) {
+  decoder = nullptr;
+
+  // Opus and the TBE container are only available in the prebuilt libraries
+  if (codec != AssetCodec::WAV) {
+    if (shouldOwnStream) {
+      delete stream;
+    }
+    return EngineError::CANNOT_INIT_DECODER;
+  }
+
+  WavFormatDecoder* wav = new WavFormatDecoder(maxBufferSizePerChannel, outputSampleRate);
+  const EngineError err = wav->open(stream, shouldOwnStream);
+  if (err != EngineError::OK) {
+    delete wav;
+    return err;
+  }
+  decoder = wav;
+  return EngineError::OK;
+}
+} // namespace TBE
+
+extern "C" {
+
+TBE::EngineError TBE_CreateAudioFormatDecoderFromHeader(
+    TBE::AudioFormatDecoder*& decoder,
+    const char* headerData,
+    size_t headerDataSize) {
+  decoder = nullptr;
+  TBE::WavFormatDecoder* wav = new TBE::WavFormatDecoder(0, 0.f);
+  const TBE::EngineError err = wav->openFromHeader(headerData, headerDataSize);
+  if (err != TBE::EngineError::OK) {
+    delete wav;
+    return err;
+  }
+  decoder = wav;
+  return TBE::EngineError::OK;
+}
+
+TBE::EngineError TBE_CreateAudioFormatDecoder(
+    TBE::AudioFormatDecoder*& decoder,
+    const char* file,
+    int maxBufferSizePerChannel,
+    float outputSampleRate) {
+  decoder = nullptr;
+  TBE::FileStream* stream = new TBE::FileStream();
+  const TBE::EngineError err = stream->open(file);
+  if (err != TBE::EngineError::OK) {
+    delete stream;
+    return err;
+  }
+  return TBE::createAudioFormatDecoder(
+      decoder,
+      stream,
+      true,
+      TBE::getAssetCodec(file),
+      maxBufferSizePerChannel,
+      outputSampleRate);
+}
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include "third_party/facebook/Audio360/include/TBE_AudioEngine.h"
+
+namespace TBE {
+/// \return The codec of an asset from the extension of its name. WAV if it is not recognised.
+AssetCodec getAssetCodec(const char* assetName);
+
+/// Create a decoder for a stream.
+/// \param decoder Filled in with the decoder on success
+/// \param stream Stream containing the encoded asset
+/// \param shouldOwnStream If the decoder must own the stream. The stream is deleted on failure.
+/// \param codec Codec of the asset
+/// \param maxBufferSizePerChannel Maximum number of samples per channel requested by decode(..)
+/// \param outputSampleRate Output sample rate. 0 disables resampling.
+/// \return EngineError::OK or EngineError::CANNOT_INIT_DECODER if the codec is not available on
+/// this platform, or the error from parsing the stream
+EngineError createAudioFormatDecoder(
+    AudioFormatDecoder*& decoder,
+    IOStream* stream,
+    bool shouldOwnStream,
+    AssetCodec codec,
+    int32_t maxBufferSizePerChannel,
+    float outputSampleRate);
+} // namespace TBE
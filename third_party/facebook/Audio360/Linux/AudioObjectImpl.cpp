@@ -0,0 +1,602 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/Linux/AudioObjectImpl.h"
+#include "third_party/facebook/Audio360/Linux/AudioEngineImpl.h"
+#include "third_party/facebook/Audio360/Linux/AudioFormatDecoderFactory.h"
+#include "third_party/facebook/Audio360/Linux/FileStream.h"
+#include "third_party/facebook/Audio360/include/TBE_AssetBank.h"
+#include "third_party/facebook/Audio360/include/TBE_SpatialBatch.hh"
+
+namespace TBE {
+namespace {
+const size_t kMinStreamingBufferSize = 8192;
+const float kMinPitch = 0.001f;
+const float kMaxPitch = 4.f;
+const float kPlayingVoiceBias = 1.41f; /// +3dB
+} // namespace
+
+AudioObjectImpl::AudioObjectImpl(AudioEngineImpl& engine)
+    : SpatDecoderBase<AudioObject, AudioObjectExtensions>(
+          engine.getEventDispatcher(),
+          engine.getSampleRate()),
+      engine_(engine),
+      source_(
+          std::max(kMinStreamingBufferSize, static_cast<size_t>(engine.getBufferSize()) * 4),
+          static_cast<size_t>(engine.getBufferSize())),
+      pitchBuffer_((static_cast<size_t>(engine.getBufferSize()) * 4 + 3) * 2) {}
+
+AudioObjectImpl::~AudioObjectImpl() {}
+
+void AudioObjectImpl::reset(Options options) {
+  resetBase();
+  options_ = options;
+  bufferCallback_.store(BufferCallbackInfo());
+  attenuationProps_.store(AttenuationProps());
+  attenuationMode_.store(static_cast<int>(AttenuationMode::LOGARITHMIC));
+  spatialise_.store(true);
+  listenerRelative_.store(false);
+  pitch_.store(1.f);
+  priority_.store(0);
+  resetPlayback();
+}
+
+void AudioObjectImpl::release() {
+  source_.detach();
+  bufferCallback_.store(BufferCallbackInfo());
+}
+
+void AudioObjectImpl::setListenerRelative(bool listenerRelative) {
+  listenerRelative_.store(listenerRelative);
+}
+
+EngineError AudioObjectImpl::setAudioBufferCallback(
+    BufferCallback callback,
+    size_t numChannels,
+    void* userData) {
+  if (callback && (numChannels < 1 || numChannels > 2)) {
+    return EngineError::INVALID_CHANNEL_COUNT;
+  }
+
+  BufferCallbackInfo info;
+  info.callback = callback;
+  info.numChannels = callback ? numChannels : 0;
+  info.userData = userData;
+
+  auto lock = engine_.lockRender();
+  source_.detach();
+  bufferCallback_.store(info);
+  resetPlayback();
+  return EngineError::OK;
+}
+
+EngineError AudioObjectImpl::open(const char* nameAndPath) {
+  return open(nameAndPath, AssetDescriptor());
+}
+
+EngineError AudioObjectImpl::open(const char* nameAndPath, AssetDescriptor ad) {
+  if (nameAndPath == nullptr) {
+    return EngineError::ERROR_OPENING_FILE;
+  }
+
+  PcmCache* cache = engine_.getPcmCache();
+  if (cache != nullptr) {
+    AudioFormatDecoder* decoder = nullptr;
+    bool cached = false;
+    const EngineError error = cache->createDecoder(decoder, cached, nameAndPath, ad);
+    if (error != EngineError::OK) {
+      return error;
+    }
+    return openDecoder(decoder, cached);
+  }
+
+  FileStream* stream = new FileStream();
+  const EngineError error = stream->open(nameAndPath, ad);
+  if (error != EngineError::OK) {
+    delete stream;
+    return error;
+  }
+  return openStream(stream, getAssetCodec(nameAndPath));
+}
+
+EngineError AudioObjectImpl::open(AssetBank* bank, const char* assetName) {
+  if (bank == nullptr) {
+    return EngineError::NO_ASSET;
+  }
+
+  // The index gives the channel count, so unsupported assets are rejected before decoding
+  AssetBankEntry entry;
+  EngineError error = bank->findAsset(assetName, entry);
+  if (error != EngineError::OK) {
+    return error;
+  }
+  if (entry.numChannels > 2) {
+    return EngineError::INVALID_CHANNEL_COUNT;
+  }
+
+  AudioFormatDecoder* decoder = nullptr;
+  error = bank->createDecoder(
+      decoder, assetName, engine_.getBufferSize(), engine_.getSampleRate());
+  if (error != EngineError::OK) {
+    return error;
+  }
+  return openDecoder(decoder, false);
+}
+
+EngineError AudioObjectImpl::openStream(IOStream* stream, AssetCodec codec) {
+  AudioFormatDecoder* decoder = nullptr;
+  const EngineError error = createAudioFormatDecoder(
+      decoder, stream, true, codec, engine_.getBufferSize(), engine_.getSampleRate());
+  if (error != EngineError::OK) {
+    return error;
+  }
+  return openDecoder(decoder, false);
+}
+
+EngineError AudioObjectImpl::openDecoder(AudioFormatDecoder* decoder, bool progressive) {
+  if (decoder->getNumOfChannels() < 1 || decoder->getNumOfChannels() > 2) {
+    delete decoder;
+    return EngineError::INVALID_CHANNEL_COUNT;
+  }
+
+  {
+    auto lock = engine_.lockRender();
+    bufferCallback_.store(BufferCallbackInfo());
+    source_.attach(decoder, progressive);
+    resetPlayback();
+  }
+  engine_.wakeDecoderThread();
+  return EngineError::OK;
+}
+
+void AudioObjectImpl::close() {
+  auto lock = engine_.lockRender();
+  source_.detach();
+  resetPlayback();
+}
+
+bool AudioObjectImpl::isOpen() const {
+  return source_.isOpen();
+}
+
+EngineError AudioObjectImpl::seekToSample(size_t timeInSamples) {
+  const EngineError error = source_.seekToSample(timeInSamples);
+  if (error == EngineError::OK) {
+    // A culled object resumes from the new position
+    virtualSeek_.store(static_cast<int64_t>(timeInSamples));
+    engine_.wakeDecoderThread();
+  }
+  return error;
+}
+
+EngineError AudioObjectImpl::seekToMs(float timeInMs) {
+  if (timeInMs < 0.f) {
+    return EngineError::FAIL;
+  }
+  return seekToSample(static_cast<size_t>(timeInMs * engine_.getSampleRate() / 1000.f));
+}
+
+size_t AudioObjectImpl::getElapsedTimeInSamples() const {
+  const int64_t virtualElapsed = virtualElapsed_.load();
+  return virtualElapsed >= 0 ? static_cast<size_t>(virtualElapsed) : source_.getElapsedSamples();
+}
+
+double AudioObjectImpl::getElapsedTimeInMs() const {
+  return static_cast<double>(getElapsedTimeInSamples()) * 1000.0 / engine_.getSampleRate();
+}
+
+size_t AudioObjectImpl::getAssetDurationInSamples() const {
+  return source_.getDurationSamples();
+}
+
+float AudioObjectImpl::getAssetDurationInMs() {
+  return static_cast<float>(source_.getDurationSamples()) * 1000.f / engine_.getSampleRate();
+}
+
+void AudioObjectImpl::shouldSpatialise(bool spatialise) {
+  spatialise_.store(spatialise);
+}
+
+bool AudioObjectImpl::isSpatialised() {
+  return spatialise_.load();
+}
+
+bool AudioObjectImpl::enableLooping(bool loop) {
+  if (bufferCallback_.load().callback) {
+    return false;
+  }
+  source_.enableLooping(loop);
+  return true;
+}
+
+bool AudioObjectImpl::loopingEnabled() {
+  return source_.loopingEnabled();
+}
+
+void AudioObjectImpl::setAttenuationMode(AttenuationMode mode) {
+  attenuationMode_.store(static_cast<int>(mode));
+}
+
+AttenuationMode AudioObjectImpl::getAttenuationMode() const {
+  return static_cast<AttenuationMode>(attenuationMode_.load());
+}
+
+void AudioObjectImpl::setAttenuationProperties(AttenuationProps props) {
+  attenuationProps_.store(props);
+}
+
+AttenuationProps AudioObjectImpl::getAttenuationProperties() const {
+  return attenuationProps_.load();
+}
+
+void AudioObjectImpl::setPitch(float pitch) {
+  pitch_.store(std::min(kMaxPitch, std::max(kMinPitch, pitch)));
+}
+
+float AudioObjectImpl::getPitch() const {
+  return pitch_.load();
+}
+
+void AudioObjectImpl::setPriority(int32_t priority) {
+  priority_.store(priority);
+}
+
+int32_t AudioObjectImpl::getPriority() const {
+  return priority_.load();
+}
+
+void AudioObjectImpl::render(const MixContext& context, float* mix) {
+  bool stopped = false;
+  const bool active = transport_.process(context.numFrames, context.gains, stopped);
+  if (stopped) {
+    resetPlayback();
+    if (source_.isOpen()) {
+      source_.seekToSample(0);
+    }
+  }
+  if (!active) {
+    rendered_ = false;
+    publishSourceStatistics(context, false);
+    return;
+  }
+  if (virtual_ && !resumeFromVirtual(context)) {
+    rendered_ = false;
+    publishSourceStatistics(context, false);
+    return;
+  }
+  if (fadingOut_) {
+    applyVoiceFade(context, false);
+  }
+
+  const size_t numFrames = context.numFrames;
+  float* input = context.scratch;
+  const BufferCallbackInfo callback = bufferCallback_.load();
+  int32_t numChannels = 0;
+  size_t numRead = 0;
+  if (callback.callback) {
+    numChannels = static_cast<int32_t>(callback.numChannels);
+    callback.callback(input, numFrames, callback.numChannels, callback.userData);
+    numRead = numFrames;
+  } else {
+    numChannels = source_.getNumChannels();
+    if (numChannels == 0) {
+      rendered_ = false;
+      publishSourceStatistics(context, false);
+      return;
+    }
+    numRead = readWithPitch(input, numFrames, numChannels, pitch_.load());
+    if (fadingIn_ && numRead > 0) {
+      applyVoiceFade(context, true);
+      fadingIn_ = false;
+    }
+    std::fill(input + numRead * numChannels, input + numFrames * numChannels, 0.f);
+
+    for (; numLoops_ > 0; --numLoops_) {
+      postEvent(Event::LOOPED);
+    }
+
+    if (numRead < numFrames) {
+      if (source_.finished()) {
+        postEvent(Event::END_OF_STREAM);
+        transport_.finish();
+        resetPlayback();
+        source_.seekToSample(0);
+      } else if (source_.ready() && !starving_) {
+        starving_ = true;
+        postStarvation(context);
+      }
+    } else {
+      starving_ = false;
+    }
+  }
+
+  spatialise(context, input, numChannels, mix);
+  rendered_ = true;
+  publishSourceStatistics(context, true);
+}
+
+void AudioObjectImpl::renderVirtual(const MixContext& context, float* mix) {
+  if (!virtual_) {
+    // Fade out over one last block, then keep time from where playback got to
+    const bool fadeOut = rendered_;
+    if (fadeOut) {
+      fadingOut_ = true;
+      render(context, mix);
+      fadingOut_ = false;
+    }
+    virtual_ = true;
+    resuming_ = false;
+    fadingIn_ = false;
+    rendered_ = false;
+    virtualPosition_ = static_cast<double>(source_.getElapsedSamples());
+    virtualSeek_.store(-1);
+    virtualElapsed_.store(static_cast<int64_t>(virtualPosition_));
+    if (fadeOut) {
+      return;
+    }
+  }
+
+  bool stopped = false;
+  const bool active = transport_.process(context.numFrames, context.gains, stopped);
+  if (stopped) {
+    resetPlayback();
+    source_.seekToSample(0);
+  }
+  if (active) {
+    advanceVirtual(context);
+  }
+  publishSourceStatistics(context, false);
+}
+
+void AudioObjectImpl::advanceVirtual(const MixContext& context) {
+  const int64_t seek = virtualSeek_.exchange(-1);
+  if (seek >= 0) {
+    virtualPosition_ = static_cast<double>(seek);
+  }
+  virtualPosition_ += static_cast<double>(context.numFrames) * pitch_.load();
+
+  const double duration = static_cast<double>(source_.getDurationSamples());
+  if (duration > 0.0 && virtualPosition_ >= duration) {
+    if (source_.loopingEnabled()) {
+      virtualPosition_ = std::fmod(virtualPosition_, duration);
+      postEvent(Event::LOOPED);
+    } else {
+      postEvent(Event::END_OF_STREAM);
+      transport_.finish();
+      resetPlayback();
+      source_.seekToSample(0);
+    }
+  }
+  if (virtual_) {
+    virtualElapsed_.store(static_cast<int64_t>(virtualPosition_));
+  }
+}
+
+bool AudioObjectImpl::resumeFromVirtual(const MixContext& context) {
+  if (!resuming_) {
+    // The target is only known once the decoder is ready to seek, see below
+    resuming_ = true;
+    source_.seekToSample(static_cast<size_t>(virtualPosition_));
+  }
+  advanceVirtual(context);
+  if (!virtual_) {
+    // Reached the end of the stream while waiting
+    return false;
+  }
+
+  // This block's read drops the old audio and the decoder seeks after it, so the new audio
+  // arrives next block: start it from where the voice will be then, however long the decoder
+  // took to get here
+  if (!source_.retargetAcknowledgedSeek(static_cast<size_t>(virtualPosition_))) {
+    return false;
+  }
+  resetPlayback();
+  fadingIn_ = true;
+  return true;
+}
+
+void AudioObjectImpl::applyVoiceFade(const MixContext& context, bool fadeIn) {
+  const size_t numFrames = context.numFrames;
+  const float step = 1.f / static_cast<float>(std::max<size_t>(numFrames, 1));
+  for (size_t i = 0; i < numFrames; ++i) {
+    const float ramp = static_cast<float>(i + 1) * step;
+    context.gains[i] *= fadeIn ? ramp : 1.f - ramp;
+  }
+}
+
+void AudioObjectImpl::publishSourceStatistics(const MixContext& context, bool active) {
+  publishStatistics(
+      context,
+      active,
+      source_.getNumBufferedFrames(),
+      source_.isOpen() ? source_.getBufferSizeFrames() : 0,
+      !decodesInAudioCallback() && source_.isBacklogged());
+}
+
+void AudioObjectImpl::runDecoderJob() {
+  if (source_.decode()) {
+    postEvent(Event::DECODER_INIT);
+  }
+}
+
+bool AudioObjectImpl::getRelativePosition(const MixContext& context, TBVector& position) const {
+  if (!spatialise_.load() || transport_.getPlayState() == PlayState::STOPPED) {
+    return false;
+  }
+  position = position_.load();
+  if (!listenerRelative_.load()) {
+    position = position - context.listenerPosition;
+  }
+  return true;
+}
+
+bool AudioObjectImpl::decodesInAudioCallback() const {
+  return (options_ & Options::DECODE_IN_AUDIO_CALLBACK) != 0 || !engine_.usesDecoderThread();
+}
+
+bool AudioObjectImpl::getAudibility(const MixContext& context, int32_t& priority, float& gain)
+    const {
+  // Objects fed by a buffer callback have no stream to keep time in, so they are always rendered
+  if (!source_.isOpen() || transport_.getPlayState() != PlayState::PLAYING) {
+    return false;
+  }
+
+  priority = priority_.load();
+  gain = transport_.getVolume();
+  if (context.sourceAed != nullptr) {
+    gain *= TBSpatialBatch::getAttenuationGain(
+        getAttenuationMode(), attenuationProps_.load(), context.sourceAed->distance);
+  }
+  // Favour the voices being rendered so that voices of similar loudness do not swap every block
+  if (!virtual_) {
+    gain *= kPlayingVoiceBias;
+  }
+  return true;
+}
+
+size_t AudioObjectImpl::readFromSource(float* out, size_t numFrames) {
+  int32_t numLoops = 0;
+  const size_t numRead = source_.read(out, numFrames, numLoops);
+  numLoops_ += numLoops;
+  return numRead;
+}
+
+size_t AudioObjectImpl::readWithPitch(
+    float* out,
+    size_t numFrames,
+    int32_t numChannels,
+    float pitch) {
+  const size_t stride = static_cast<size_t>(numChannels);
+  float* buffer = pitchBuffer_.data();
+
+  if (pitch == 1.f && pitchPhase_ == 0.0) {
+    // Drain what is left over from a previous pitch change, then read directly
+    const size_t numBuffered = std::min(numPitchFrames_, numFrames);
+    std::copy(buffer, buffer + numBuffered * stride, out);
+    std::copy(buffer + numBuffered * stride, buffer + numPitchFrames_ * stride, buffer);
+    numPitchFrames_ -= numBuffered;
+    return numBuffered + readFromSource(out + numBuffered * stride, numFrames - numBuffered);
+  }
+
+  // Linear interpolation needs the frame after the last read position
+  const size_t capacity = pitchBuffer_.size() / stride;
+  const double lastPosition = pitchPhase_ + static_cast<double>(numFrames - 1) * pitch;
+  const size_t numNeeded = std::min(capacity, static_cast<size_t>(lastPosition) + 2);
+  if (numPitchFrames_ < numNeeded) {
+    numPitchFrames_ +=
+        readFromSource(buffer + numPitchFrames_ * stride, numNeeded - numPitchFrames_);
+  }
+
+  size_t numOut = 0;
+  double position = pitchPhase_;
+  for (; numOut < numFrames; ++numOut, position += pitch) {
+    const size_t index = static_cast<size_t>(position);
+    if (index + 1 >= numPitchFrames_) {
+      break;
+    }
+    const float fraction = static_cast<float>(position - static_cast<double>(index));
+    const float* a = buffer + index * stride;
+    const float* b = a + stride;
+    for (size_t c = 0; c < stride; ++c) {
+      out[numOut * stride + c] = a[c] + (b[c] - a[c]) * fraction;
+    }
+  }
+
+  const size_t numConsumed = std::min(numPitchFrames_, static_cast<size_t>(position));
+  std::copy(buffer + numConsumed * stride, buffer + numPitchFrames_ * stride, buffer);
+  numPitchFrames_ -= numConsumed;
+  pitchPhase_ = position - static_cast<double>(numConsumed);
+  if (pitch == 1.f && numPitchFrames_ == 0) {
+    pitchPhase_ = 0.0;
+  }
+  return numOut;
+}
+
+void AudioObjectImpl::spatialise(
+    const MixContext& context,
+    const float* input,
+    int32_t numChannels,
+    float* mix) {
+  const size_t numFrames = context.numFrames;
+  const float* gains = context.gains;
+
+  if (!spatialise_.load()) {
+    if (numChannels == 2) {
+      for (size_t i = 0; i < numFrames; ++i) {
+        mix[2 * i] += input[2 * i] * gains[i];
+        mix[2 * i + 1] += input[2 * i + 1] * gains[i];
+      }
+    } else {
+      for (size_t i = 0; i < numFrames; ++i) {
+        mix[2 * i] += input[i] * gains[i];
+        mix[2 * i + 1] += input[i] * gains[i];
+      }
+    }
+    haveGains_ = false;
+    return;
+  }
+
+  // The engine batches the spatial parameters, unless the object started playing this block
+  Aed aed;
+  if (context.sourceAed) {
+    aed = *context.sourceAed;
+  } else {
+    const TBVector listenerPosition =
+        listenerRelative_.load() ? TBVector::zero() : context.listenerPosition;
+    aed = TBQuat::getAedFromQuat(context.listenerRotation, position_.load(), listenerPosition);
+  }
+  const TBVector direction = TBVector::getVectorFromAziEle(aed.azimuth, aed.elevation);
+
+  const float attenuation = TBSpatialBatch::getAttenuationGain(
+      getAttenuationMode(), attenuationProps_.load(), aed.distance);
+  const float gain = attenuation * getFocusGain(focus_.load(), direction);
+
+  // Constant power pan on the lateral component of the direction
+  const float theta = (std::min(1.f, std::max(-1.f, direction.x)) + 1.f) * 0.25f * M_PIF;
+  const float leftGain = std::cos(theta) * gain;
+  const float rightGain = std::sin(theta) * gain;
+  if (!haveGains_) {
+    previousLeftGain_ = leftGain;
+    previousRightGain_ = rightGain;
+    haveGains_ = true;
+  }
+
+  const float step = 1.f / static_cast<float>(std::max<size_t>(numFrames, 1));
+  const float leftStep = (leftGain - previousLeftGain_) * step;
+  const float rightStep = (rightGain - previousRightGain_) * step;
+  float left = previousLeftGain_;
+  float right = previousRightGain_;
+  for (size_t i = 0; i < numFrames; ++i) {
+    left += leftStep;
+    right += rightStep;
+    const float sample =
+        numChannels == 2 ? 0.5f * (input[2 * i] + input[2 * i + 1]) : input[i];
+    mix[2 * i] += sample * left * gains[i];
+    mix[2 * i + 1] += sample * right * gains[i];
+  }
+  previousLeftGain_ = leftGain;
+  previousRightGain_ = rightGain;
+}
+
+void AudioObjectImpl::resetPlayback() {
+  numPitchFrames_ = 0;
+  pitchPhase_ = 0.0;
+  numLoops_ = 0;
+  haveGains_ = false;
+  starving_ = false;
+  rendered_ = false;
+  virtual_ = false;
+  resuming_ = false;
+  fadingIn_ = false;
+  virtualElapsed_.store(-1);
+}
+} // namespace TBE
+
+extern "C" {
+
+TBE::AudioObjectExtensions* TBE_GetAudioObjectExtensions(TBE::AudioObject* object) {
+  // Every AudioObject is created by the engine from its pool
+  return object != nullptr ? static_cast<TBE::AudioObjectImpl*>(object) : nullptr;
+}
+}
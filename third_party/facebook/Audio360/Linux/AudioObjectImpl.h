@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include "third_party/facebook/Audio360/Linux/SpatDecoderBase.h"
+#include "third_party/facebook/Audio360/Linux/StreamingSource.h"
+#include "third_party/facebook/Audio360/include/TBE_AudioEngineExtensions.h"
+#include "third_party/facebook/Audio360/include/TBE_AudioObject.h"
+
+#include <atomic>
+#include <vector>
+
+namespace TBE {
+class AudioEngineImpl;
+
+/// Positions mono or stereo audio from a file or a client callback. Stereo sources are downmixed
+/// when spatialised. Spatialisation uses constant power panning with distance attenuation.
+class AudioObjectImpl : public SpatDecoderBase<AudioObject, AudioObjectExtensions> {
+ public:
+  explicit AudioObjectImpl(AudioEngineImpl& engine);
+  ~AudioObjectImpl() override;
+
+  /// Restore the default state when the object is taken from the pool. Not thread safe.
+  void reset(Options options);
+
+  /// Release the asset and callback when the object is returned to the pool. Not thread safe.
+  void release();
+
+  /// Position the object relative to the listener's position instead of in world space. The
+  /// listener's rotation still applies. Used for the virtual speakers of SpeakersVirtualizer.
+  void setListenerRelative(bool listenerRelative);
+
+  EngineError
+  setAudioBufferCallback(BufferCallback callback, size_t numChannels, void* userData) override;
+  EngineError open(const char* nameAndPath) override;
+  EngineError open(const char* nameAndPath, AssetDescriptor ad) override;
+  void close() override;
+  bool isOpen() const override;
+  EngineError seekToSample(size_t timeInSamples) override;
+  EngineError seekToMs(float timeInMs) override;
+  size_t getElapsedTimeInSamples() const override;
+  double getElapsedTimeInMs() const override;
+  size_t getAssetDurationInSamples() const override;
+  float getAssetDurationInMs() override;
+  void shouldSpatialise(bool spatialise) override;
+  bool isSpatialised() override;
+  bool enableLooping(bool loop) override;
+  bool loopingEnabled() override;
+  void setAttenuationMode(AttenuationMode mode) override;
+  AttenuationMode getAttenuationMode() const override;
+  void setAttenuationProperties(AttenuationProps props) override;
+  AttenuationProps getAttenuationProperties() const override;
+  void setPitch(float pitch) override;
+  float getPitch() const override;
+
+  // AudioObjectExtensions
+  EngineError open(AssetBank* bank, const char* assetName) override;
+  void setPriority(int32_t priority) override;
+  int32_t getPriority() const override;
+
+  void render(const MixContext& context, float* mix) override;
+  bool getRelativePosition(const MixContext& context, TBVector& position) const override;
+  void runDecoderJob() override;
+  bool decodesInAudioCallback() const override;
+  bool getAudibility(const MixContext& context, int32_t& priority, float& gain) const override;
+  void renderVirtual(const MixContext& context, float* mix) override;
+
+ private:
+  struct BufferCallbackInfo {
+    BufferCallback callback{nullptr};
+    size_t numChannels{0};
+    void* userData{nullptr};
+  };
+
+  /// Open a stream containing an encoded asset. Takes ownership of the stream.
+  EngineError openStream(IOStream* stream, AssetCodec codec);
+  /// Play from a decoder. Takes ownership of the decoder.
+  /// \param progressive If the decoder reads an asset that is still being filled
+  EngineError openDecoder(AudioFormatDecoder* decoder, bool progressive);
+  size_t readFromSource(float* out, size_t numFrames);
+  size_t readWithPitch(float* out, size_t numFrames, int32_t numChannels, float pitch);
+  void spatialise(const MixContext& context, const float* input, int32_t numChannels, float* mix);
+  void resetPlayback();
+  /// Audio thread: advance the virtual voice's playhead by a block.
+  void advanceVirtual(const MixContext& context);
+  /// Audio thread: keep the virtual voice's time while the stream seeks to where it got to, and
+  /// fade it back in once the decoder has acknowledged the seek.
+  /// \return true if the voice is rendered again from this block
+  bool resumeFromVirtual(const MixContext& context);
+  /// Audio thread: fade the block's gains in or out.
+  void applyVoiceFade(const MixContext& context, bool fadeIn);
+  /// Audio thread: publish the buffer level of the stream after a block.
+  void publishSourceStatistics(const MixContext& context, bool active);
+
+  AudioEngineImpl& engine_;
+  StreamingSource source_;
+  Options options_{Options::DEFAULT};
+  SeqLock<BufferCallbackInfo> bufferCallback_;
+  SeqLock<AttenuationProps> attenuationProps_;
+  std::atomic<int> attenuationMode_{static_cast<int>(AttenuationMode::LOGARITHMIC)};
+  std::atomic<bool> spatialise_{true};
+  std::atomic<bool> listenerRelative_{false};
+  std::atomic<float> pitch_{1.f};
+  std::atomic<int32_t> priority_{0};
+  std::atomic<int64_t> virtualElapsed_{-1}; /// Playback position while virtual, or -1
+  std::atomic<int64_t> virtualSeek_{-1}; /// Seek requested while virtual, or -1
+
+  // Audio thread state
+  std::vector<float> pitchBuffer_;
+  size_t numPitchFrames_{0};
+  double pitchPhase_{0.0};
+  int32_t numLoops_{0};
+  bool haveGains_{false};
+  float previousLeftGain_{0.f};
+  float previousRightGain_{0.f};
+  bool starving_{false};
+  bool rendered_{false}; /// If audio was rendered in the previous block
+  bool virtual_{false}; /// If the object is culled, keeping time in virtualPosition_
+  bool resuming_{false}; /// If a virtual voice waits for the stream to seek before resuming
+  double virtualPosition_{0.0};
+  bool fadingIn_{false}; /// If the object has been resumed and fades in once audio arrives
+  bool fadingOut_{false}; /// If the object fades out this block before it is culled
+};
+} // namespace TBE
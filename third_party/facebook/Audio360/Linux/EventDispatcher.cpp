@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/Linux/EventDispatcher.h"
+
+namespace TBE {
+EventDispatcher::EventDispatcher(bool useEventThread, size_t queueSize)
+    : useEventThread_(useEventThread), queue_(queueSize), dispatchBuffer_(queueSize) {
+  if (useEventThread_) {
+    thread_ = std::thread(&EventDispatcher::threadLoop, this);
+  }
+}
+
+EventDispatcher::~EventDispatcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    quit_ = true;
+  }
+  condition_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void EventDispatcher::post(
+    Event event,
+    void* owner,
+    const SeqLock<EventCallbackInfo>& callbackInfo) {
+  const EventCallbackInfo info = callbackInfo.load();
+  if (info.callback == nullptr) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (count_ == queue_.size()) {
+      return;
+    }
+    queue_[(head_ + count_) % queue_.size()] = PendingEvent{event, owner, info};
+    ++count_;
+  }
+  if (useEventThread_) {
+    condition_.notify_one();
+  }
+}
+
+void EventDispatcher::removeOwner(void* owner) {
+  // Taking the dispatch lock guarantees that no callback for this owner is in flight on another
+  // thread. The lock is recursive so owners can be destroyed from within their own callbacks.
+  std::lock_guard<std::recursive_mutex> dispatchLock(dispatchMutex_);
+  for (size_t i = 0; i < numDispatching_; ++i) {
+    if (dispatchBuffer_[i].owner == owner) {
+      dispatchBuffer_[i].info.callback = nullptr;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t kept = 0;
+  for (size_t i = 0; i < count_; ++i) {
+    const PendingEvent& pending = queue_[(head_ + i) % queue_.size()];
+    if (pending.owner != owner) {
+      queue_[(head_ + kept) % queue_.size()] = pending;
+      ++kept;
+    }
+  }
+  count_ = kept;
+}
+
+EngineError EventDispatcher::processEventsOnThisThread() {
+  if (useEventThread_) {
+    return EngineError::NOT_SUPPORTED;
+  }
+  dispatchPending();
+  return EngineError::OK;
+}
+
+void EventDispatcher::dispatchPending() {
+  std::lock_guard<std::recursive_mutex> dispatchLock(dispatchMutex_);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (numDispatching_ = 0; numDispatching_ < count_; ++numDispatching_) {
+      dispatchBuffer_[numDispatching_] = queue_[(head_ + numDispatching_) % queue_.size()];
+    }
+    head_ = (head_ + count_) % queue_.size();
+    count_ = 0;
+  }
+
+  // Callbacks run without the queue lock so they are free to call back into the engine
+  for (size_t i = 0; i < numDispatching_; ++i) {
+    const PendingEvent pending = dispatchBuffer_[i];
+    if (pending.info.callback != nullptr) {
+      pending.info.callback(pending.event, pending.owner, pending.info.userData);
+    }
+  }
+  numDispatching_ = 0;
+}
+
+void EventDispatcher::threadLoop() {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this] { return quit_ || count_ > 0; });
+      if (quit_) {
+        return;
+      }
+    }
+    dispatchPending();
+  }
+}
+} // namespace TBE
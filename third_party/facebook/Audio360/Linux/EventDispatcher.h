@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include "third_party/facebook/Audio360/Linux/SeqLock.h"
+#include "third_party/facebook/Audio360/include/TBE_AudioEngineDefinitions.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace TBE {
+/// The event callback and user data registered by an object with setEventCallback().
+struct EventCallbackInfo {
+  EventCallback callback{nullptr};
+  void* userData{nullptr};
+};
+
+/// Queues events posted from the audio and decoder threads and dispatches them to the registered
+/// callbacks, either on a dedicated event thread or from processEventsOnThisThread().
+/// Events are kept in a fixed size queue and are dropped if the queue is full.
+class EventDispatcher {
+ public:
+  EventDispatcher(bool useEventThread, size_t queueSize);
+  ~EventDispatcher();
+
+  /// Queue an event for the given owner. Does nothing if no callback is registered.
+  void post(Event event, void* owner, const SeqLock<EventCallbackInfo>& callbackInfo);
+
+  /// Drop all queued events for an owner that is about to be destroyed.
+  void removeOwner(void* owner);
+
+  /// Dispatch all queued events on the calling thread.
+  /// \return EngineError::OK or EngineError::NOT_SUPPORTED if an event thread is in use
+  EngineError processEventsOnThisThread();
+
+ private:
+  struct PendingEvent {
+    Event event;
+    void* owner;
+    EventCallbackInfo info;
+  };
+
+  void dispatchPending();
+  void threadLoop();
+
+  const bool useEventThread_;
+  std::vector<PendingEvent> queue_;
+  size_t head_{0};
+  size_t count_{0};
+  std::vector<PendingEvent> dispatchBuffer_;
+  size_t numDispatching_{0};
+  std::mutex mutex_;
+  std::recursive_mutex dispatchMutex_;
+  std::condition_variable condition_;
+  bool quit_{false};
+  std::thread thread_;
+};
+} // namespace TBE
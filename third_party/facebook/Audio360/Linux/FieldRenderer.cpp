@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/Linux/FieldRenderer.h"
+
+namespace TBE {
+bool FieldRenderer::isSupported(ChannelMap map) {
+  switch (map) {
+    case ChannelMap::AMBIX_4:
+    case ChannelMap::AMBIX_9:
+    case ChannelMap::AMBIX_9_2:
+    case ChannelMap::HEADLOCKED_STEREO:
+    case ChannelMap::HEADLOCKED_CHANNEL0:
+    case ChannelMap::HEADLOCKED_CHANNEL1:
+    case ChannelMap::STEREO:
+      return true;
+    default:
+      return false;
+  }
+}
+
+void FieldRenderer::reset() {
+  havePrevious_ = false;
+}
+
+void FieldRenderer::render(
+    const MixContext& context,
+    const TBQuat& fieldRotation,
+    ChannelMap map,
+    const float* input,
+    const float* gains,
+    float* mix) {
+  const size_t numFrames = context.numFrames;
+  switch (map) {
+    case ChannelMap::AMBIX_4:
+      renderAmbisonic(context, fieldRotation, input, 4, gains, mix);
+      break;
+    case ChannelMap::AMBIX_9:
+      renderAmbisonic(context, fieldRotation, input, 9, gains, mix);
+      break;
+    case ChannelMap::AMBIX_9_2:
+      renderAmbisonic(context, fieldRotation, input, 11, gains, mix);
+      renderHeadLocked(numFrames, input, 11, 9, 2, 0, gains, mix);
+      break;
+    case ChannelMap::HEADLOCKED_STEREO:
+    case ChannelMap::STEREO:
+      renderHeadLocked(numFrames, input, 2, 0, 2, 0, gains, mix);
+      break;
+    case ChannelMap::HEADLOCKED_CHANNEL0:
+      renderHeadLocked(numFrames, input, 1, 0, 1, 0, gains, mix);
+      break;
+    case ChannelMap::HEADLOCKED_CHANNEL1:
+      renderHeadLocked(numFrames, input, 1, 0, 1, 1, gains, mix);
+      break;
+    default:
+      break;
+  }
+}
+
+void FieldRenderer::renderAmbisonic(
+    const MixContext& context,
+    const TBQuat& fieldRotation,
+    const float* input,
+    int32_t stride,
+    const float* gains,
+    float* mix) {
+  // The listener's right vector in the field's frame of reference
+  const TBVector right = TBQuat::antiRotateVectorByQuat(
+      fieldRotation, TBQuat::getRightFromQuat(context.listenerRotation));
+
+  // Cardioids pointing left and right. ambiX is X forward, Y left, Z up with ACN ordering
+  // (W, Y, Z, X), whereas TBVector is x right, y up, z forward.
+  const float leftMic[4] = {0.5f, 0.5f * right.x, -0.5f * right.y, -0.5f * right.z};
+  const float rightMic[4] = {0.5f, -0.5f * right.x, 0.5f * right.y, 0.5f * right.z};
+
+  if (!havePrevious_) {
+    std::copy(leftMic, leftMic + 4, previousLeft_);
+    std::copy(rightMic, rightMic + 4, previousRight_);
+    havePrevious_ = true;
+  }
+
+  // Interpolate the coefficients across the block to avoid zipper noise on head movement
+  const float step = 1.f / static_cast<float>(std::max<size_t>(context.numFrames, 1));
+  float l[4];
+  float r[4];
+  float dl[4];
+  float dr[4];
+  for (int k = 0; k < 4; ++k) {
+    l[k] = previousLeft_[k];
+    r[k] = previousRight_[k];
+    dl[k] = (leftMic[k] - previousLeft_[k]) * step;
+    dr[k] = (rightMic[k] - previousRight_[k]) * step;
+  }
+
+  for (size_t i = 0; i < context.numFrames; ++i) {
+    const float* in = input + i * stride;
+    for (int k = 0; k < 4; ++k) {
+      l[k] += dl[k];
+      r[k] += dr[k];
+    }
+    const float outL = l[0] * in[0] + l[1] * in[1] + l[2] * in[2] + l[3] * in[3];
+    const float outR = r[0] * in[0] + r[1] * in[1] + r[2] * in[2] + r[3] * in[3];
+    mix[2 * i] += outL * gains[i];
+    mix[2 * i + 1] += outR * gains[i];
+  }
+
+  std::copy(leftMic, leftMic + 4, previousLeft_);
+  std::copy(rightMic, rightMic + 4, previousRight_);
+}
+
+void FieldRenderer::renderHeadLocked(
+    size_t numFrames,
+    const float* input,
+    int32_t stride,
+    int32_t offset,
+    int32_t numChannels,
+    int32_t outputChannel,
+    const float* gains,
+    float* mix) {
+  input += offset;
+  if (numChannels == 2) {
+    for (size_t i = 0; i < numFrames; ++i) {
+      mix[2 * i] += input[i * stride] * gains[i];
+      mix[2 * i + 1] += input[i * stride + 1] * gains[i];
+    }
+  } else {
+    for (size_t i = 0; i < numFrames; ++i) {
+      mix[2 * i + outputChannel] += input[i * stride] * gains[i];
+    }
+  }
+}
+} // namespace TBE
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include "third_party/facebook/Audio360/Linux/MixContext.h"
+#include "third_party/facebook/Audio360/include/TBE_AudioEngineDefinitions.h"
+
+namespace TBE {
+/// Renders spatial audio formats to the stereo mix.
+/// Ambisonic fields are decoded with a pair of virtual cardioid microphones that follow the
+/// listener's head rotation; only the first order components are used, so AMBIX_9 is rendered as
+/// first order. Head-locked channels are mixed directly. The hybrid TBE formats are proprietary
+/// and are only supported by the prebuilt libraries.
+class FieldRenderer {
+ public:
+  /// \return true if the channel map can be rendered on this platform
+  static bool isSupported(ChannelMap map);
+
+  /// Forget the previous block's decoding coefficients, e.g. when playback restarts.
+  void reset();
+
+  /// Accumulate a block of interleaved audio into the stereo mix.
+  /// \param context Mix context for this block
+  /// \param fieldRotation Rotation of the field in world space
+  /// \param map Channel map of the input
+  /// \param input Interleaved input with getNumChannelsForMap(map) channels
+  /// \param gains Per-frame gain applied to the input
+  /// \param mix Interleaved stereo mix
+  void render(
+      const MixContext& context,
+      const TBQuat& fieldRotation,
+      ChannelMap map,
+      const float* input,
+      const float* gains,
+      float* mix);
+
+  /// Accumulate a block of first order ambisonics (ACN/SN3D) into the stereo mix.
+  /// \param stride Number of interleaved channels in input, at least 4
+  void renderAmbisonic(
+      const MixContext& context,
+      const TBQuat& fieldRotation,
+      const float* input,
+      int32_t stride,
+      const float* gains,
+      float* mix);
+
+  /// Accumulate head-locked channels into the stereo mix.
+  /// \param stride Number of interleaved channels in input
+  /// \param offset Index of the first head-locked channel in each frame
+  /// \param numChannels 2 for stereo, 1 for a single channel
+  /// \param outputChannel Output channel for a single head-locked channel
+  static void renderHeadLocked(
+      size_t numFrames,
+      const float* input,
+      int32_t stride,
+      int32_t offset,
+      int32_t numChannels,
+      int32_t outputChannel,
+      const float* gains,
+      float* mix);
+
+ private:
+  bool havePrevious_{false};
+  float previousLeft_[4];
+  float previousRight_[4];
+};
+} // namespace TBE
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/Linux/FileStream.h"
+
+namespace TBE {
+FileStream::FileStream() {}
+
+FileStream::~FileStream() {
+  close();
+}
+
+EngineError FileStream::open(const char* nameAndPath, AssetDescriptor ad) {
+  close();
+  if (nameAndPath == nullptr) {
+    return EngineError::ERROR_OPENING_FILE;
+  }
+
+  file_ = fopen(nameAndPath, "rb");
+  if (file_ == nullptr) {
+    return EngineError::ERROR_OPENING_FILE;
+  }
+
+  if (fseeko(file_, 0, SEEK_END) != 0) {
+    close();
+    return EngineError::ERROR_OPENING_FILE;
+  }
+  const size_t fileSize = static_cast<size_t>(ftello(file_));
+  if (ad.offsetInBytes > fileSize) {
+    close();
+    return EngineError::NO_ASSET;
+  }
+
+  offset_ = ad.offsetInBytes;
+  length_ = ad.lengthInBytes == 0 ? fileSize - offset_ : ad.lengthInBytes;
+  if (offset_ + length_ > fileSize) {
+    close();
+    return EngineError::NO_ASSET;
+  }
+  return setPosition(0) ? EngineError::OK : EngineError::ERROR_OPENING_FILE;
+}
+
+void FileStream::close() {
+  if (file_ != nullptr) {
+    fclose(file_);
+    file_ = nullptr;
+  }
+  offset_ = 0;
+  length_ = 0;
+  position_ = 0;
+  pushedBack_ = EOF;
+}
+
+size_t FileStream::read(void* data, size_t numBytes) {
+  if (file_ == nullptr || numBytes == 0) {
+    return 0;
+  }
+
+  size_t numRead = 0;
+  char* bytes = static_cast<char*>(data);
+  if (pushedBack_ != EOF) {
+    bytes[numRead++] = static_cast<char>(pushedBack_);
+    pushedBack_ = EOF;
+    ++position_;
+  }
+
+  const size_t numToRead = std::min(numBytes - numRead, length_ - position_);
+  const size_t numFromFile = fread(bytes + numRead, 1, numToRead, file_);
+  position_ += numFromFile;
+  return numRead + numFromFile;
+}
+
+size_t FileStream::write(void*, size_t) {
+  return 0;
+}
+
+size_t FileStream::getPosition() {
+  return position_;
+}
+
+bool FileStream::setPosition(size_t pos) {
+  return setPosition(pos, SEEK_SET);
+}
+
+bool FileStream::setPosition(size_t pos, int mode) {
+  if (file_ == nullptr) {
+    return false;
+  }
+
+  size_t target = pos;
+  if (mode == SEEK_CUR) {
+    target = position_ + pos;
+  } else if (mode == SEEK_END) {
+    target = length_ + pos;
+  }
+  if (target > length_) {
+    return false;
+  }
+  if (fseeko(file_, static_cast<off_t>(offset_ + target), SEEK_SET) != 0) {
+    return false;
+  }
+  position_ = target;
+  pushedBack_ = EOF;
+  return true;
+}
+
+int32_t FileStream::pushBackByte(int c) {
+  if (file_ == nullptr || c == EOF || position_ == 0 || pushedBack_ != EOF) {
+    return EOF;
+  }
+  pushedBack_ = static_cast<unsigned char>(c);
+  --position_;
+  return pushedBack_;
+}
+
+size_t FileStream::getSize() {
+  return length_;
+}
+
+bool FileStream::canSeek() {
+  return true;
+}
+
+bool FileStream::ready() const {
+  return file_ != nullptr;
+}
+
+bool FileStream::endOfStream() {
+  return file_ == nullptr || (position_ >= length_ && pushedBack_ == EOF);
+}
+} // namespace TBE
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include "third_party/facebook/Audio360/include/TBE_AudioEngineDefinitions.h"
+#include "third_party/facebook/Audio360/include/TBE_IOStream.h"
+
+#include <stdio.h>
+
+namespace TBE {
+/// Read-only IOStream for a file on disk. If an AssetDescriptor is specified, the stream only
+/// exposes the chunk it describes and all positions are relative to the start of the chunk.
+class FileStream : public IOStream {
+ public:
+  FileStream();
+  ~FileStream() override;
+
+  /// Open a file for reading.
+  /// \param nameAndPath Absolute path to the file
+  /// \param ad Chunk within the file. A length of 0 extends the chunk to the end of the file.
+  /// \return EngineError::OK, EngineError::ERROR_OPENING_FILE or EngineError::NO_ASSET if the
+  /// chunk lies outside the file
+  EngineError open(const char* nameAndPath, AssetDescriptor ad = AssetDescriptor());
+
+  void close();
+
+  size_t read(void* data, size_t numBytes) override;
+  size_t write(void* data, size_t numBytes) override;
+  size_t getPosition() override;
+  bool setPosition(size_t pos) override;
+  bool setPosition(size_t pos, int mode) override;
+  int32_t pushBackByte(int c) override;
+  size_t getSize() override;
+  bool canSeek() override;
+  bool ready() const override;
+  bool endOfStream() override;
+
+ private:
+  FILE* file_{nullptr};
+  size_t offset_{0};
+  size_t length_{0};
+  size_t position_{0};
+  int pushedBack_{EOF};
+};
+} // namespace TBE
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/Linux/LoudnessMeter.h"
+
+namespace TBE {
+namespace {
+const size_t kMomentarySubBlocks = 4; // 400ms
+const size_t kShortTermSubBlocks = 30; // 3s
+const float kAbsoluteGate = -70.f;
+const float kRelativeGate = -10.f;
+const float kHistogramMax = 5.f;
+const float kHistogramResolution = 0.1f;
+const size_t kHistogramSize =
+    static_cast<size_t>((kHistogramMax - kAbsoluteGate) / kHistogramResolution) + 1;
+
+float energyToLoudness(double energy) {
+  return energy > 0.0 ? -0.691f + 10.f * static_cast<float>(std::log10(energy)) : -INFINITY;
+}
+
+double loudnessToEnergy(float loudness) {
+  return std::pow(10.0, (static_cast<double>(loudness) + 0.691) / 10.0);
+}
+} // namespace
+
+LoudnessMeter::LoudnessMeter(float sampleRate)
+    : subBlockFrames_(static_cast<size_t>(sampleRate / 10.f)),
+      histogram_(kHistogramSize),
+      momentary_(-INFINITY),
+      shortTerm_(-INFINITY),
+      subBlocks_(kShortTermSubBlocks, 0.0) {
+  // K-weighting filters from ITU-R BS.1770, recomputed for the sample rate
+  const double pi = 3.14159265358979323846;
+  {
+    const double f0 = 1681.974450955533;
+    const double gain = 3.999843853973347;
+    const double q = 0.7071752369554196;
+    const double k = std::tan(pi * f0 / sampleRate);
+    const double vh = std::pow(10.0, gain / 20.0);
+    const double vb = std::pow(vh, 0.4996667741545416);
+    const double a0 = 1.0 + k / q + k * k;
+    shelf_.b0 = static_cast<float>((vh + vb * k / q + k * k) / a0);
+    shelf_.b1 = static_cast<float>(2.0 * (k * k - vh) / a0);
+    shelf_.b2 = static_cast<float>((vh - vb * k / q + k * k) / a0);
+    shelf_.a1 = static_cast<float>(2.0 * (k * k - 1.0) / a0);
+    shelf_.a2 = static_cast<float>((1.0 - k / q + k * k) / a0);
+  }
+  {
+    const double f0 = 38.13547087602444;
+    const double q = 0.5003270373238773;
+    const double k = std::tan(pi * f0 / sampleRate);
+    const double a0 = 1.0 + k / q + k * k;
+    highPass_.b0 = 1.f;
+    highPass_.b1 = -2.f;
+    highPass_.b2 = 1.f;
+    highPass_.a1 = static_cast<float>(2.0 * (k * k - 1.0) / a0);
+    highPass_.a2 = static_cast<float>((1.0 - k / q + k * k) / a0);
+  }
+}
+
+float LoudnessMeter::filter(const Biquad& c, BiquadState& state, float input) {
+  // Transposed direct form II
+  const float output = c.b0 * input + state.z1;
+  state.z1 = c.b1 * input - c.a1 * output + state.z2;
+  state.z2 = c.b2 * input - c.a2 * output;
+  return output;
+}
+
+void LoudnessMeter::process(const float* interleaved, size_t numFrames) {
+  if (resetRequested_.exchange(false)) {
+    clear();
+  }
+
+  float peak = peak_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < numFrames; ++i) {
+    for (int c = 0; c < 2; ++c) {
+      const float sample = interleaved[2 * i + c];
+      peak = std::max(peak, std::abs(sample));
+      const float weighted =
+          filter(highPass_, highPassState_[c], filter(shelf_, shelfState_[c], sample));
+      energy_ += static_cast<double>(weighted) * weighted;
+    }
+    if (++numFrames_ == subBlockFrames_) {
+      endSubBlock();
+    }
+  }
+  peak_.store(peak, std::memory_order_relaxed);
+}
+
+void LoudnessMeter::endSubBlock() {
+  subBlocks_[subBlockIndex_] = energy_ / static_cast<double>(subBlockFrames_);
+  subBlockIndex_ = (subBlockIndex_ + 1) % kShortTermSubBlocks;
+  numSubBlocks_ = std::min(numSubBlocks_ + 1, kShortTermSubBlocks);
+  energy_ = 0.0;
+  numFrames_ = 0;
+
+  auto average = [this](size_t count) {
+    double sum = 0.0;
+    for (size_t i = 1; i <= count; ++i) {
+      sum += subBlocks_[(subBlockIndex_ + kShortTermSubBlocks - i) % kShortTermSubBlocks];
+    }
+    return sum / static_cast<double>(count);
+  };
+
+  if (numSubBlocks_ >= kMomentarySubBlocks) {
+    // Gating blocks are 400ms long and overlap by 75%, i.e. one per sub-block
+    const float momentary = energyToLoudness(average(kMomentarySubBlocks));
+    momentary_.store(momentary, std::memory_order_relaxed);
+    if (momentary > kAbsoluteGate) {
+      const float clamped = std::min(momentary, kHistogramMax);
+      const size_t bin = static_cast<size_t>((clamped - kAbsoluteGate) / kHistogramResolution);
+      histogram_[std::min(bin, kHistogramSize - 1)].fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  if (numSubBlocks_ >= kShortTermSubBlocks) {
+    shortTerm_.store(energyToLoudness(average(kShortTermSubBlocks)), std::memory_order_relaxed);
+  }
+}
+
+LoudnessStatistics LoudnessMeter::getStatistics() const {
+  LoudnessStatistics statistics;
+  statistics.momentary = momentary_.load(std::memory_order_relaxed);
+  statistics.shortTerm = shortTerm_.load(std::memory_order_relaxed);
+  const float peak = peak_.load(std::memory_order_relaxed);
+  statistics.truePeak = peak > 0.f ? 20.f * std::log10(peak) : -INFINITY;
+
+  // Two pass gating: absolute gate (already applied by the histogram), then relative gate
+  std::vector<uint32_t> counts(kHistogramSize);
+  double energy = 0.0;
+  uint64_t numBlocks = 0;
+  for (size_t i = 0; i < kHistogramSize; ++i) {
+    counts[i] = histogram_[i].load(std::memory_order_relaxed);
+    const float loudness = kAbsoluteGate + (static_cast<float>(i) + 0.5f) * kHistogramResolution;
+    energy += counts[i] * loudnessToEnergy(loudness);
+    numBlocks += counts[i];
+  }
+  if (numBlocks == 0) {
+    return statistics;
+  }
+
+  const float relativeGate = energyToLoudness(energy / numBlocks) + kRelativeGate;
+  energy = 0.0;
+  numBlocks = 0;
+  for (size_t i = 0; i < kHistogramSize; ++i) {
+    const float loudness = kAbsoluteGate + (static_cast<float>(i) + 0.5f) * kHistogramResolution;
+    if (loudness > relativeGate) {
+      energy += counts[i] * loudnessToEnergy(loudness);
+      numBlocks += counts[i];
+    }
+  }
+  if (numBlocks > 0) {
+    statistics.integrated = energyToLoudness(energy / numBlocks);
+  }
+  return statistics;
+}
+
+void LoudnessMeter::reset() {
+  momentary_.store(-INFINITY);
+  shortTerm_.store(-INFINITY);
+  resetRequested_.store(true);
+}
+
+void LoudnessMeter::clear() {
+  for (auto& count : histogram_) {
+    count.store(0, std::memory_order_relaxed);
+  }
+  momentary_.store(-INFINITY, std::memory_order_relaxed);
+  shortTerm_.store(-INFINITY, std::memory_order_relaxed);
+  peak_.store(0.f, std::memory_order_relaxed);
+  for (int c = 0; c < 2; ++c) {
+    shelfState_[c] = BiquadState();
+    highPassState_[c] = BiquadState();
+  }
+  energy_ = 0.0;
+  numFrames_ = 0;
+  std::fill(subBlocks_.begin(), subBlocks_.end(), 0.0);
+  subBlockIndex_ = 0;
+  numSubBlocks_ = 0;
+}
+} // namespace TBE
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include "third_party/facebook/Audio360/include/TBE_AudioEngineDefinitions.h"
+
+#include <atomic>
+#include <vector>
+
+namespace TBE {
+/// EBU R128 loudness of the stereo mix. process() runs on the audio thread and is lock-free;
+/// the statistics can be read from any thread. Integrated loudness is gated from a histogram of
+/// 400ms block loudness with 0.1 LU resolution. The true peak is approximated by the sample peak.
+class LoudnessMeter {
+ public:
+  explicit LoudnessMeter(float sampleRate);
+
+  /// Audio thread: measure a block of interleaved stereo audio.
+  void process(const float* interleaved, size_t numFrames);
+
+  LoudnessStatistics getStatistics() const;
+
+  /// Clear all measurements. Takes effect on the audio thread at the next block.
+  void reset();
+
+ private:
+  struct Biquad {
+    float b0, b1, b2, a1, a2;
+  };
+
+  struct BiquadState {
+    float z1{0.f};
+    float z2{0.f};
+  };
+
+  static float filter(const Biquad& coefficients, BiquadState& state, float input);
+  void clear();
+  void endSubBlock();
+
+  Biquad shelf_;
+  Biquad highPass_;
+  const size_t subBlockFrames_;
+  std::vector<std::atomic<uint32_t>> histogram_;
+  std::atomic<float> momentary_;
+  std::atomic<float> shortTerm_;
+  std::atomic<float> peak_{0.f};
+  std::atomic<bool> resetRequested_{false};
+
+  // Audio thread state
+  BiquadState shelfState_[2];
+  BiquadState highPassState_[2];
+  double energy_{0.0};
+  size_t numFrames_{0};
+  std::vector<double> subBlocks_;
+  size_t subBlockIndex_{0};
+  size_t numSubBlocks_{0};
+};
+} // namespace TBE
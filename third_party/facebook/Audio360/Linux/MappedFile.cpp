@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/Linux/MappedFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace TBE {
+MappedFile::MappedFile(const char* data, size_t size) : data_(data), size_(size) {}
+
+MappedFile::~MappedFile() {
+  if (size_ > 0) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+}
+
+EngineError MappedFile::open(std::shared_ptr<MappedFile>& file, const char* nameAndPath) {
+  file.reset();
+  if (nameAndPath == nullptr) {
+    return EngineError::ERROR_OPENING_FILE;
+  }
+
+  const int fd = ::open(nameAndPath, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return EngineError::ERROR_OPENING_FILE;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    ::close(fd);
+    return EngineError::MEMORY_MAP_FAIL;
+  }
+
+  // mmap() rejects empty mappings, an empty file is an empty block of memory
+  const size_t size = static_cast<size_t>(info.st_size);
+  void* data = nullptr;
+  if (size > 0) {
+    data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  // The mapping holds its own reference to the file
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    return EngineError::MEMORY_MAP_FAIL;
+  }
+
+  file.reset(new MappedFile(static_cast<const char*>(data), size));
+  return EngineError::OK;
+}
+} // namespace TBE
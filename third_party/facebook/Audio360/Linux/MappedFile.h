@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include "third_party/facebook/Audio360/include/TBE_AudioEngineDefinitions.h"
+
+#include <memory>
+#include <stddef.h>
+
+namespace TBE {
+/// Read-only memory mapping of a whole file. Shared between the streams that read from it, so it
+/// stays mapped until the last of them is destroyed.
+class MappedFile {
+ public:
+  ~MappedFile();
+
+  /// Map a file into memory.
+  /// \param file Filled in with the mapping on success
+  /// \param nameAndPath Absolute path to the file
+  /// \return EngineError::OK, EngineError::ERROR_OPENING_FILE or EngineError::MEMORY_MAP_FAIL
+  static EngineError open(std::shared_ptr<MappedFile>& file, const char* nameAndPath);
+
+  const char* getData() const {
+    return data_;
+  }
+
+  size_t getSize() const {
+    return size_;
+  }
+
+ private:
+  MappedFile(const char* data, size_t size);
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* data_;
+  size_t size_;
+};
+} // namespace TBE
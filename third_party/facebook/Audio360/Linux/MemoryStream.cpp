@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/Linux/MemoryStream.h"
+
+#include <string.h>
+
+namespace TBE {
+MemoryStream::MemoryStream(const char* data, size_t size, std::shared_ptr<const void> owner)
+    : data_(data), size_(data == nullptr ? 0 : size), owner_(std::move(owner)) {}
+
+MemoryStream::~MemoryStream() {}
+
+size_t MemoryStream::read(void* data, size_t numBytes) {
+  numBytes = std::min(numBytes, size_ - position_);
+  if (numBytes > 0) {
+    memcpy(data, data_ + position_, numBytes);
+  }
+  position_ += numBytes;
+  return numBytes;
+}
+
+size_t MemoryStream::write(void*, size_t) {
+  return 0;
+}
+
+size_t MemoryStream::getPosition() {
+  return position_;
+}
+
+bool MemoryStream::setPosition(size_t pos) {
+  return setPosition(pos, SEEK_SET);
+}
+
+bool MemoryStream::setPosition(size_t pos, int mode) {
+  size_t target = pos;
+  if (mode == SEEK_CUR) {
+    target = position_ + pos;
+  } else if (mode == SEEK_END) {
+    target = size_ + pos;
+  }
+  if (target > size_) {
+    return false;
+  }
+  position_ = target;
+  return true;
+}
+
+int32_t MemoryStream::pushBackByte(int c) {
+  // The memory is read-only, so only the byte that was just read can be pushed back
+  if (c == EOF || position_ == 0 || data_[position_ - 1] != static_cast<char>(c)) {
+    return EOF;
+  }
+  --position_;
+  return static_cast<unsigned char>(c);
+}
+
+size_t MemoryStream::getSize() {
+  return size_;
+}
+
+bool MemoryStream::canSeek() {
+  return true;
+}
+
+bool MemoryStream::ready() const {
+  return data_ != nullptr;
+}
+
+bool MemoryStream::endOfStream() {
+  return position_ >= size_;
+}
+
+const void* MemoryStream::getReadPointer(size_t& numBytes) {
+  numBytes = size_ - position_;
+  return data_ == nullptr ? nullptr : data_ + position_;
+}
+} // namespace TBE
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include "third_party/facebook/Audio360/include/TBE_AudioEngineDefinitions.h"
+#include "third_party/facebook/Audio360/include/TBE_IOStream.h"
+
+#include <memory>
+#include <stdio.h>
+
+namespace TBE {
+/// Read-only IOStream over a block of memory. Supports zero-copy reads through
+/// getReadPointer().
+class MemoryStream : public IOStream {
+ public:
+  /// \param data Start of the memory
+  /// \param size Size of the memory in bytes
+  /// \param owner Keeps the memory alive for the lifetime of the stream. Can be null if the memory
+  /// outlives the stream.
+  MemoryStream(const char* data, size_t size, std::shared_ptr<const void> owner = nullptr);
+  ~MemoryStream() override;
+
+  size_t read(void* data, size_t numBytes) override;
+  size_t write(void* data, size_t numBytes) override;
+  size_t getPosition() override;
+  bool setPosition(size_t pos) override;
+  bool setPosition(size_t pos, int mode) override;
+  int32_t pushBackByte(int c) override;
+  size_t getSize() override;
+  bool canSeek() override;
+  bool ready() const override;
+  bool endOfStream() override;
+  const void* getReadPointer(size_t& numBytes) override;
+
+ private:
+  const char* data_;
+  size_t size_;
+  size_t position_{0};
+  std::shared_ptr<const void> owner_;
+};
+} // namespace TBE
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include "third_party/facebook/Audio360/include/TBE_Quat.hh"
+#include "third_party/facebook/Audio360/include/TBE_Vector.hh"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace TBE {
+/// Largest channel count of any supported ChannelMap (AMBIX_9_2).
+const int32_t kMaxChannels = 11;
+
+/// Trivially copyable quaternion storage so rotations can be shared through a SeqLock.
+struct QuatValue {
+  float x{0.f};
+  float y{0.f};
+  float z{0.f};
+  float w{1.f};
+
+  QuatValue() {}
+
+  explicit QuatValue(const TBQuat& quat) : x(quat.x), y(quat.y), z(quat.z), w(quat.w) {}
+
+  TBQuat toQuat() const {
+    return TBQuat(x, y, z, w);
+  }
+};
+
+/// Counters the sources add to while rendering a block, for the engine's DSP statistics.
+struct BlockStatistics {
+  int32_t numVoices{0};
+  int32_t numActiveVoices{0};
+  int32_t decoderBacklog{0};
+  int32_t numVirtualVoices{0};
+  uint32_t numStarvations{0};
+};
+
+/// Everything a source needs to render one block, prepared by the engine on the audio thread.
+struct MixContext {
+  TBQuat listenerRotation{TBQuat::identity()};
+  TBVector listenerPosition;
+  size_t numFrames{0}; /// Number of frames in this block
+  float sampleRate{0.f};
+  int64_t dspTime{0}; /// DSP time at the start of the block, in samples
+  float* gains{nullptr}; /// Scratch buffer of numFrames floats
+  float* scratch{nullptr}; /// Scratch buffer of numFrames * kMaxChannels floats
+  /// Spatial parameters of the source being rendered, batched by the engine for the sources that
+  /// returned a position from getRelativePosition(). nullptr for the other sources.
+  const Aed* sourceAed{nullptr};
+  BlockStatistics* statistics{nullptr}; /// Counters of the block. Never nullptr when rendering.
+};
+
+/// Internal interface for the objects the engine renders each block.
+class MixerSource {
+ public:
+  virtual ~MixerSource() {}
+
+  /// Audio thread: render the next block and accumulate it into the interleaved stereo mix.
+  virtual void render(const MixContext& context, float* mix) = 0;
+
+  /// Decoder thread, or audio thread if decoding happens in the audio callback: top up any
+  /// streaming buffers.
+  virtual void runDecoderJob() {}
+
+  /// Audio thread: the position of the source relative to the listener's position, called before
+  /// render() so that the engine can compute the spatial parameters of all sources in one batch.
+  /// \return false if the source has no spatial parameters this block
+  virtual bool getRelativePosition(const MixContext& /* context */, TBVector& /* position */)
+      const {
+    return false;
+  }
+
+  /// \return true if runDecoderJob() must be called on the audio thread before render()
+  virtual bool decodesInAudioCallback() const {
+    return false;
+  }
+
+  /// Audio thread: how audible the source is this block, for the engine to pick the voices to
+  /// render when there are more than it may render. Called after getRelativePosition(), with the
+  /// source's spatial parameters in context.sourceAed.
+  /// \param priority Filled in with the priority of the source. Higher priorities win.
+  /// \param gain Filled in with the estimated linear gain of the source. 0 if inaudible.
+  /// \return false if the source must always be rendered
+  virtual bool getAudibility(
+      const MixContext& /* context */,
+      int32_t& /* priority */,
+      float& /* gain */) const {
+    return false;
+  }
+
+  /// Audio thread: called instead of render() when the engine culls the source. The source keeps
+  /// time without rendering audio, so that it can pick up where it would have been when it is
+  /// rendered again.
+  virtual void renderVirtual(const MixContext& context, float* mix) {
+    render(context, mix);
+  }
+};
+} // namespace TBE
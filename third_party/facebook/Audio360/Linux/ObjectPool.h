@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+namespace TBE {
+/// Fixed size pool of preallocated engine objects. Not thread safe.
+template <typename T>
+class ObjectPool {
+ public:
+  template <typename Factory>
+  void allocate(size_t size, Factory factory) {
+    objects_.clear();
+    inUse_.assign(size, false);
+    for (size_t i = 0; i < size; ++i) {
+      objects_.emplace_back(factory());
+    }
+  }
+
+  /// \return A free object, or nullptr if the pool is exhausted
+  T* acquire() {
+    for (size_t i = 0; i < objects_.size(); ++i) {
+      if (!inUse_[i]) {
+        inUse_[i] = true;
+        return objects_[i].get();
+      }
+    }
+    return nullptr;
+  }
+
+  /// Return an object to the pool.
+  void release(T* object) {
+    const size_t index = indexOf(object);
+    if (index < objects_.size()) {
+      inUse_[index] = false;
+    }
+  }
+
+  /// Find an object in use from a pointer to one of its interfaces.
+  /// \return The object, or nullptr if the pointer does not belong to an object in use
+  template <typename Interface>
+  T* find(Interface* object) const {
+    for (size_t i = 0; i < objects_.size(); ++i) {
+      if (inUse_[i] && static_cast<Interface*>(objects_[i].get()) == object) {
+        return objects_[i].get();
+      }
+    }
+    return nullptr;
+  }
+
+  size_t size() const {
+    return objects_.size();
+  }
+
+  size_t getNumFree() const {
+    size_t numFree = 0;
+    for (bool used : inUse_) {
+      numFree += used ? 0 : 1;
+    }
+    return numFree;
+  }
+
+ private:
+  size_t indexOf(const T* object) const {
+    for (size_t i = 0; i < objects_.size(); ++i) {
+      if (objects_[i].get() == object) {
+        return i;
+      }
+    }
+    return objects_.size();
+  }
+
+  std::vector<std::unique_ptr<T>> objects_;
+  std::vector<bool> inUse_;
+};
+} // namespace TBE
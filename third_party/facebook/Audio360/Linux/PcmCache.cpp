@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/Linux/PcmCache.h"
+#include "third_party/facebook/Audio360/Linux/AudioFormatDecoderFactory.h"
+#include "third_party/facebook/Audio360/Linux/FileStream.h"
+
+namespace TBE {
+PcmCache::PcmCache(
+    size_t budgetInBytes,
+    int32_t numThreads,
+    int32_t bufferSize,
+    float sampleRate,
+    std::function<void()> onProgress)
+    : budgetInBytes_(budgetInBytes),
+      bufferSize_(std::max(1, bufferSize)),
+      sampleRate_(sampleRate),
+      onProgress_(std::move(onProgress)) {
+  if (numThreads <= 0) {
+    numThreads = std::max(1, static_cast<int32_t>(std::thread::hardware_concurrency()));
+  }
+  for (int32_t i = 0; i < numThreads; ++i) {
+    workers_.emplace_back(&PcmCache::workerLoop, this);
+  }
+}
+
+PcmCache::~PcmCache() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    quit_ = true;
+  }
+  jobsCondition_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+EngineError PcmCache::createDecoder(
+    AudioFormatDecoder*& decoder,
+    bool& cached,
+    const char* nameAndPath,
+    AssetDescriptor ad) {
+  std::shared_ptr<PcmAsset> asset;
+  AudioFormatDecoder* fileDecoder = nullptr;
+  const EngineError error = acquire(asset, fileDecoder, nameAndPath, ad);
+  if (error != EngineError::OK) {
+    return error;
+  }
+  cached = asset != nullptr;
+  decoder = cached ? new PcmCacheDecoder(asset, sampleRate_, bufferSize_) : fileDecoder;
+  return EngineError::OK;
+}
+
+EngineError PcmCache::preload(const char* nameAndPath, AssetDescriptor ad) {
+  if (nameAndPath != nullptr) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (failedKeys_.erase(makeKey(nameAndPath, ad)) > 0) {
+      return EngineError::FAIL;
+    }
+  }
+
+  std::shared_ptr<PcmAsset> asset;
+  AudioFormatDecoder* fileDecoder = nullptr;
+  const EngineError error = acquire(asset, fileDecoder, nameAndPath, ad);
+  if (error != EngineError::OK) {
+    return error;
+  }
+  if (fileDecoder != nullptr) {
+    delete fileDecoder;
+    return EngineError::CANNOT_ALLOCATE_MEMORY;
+  }
+  return EngineError::OK;
+}
+
+std::string PcmCache::makeKey(const char* nameAndPath, AssetDescriptor ad) {
+  // Paths cannot contain NUL, so the key is unambiguous
+  std::string key(nameAndPath);
+  key.push_back('\0');
+  key += std::to_string(ad.offsetInBytes);
+  key.push_back('\0');
+  key += std::to_string(ad.lengthInBytes);
+  return key;
+}
+
+std::shared_ptr<PcmAsset> PcmCache::find(const std::string& key) {
+  const auto found = index_.find(key);
+  if (found == index_.end()) {
+    return nullptr;
+  }
+  entries_.splice(entries_.begin(), entries_, found->second);
+  return found->second->asset;
+}
+
+bool PcmCache::insert(
+    const std::string& key,
+    std::shared_ptr<PcmAsset> asset,
+    AudioFormatDecoder* decoder) {
+  // Assets referenced by a decoder or a job are in use and cannot be evicted. References are only
+  // added with the mutex held, so an asset seen unused stays unused.
+  const size_t numBytes = asset->samples.size() * sizeof(float);
+  size_t numEvictable = 0;
+  for (const Entry& entry : entries_) {
+    if (entry.asset.use_count() == 1) {
+      numEvictable += entry.numBytes;
+    }
+  }
+  if (numBytes > budgetInBytes_ || numBytes_ - numEvictable > budgetInBytes_ - numBytes) {
+    return false;
+  }
+
+  for (auto it = entries_.end(); numBytes_ > budgetInBytes_ - numBytes;) {
+    --it;
+    if (it->asset.use_count() == 1) {
+      numBytes_ -= it->numBytes;
+      index_.erase(it->key);
+      it = entries_.erase(it);
+    }
+  }
+
+  Entry entry;
+  entry.key = key;
+  entry.asset = asset;
+  entry.numBytes = numBytes;
+  entries_.push_front(std::move(entry));
+  index_[key] = entries_.begin();
+  numBytes_ += numBytes;
+  failedKeys_.erase(key);
+
+  Job job;
+  job.key = key;
+  job.asset = std::move(asset);
+  job.decoder.reset(decoder);
+  jobs_.push_back(std::move(job));
+  jobsCondition_.notify_one();
+  return true;
+}
+
+EngineError PcmCache::acquire(
+    std::shared_ptr<PcmAsset>& asset,
+    AudioFormatDecoder*& decoder,
+    const char* nameAndPath,
+    AssetDescriptor ad) {
+  if (nameAndPath == nullptr) {
+    return EngineError::ERROR_OPENING_FILE;
+  }
+
+  const std::string key = makeKey(nameAndPath, ad);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    asset = find(key);
+    if (asset) {
+      return EngineError::OK;
+    }
+  }
+
+  // Open the asset without the lock, so that lookups are not held up by the file system
+  FileStream* stream = new FileStream();
+  EngineError error = stream->open(nameAndPath, ad);
+  if (error != EngineError::OK) {
+    delete stream;
+    return error;
+  }
+  AudioFormatDecoder* fileDecoder = nullptr;
+  error = createAudioFormatDecoder(
+      fileDecoder, stream, true, getAssetCodec(nameAndPath), bufferSize_, sampleRate_);
+  if (error != EngineError::OK) {
+    return error;
+  }
+
+  std::shared_ptr<PcmAsset> created = std::make_shared<PcmAsset>();
+  created->numChannels = fileDecoder->getNumOfChannels();
+  created->numFrames = fileDecoder->getNumSamplesPerChannel();
+  const size_t numSamples = created->numFrames * static_cast<size_t>(created->numChannels);
+  const bool fits = created->numChannels > 0 && numSamples * sizeof(float) <= budgetInBytes_;
+  if (fits) {
+    created->samples.resize(numSamples);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  asset = find(key);
+  if (asset) {
+    // Another thread added the asset in the meantime
+    delete fileDecoder;
+    return EngineError::OK;
+  }
+  if (fits && insert(key, created, fileDecoder)) {
+    asset = std::move(created);
+    return EngineError::OK;
+  }
+  decoder = fileDecoder;
+  return EngineError::OK;
+}
+
+void PcmCache::evictFailed(const std::string& key, const std::shared_ptr<PcmAsset>& asset) {
+  const auto found = index_.find(key);
+  if (found != index_.end() && found->second->asset == asset) {
+    numBytes_ -= found->second->numBytes;
+    entries_.erase(found->second);
+    index_.erase(found);
+  }
+  failedKeys_.insert(key);
+}
+
+void PcmCache::workerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    jobsCondition_.wait(lock, [this] { return quit_ || !jobs_.empty(); });
+    if (quit_) {
+      return;
+    }
+    Job job = std::move(jobs_.front());
+    jobs_.pop_front();
+    lock.unlock();
+    fill(job);
+    job = Job();
+    lock.lock();
+  }
+}
+
+void PcmCache::fill(Job& job) {
+  PcmAsset& asset = *job.asset;
+  const size_t numChannels = static_cast<size_t>(asset.numChannels);
+  const size_t chunkSize = static_cast<size_t>(bufferSize_);
+  size_t numDecoded = 0;
+  while (numDecoded < asset.numFrames) {
+    const size_t numFrames = std::min(chunkSize, asset.numFrames - numDecoded);
+    const size_t numRead = job.decoder->decode(
+                               asset.samples.data() + numDecoded * numChannels,
+                               static_cast<int32_t>(numFrames * numChannels)) /
+        numChannels;
+    if (numRead == 0) {
+      break;
+    }
+    numDecoded += numRead;
+    asset.numDecoded.store(numDecoded, std::memory_order_release);
+    if (onProgress_) {
+      onProgress_();
+    }
+    if (quit_.load()) {
+      break;
+    }
+  }
+
+  // A read error, or a file shorter than its header says. Decoders play what was decoded.
+  const bool failed = numDecoded < asset.numFrames && !quit_.load();
+  asset.failed.store(failed, std::memory_order_release);
+  asset.complete.store(true, std::memory_order_release);
+  if (failed) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    evictFailed(job.key, job.asset);
+  }
+  if (onProgress_) {
+    onProgress_();
+  }
+}
+} // namespace TBE
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include "third_party/facebook/Audio360/Linux/PcmCacheDecoder.h"
+#include "third_party/facebook/Audio360/include/TBE_AudioEngine.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace TBE {
+/// Engine-wide cache of decoded and resampled assets, keyed by path and AssetDescriptor, so that
+/// audio objects playing the same asset share one copy and only the first one decodes it. Assets
+/// are decoded by a pool of worker threads, several at a time, and can be played while they are
+/// being decoded. The decoders handed out hold a reference to their asset: assets in use are never
+/// evicted, the others are evicted least recently used first to stay within the memory budget.
+/// Thread safe.
+class PcmCache {
+ public:
+  /// \param budgetInBytes Maximum size of the decoded audio in the cache
+  /// \param numThreads Number of worker threads. If 0, one per processor core.
+  /// \param bufferSize Number of frames decoded at a time, and the maximum read by the decoders
+  /// \param sampleRate Sample rate the assets are resampled to
+  /// \param onProgress Called by the workers whenever more of an asset has been decoded. Can be
+  /// empty.
+  PcmCache(
+      size_t budgetInBytes,
+      int32_t numThreads,
+      int32_t bufferSize,
+      float sampleRate,
+      std::function<void()> onProgress);
+  ~PcmCache();
+
+  /// Create a decoder for an asset. The decoder reads from the cache if the asset is cached or
+  /// fits in the cache, in which case the asset is queued for decoding if needed. Otherwise it
+  /// decodes the file itself.
+  /// \param cached Set to true if the decoder reads from the cache. It may then run dry until the
+  /// asset is decoded, see PcmCacheDecoder.
+  /// \return EngineError::OK or the error from opening the asset
+  EngineError createDecoder(
+      AudioFormatDecoder*& decoder,
+      bool& cached,
+      const char* nameAndPath,
+      AssetDescriptor ad);
+
+  /// Queue an asset for decoding if it is not cached yet.
+  /// \return EngineError::OK, EngineError::CANNOT_ALLOCATE_MEMORY if the asset does not fit in the
+  /// cache, the error from opening the asset or EngineError::FAIL if the last decoding of the asset
+  /// failed. The failure is only returned once: the next call queues the asset again.
+  EngineError preload(const char* nameAndPath, AssetDescriptor ad);
+
+ private:
+  struct Entry {
+    std::string key;
+    std::shared_ptr<PcmAsset> asset;
+    size_t numBytes{0};
+  };
+
+  struct Job {
+    std::string key;
+    std::shared_ptr<PcmAsset> asset;
+    std::unique_ptr<AudioFormatDecoder> decoder;
+  };
+
+  static std::string makeKey(const char* nameAndPath, AssetDescriptor ad);
+
+  /// Find an asset and mark it as most recently used. The cache mutex must be held.
+  std::shared_ptr<PcmAsset> find(const std::string& key);
+
+  /// Add an asset and queue it for decoding, evicting unused assets to make space. The cache
+  /// mutex must be held.
+  /// \return false if the asset does not fit, in which case nothing is changed
+  bool insert(
+      const std::string& key,
+      std::shared_ptr<PcmAsset> asset,
+      AudioFormatDecoder* decoder);
+
+  /// Look up an asset, or open it and add it to the cache.
+  /// \param decoder Filled in with the decoder of the asset if it does not fit in the cache
+  EngineError acquire(
+      std::shared_ptr<PcmAsset>& asset,
+      AudioFormatDecoder*& decoder,
+      const char* nameAndPath,
+      AssetDescriptor ad);
+
+  /// Drop an asset whose decoding failed, so that it is decoded again the next time it is used.
+  /// Decoders that play it keep it until they are destroyed, outside of the budget. The cache
+  /// mutex must be held.
+  void evictFailed(const std::string& key, const std::shared_ptr<PcmAsset>& asset);
+
+  void workerLoop();
+  void fill(Job& job);
+
+  const size_t budgetInBytes_;
+  const int32_t bufferSize_;
+  const float sampleRate_;
+  const std::function<void()> onProgress_;
+
+  std::mutex mutex_;
+  std::list<Entry> entries_; /// Most recently used first
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+  size_t numBytes_{0};
+  std::unordered_set<std::string> failedKeys_; /// Failures not yet returned by preload()
+  std::deque<Job> jobs_;
+  std::condition_variable jobsCondition_;
+  std::atomic<bool> quit_{false}; /// Set with the mutex held, read by the workers while filling
+  std::vector<std::thread> workers_;
+};
+} // namespace TBE
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/Linux/PcmCacheDecoder.h"
+
+#include <algorithm>
+
+namespace TBE {
+PcmCacheDecoder::PcmCacheDecoder(
+    std::shared_ptr<const PcmAsset> asset,
+    float sampleRate,
+    int32_t maxBufferSizePerChannel)
+    : asset_(std::move(asset)),
+      sampleRate_(sampleRate),
+      maxBufferSizePerChannel_(maxBufferSizePerChannel) {}
+
+PcmCacheDecoder::~PcmCacheDecoder() {}
+
+int32_t PcmCacheDecoder::getNumOfChannels() const {
+  return asset_->numChannels;
+}
+
+size_t PcmCacheDecoder::getNumTotalSamples() const {
+  return getNumSamplesPerChannel() * asset_->numChannels;
+}
+
+size_t PcmCacheDecoder::getNumSamplesPerChannel() const {
+  // A truncated asset completes early
+  return asset_->complete.load(std::memory_order_acquire)
+      ? asset_->numDecoded.load(std::memory_order_acquire)
+      : asset_->numFrames;
+}
+
+double PcmCacheDecoder::getMsPerChannel() const {
+  return sampleRate_ > 0.f ? getNumSamplesPerChannel() * 1000.0 / sampleRate_ : 0.0;
+}
+
+size_t PcmCacheDecoder::getSamplePosition() {
+  return position_;
+}
+
+EngineError PcmCacheDecoder::seekToSample(size_t samplePosition) {
+  if (samplePosition > getNumSamplesPerChannel()) {
+    return EngineError::FAIL;
+  }
+  position_ = samplePosition;
+  return EngineError::OK;
+}
+
+size_t PcmCacheDecoder::decode(const char*, size_t, float*, int32_t) {
+  return 0;
+}
+
+size_t PcmCacheDecoder::decode(float* bufferOut, int32_t numOfSamplesInBuffer) {
+  if (bufferOut == nullptr || numOfSamplesInBuffer <= 0) {
+    return 0;
+  }
+
+  const size_t numChannels = static_cast<size_t>(asset_->numChannels);
+  const size_t numDecoded = asset_->numDecoded.load(std::memory_order_acquire);
+  const size_t numFrames = std::min(
+      static_cast<size_t>(numOfSamplesInBuffer) / numChannels,
+      numDecoded - std::min(position_, numDecoded));
+  const float* in = asset_->samples.data() + position_ * numChannels;
+  std::copy(in, in + numFrames * numChannels, bufferOut);
+  position_ += numFrames;
+  return numFrames * numChannels;
+}
+
+float PcmCacheDecoder::getSampleRate() const {
+  return sampleRate_;
+}
+
+float PcmCacheDecoder::getOutputSampleRate() const {
+  return sampleRate_;
+}
+
+int32_t PcmCacheDecoder::getNumBits() const {
+  return 32;
+}
+
+bool PcmCacheDecoder::endOfStream() {
+  return asset_->complete.load(std::memory_order_acquire) &&
+      position_ >= asset_->numDecoded.load(std::memory_order_acquire);
+}
+
+bool PcmCacheDecoder::decoderError() {
+  return asset_->failed.load(std::memory_order_acquire);
+}
+
+int32_t PcmCacheDecoder::getMaxBufferSizePerChannel() const {
+  return maxBufferSizePerChannel_;
+}
+
+const char* PcmCacheDecoder::getName() const {
+  return "pcm cache";
+}
+
+void PcmCacheDecoder::flush(bool resetToZero) {
+  if (resetToZero) {
+    position_ = 0;
+  }
+}
+
+int32_t PcmCacheDecoder::getInfo(Info) {
+  return 0;
+}
+} // namespace TBE
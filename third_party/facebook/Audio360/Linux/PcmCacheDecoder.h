@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include "third_party/facebook/Audio360/include/TBE_AudioEngine.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace TBE {
+/// Decoded and resampled audio of an asset in the PCM cache. The samples are written by one cache
+/// worker and read by any number of decoders: frames before numDecoded can be read from any
+/// thread, as the worker never touches them again.
+struct PcmAsset {
+  int32_t numChannels{0};
+  size_t numFrames{0}; /// Expected length of the asset in frames
+  std::vector<float> samples; /// numFrames interleaved frames
+  std::atomic<size_t> numDecoded{0}; /// Frames decoded so far, published with release
+  std::atomic<bool> complete{false}; /// Set once numDecoded is final
+  std::atomic<bool> failed{false}; /// Set before complete if decoding stopped before numFrames
+};
+
+/// AudioFormatDecoder that plays an asset from the PCM cache. decode(..) copies frames and does no
+/// decoding work. While the asset is still being filled it can return 0 before the end of the
+/// stream, in which case it must be called again later.
+class PcmCacheDecoder : public AudioFormatDecoder {
+ public:
+  /// \param asset Asset to play. Shared with the cache and the other decoders that play it.
+  /// \param sampleRate Sample rate of the asset, the engine's sample rate
+  /// \param maxBufferSizePerChannel Maximum number of samples per channel requested by decode(..)
+  PcmCacheDecoder(
+      std::shared_ptr<const PcmAsset> asset,
+      float sampleRate,
+      int32_t maxBufferSizePerChannel);
+  ~PcmCacheDecoder() override;
+
+  int32_t getNumOfChannels() const override;
+  size_t getNumTotalSamples() const override;
+  size_t getNumSamplesPerChannel() const override;
+  double getMsPerChannel() const override;
+  size_t getSamplePosition() override;
+  EngineError seekToSample(size_t samplePosition) override;
+  size_t decode(
+      const char* data,
+      size_t dataSize,
+      float* bufferOut,
+      int32_t numOfSamplesInBuffer) override;
+  size_t decode(float* bufferOut, int32_t numOfSamplesInBuffer) override;
+  float getSampleRate() const override;
+  float getOutputSampleRate() const override;
+  int32_t getNumBits() const override;
+  bool endOfStream() override;
+  bool decoderError() override;
+  int32_t getMaxBufferSizePerChannel() const override;
+  const char* getName() const override;
+  void flush(bool resetToZero = false) override;
+  int32_t getInfo(Info info) override;
+
+ private:
+  const std::shared_ptr<const PcmAsset> asset_;
+  const float sampleRate_;
+  const int32_t maxBufferSizePerChannel_;
+  size_t position_{0};
+};
+} // namespace TBE
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include "third_party/facebook/Audio360/Linux/RingBuffer.h"
+#include "third_party/facebook/Audio360/include/TBE_AudioEngineDefinitions.h"
+
+#include <cstring>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace TBE {
+/// Producer: describe the writable space of a ring buffer of interleaved frames. The ring's write
+/// index must stay on frame boundaries, so its buffer size must be a multiple of numChannels.
+/// \return Number of frames available, at most numFrames
+inline size_t acquireRegion(
+    RingBuffer<float>& buffer,
+    int32_t numChannels,
+    size_t numFrames,
+    QueueWriteRegion& region) {
+  const size_t stride = static_cast<size_t>(numChannels);
+  size_t numFirst = 0;
+  numFrames = buffer.acquireWrite(numFrames * stride, region.data[0], numFirst, region.data[1]) /
+      stride;
+  region.numFrames[0] = static_cast<int32_t>(std::min(numFrames, numFirst / stride));
+  region.numFrames[1] = static_cast<int32_t>(numFrames) - region.numFrames[0];
+  region.numChannels = numChannels;
+  return numFrames;
+}
+
+/// Fill the first numFrames frames of a region. convert(frame, channel) returns each sample.
+template <typename Convert>
+void fillRegion(const QueueWriteRegion& region, size_t numFrames, Convert convert) {
+  const size_t stride = static_cast<size_t>(region.numChannels);
+  size_t frame = 0;
+  for (int32_t part = 0; part < 2 && frame < numFrames; ++part) {
+    float* out = region.data[part];
+    const size_t count =
+        std::min(numFrames - frame, static_cast<size_t>(region.numFrames[part]));
+    for (size_t i = 0; i < count; ++i, ++frame) {
+      for (size_t c = 0; c < stride; ++c) {
+        out[i * stride + c] = convert(frame, c);
+      }
+    }
+  }
+}
+
+/// \return True if channelBuffers and each of its first numChannels buffers are set
+template <typename T>
+bool areBuffersValid(const T* const* channelBuffers, size_t numChannels) {
+  if (channelBuffers == nullptr) {
+    return false;
+  }
+  for (size_t c = 0; c < numChannels; ++c) {
+    if (channelBuffers[c] == nullptr) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Convert the 16 bit samples a client wrote at the start of each part of a region to float, in
+/// the first numFrames frames. Runs backwards as every float overwrites two 16 bit samples.
+inline void convertRegionFromInt16(const QueueWriteRegion& region, size_t numFrames) {
+  const size_t stride = static_cast<size_t>(region.numChannels);
+  size_t frame = 0;
+  for (int32_t part = 0; part < 2 && frame < numFrames; ++part) {
+    float* out = region.data[part];
+    const size_t count =
+        std::min(numFrames - frame, static_cast<size_t>(region.numFrames[part]));
+    // The samples are read through memcpy as the memory holds floats as far as C++ is concerned
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(out);
+    for (size_t i = count * stride; i-- > 0;) {
+      int16_t sample;
+      std::memcpy(&sample, in + i * sizeof(int16_t), sizeof(int16_t));
+      out[i] = static_cast<float>(sample) / 32768.f;
+    }
+    frame += count;
+  }
+}
+} // namespace TBE
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <stddef.h>
+#include <vector>
+
+namespace TBE {
+/// Lock-free circular buffer, thread safe for one producer and one consumer.
+/// resize() and reset() are not thread safe and must only be called while neither side is active.
+template <typename T>
+class RingBuffer {
+ public:
+  explicit RingBuffer(size_t capacity = 0) {
+    resize(capacity);
+  }
+
+  /// Reallocate the buffer to hold capacity elements and discard its contents.
+  void resize(size_t capacity) {
+    buffer_.assign(capacity + 1, T());
+    reset();
+  }
+
+  /// Discard the contents of the buffer.
+  void reset() {
+    readIndex_.store(0, std::memory_order_relaxed);
+    writeIndex_.store(0, std::memory_order_relaxed);
+  }
+
+  /// \return The maximum number of elements the buffer can hold
+  size_t capacity() const {
+    return buffer_.size() - 1;
+  }
+
+  /// \return The number of elements available to the consumer
+  size_t getNumReadable() const {
+    const size_t write = writeIndex_.load(std::memory_order_acquire);
+    const size_t read = readIndex_.load(std::memory_order_relaxed);
+    return write >= read ? write - read : write + buffer_.size() - read;
+  }
+
+  /// \return The number of elements that can be written by the producer
+  size_t getNumWritable() const {
+    const size_t write = writeIndex_.load(std::memory_order_relaxed);
+    const size_t read = readIndex_.load(std::memory_order_acquire);
+    return read > write ? read - write - 1 : read + buffer_.size() - write - 1;
+  }
+
+  /// Producer: copy up to count elements into the buffer.
+  /// \return Number of elements written
+  size_t write(const T* data, size_t count) {
+    T* first = nullptr;
+    T* second = nullptr;
+    size_t numFirst = 0;
+    count = acquireWrite(count, first, numFirst, second);
+    std::copy(data, data + numFirst, first);
+    std::copy(data + numFirst, data + count, second);
+    commitWrite(count);
+    return count;
+  }
+
+  /// Producer: get space to fill in place, instead of copying into the buffer with write(). The
+  /// space can wrap around the end of the buffer, so it comes in two parts: numFirst elements at
+  /// first, then the rest at second. Nothing is visible to the consumer until commitWrite().
+  /// \return Number of elements available, at most count
+  size_t acquireWrite(size_t count, T*& first, size_t& numFirst, T*& second) {
+    count = std::min(count, getNumWritable());
+    const size_t write = writeIndex_.load(std::memory_order_relaxed);
+    first = buffer_.data() + write;
+    numFirst = std::min(count, buffer_.size() - write);
+    second = buffer_.data();
+    return count;
+  }
+
+  /// Producer: publish count elements filled in through acquireWrite().
+  void commitWrite(size_t count) {
+    const size_t write = writeIndex_.load(std::memory_order_relaxed);
+    writeIndex_.store(wrap(write + count), std::memory_order_release);
+  }
+
+  /// Producer: push a single element.
+  /// \return false if the buffer is full
+  bool push(const T& value) {
+    return write(&value, 1) == 1;
+  }
+
+  /// Consumer: copy up to count elements out of the buffer.
+  /// \return Number of elements read
+  size_t read(T* data, size_t count) {
+    count = std::min(count, getNumReadable());
+    const size_t read = readIndex_.load(std::memory_order_relaxed);
+    const size_t first = std::min(count, buffer_.size() - read);
+    std::copy(buffer_.begin() + read, buffer_.begin() + read + first, data);
+    std::copy(buffer_.begin(), buffer_.begin() + (count - first), data + first);
+    readIndex_.store(wrap(read + count), std::memory_order_release);
+    return count;
+  }
+
+  /// Consumer: pop a single element.
+  /// \return false if the buffer is empty
+  bool pop(T& value) {
+    return read(&value, 1) == 1;
+  }
+
+  /// Consumer: look at the next element without removing it.
+  /// \return false if the buffer is empty
+  bool peek(T& value) const {
+    if (getNumReadable() == 0) {
+      return false;
+    }
+    value = buffer_[readIndex_.load(std::memory_order_relaxed)];
+    return true;
+  }
+
+  /// Consumer: drop up to count elements.
+  /// \return Number of elements dropped
+  size_t discard(size_t count) {
+    count = std::min(count, getNumReadable());
+    const size_t read = readIndex_.load(std::memory_order_relaxed);
+    readIndex_.store(wrap(read + count), std::memory_order_release);
+    return count;
+  }
+
+ private:
+  size_t wrap(size_t index) const {
+    return index >= buffer_.size() ? index - buffer_.size() : index;
+  }
+
+  std::vector<T> buffer_;
+  std::atomic<size_t> readIndex_{0};
+  std::atomic<size_t> writeIndex_{0};
+};
+} // namespace TBE
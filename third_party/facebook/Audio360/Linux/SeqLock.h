@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+namespace TBE {
+/// Lock-free container for small trivially copyable values (poses, callbacks) that are set from a
+/// client thread and read from the audio thread. Readers never block and retry
+/// if they observe a write in progress. Only one thread may call store() at a time.
+template <typename T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable<T>::value, "SeqLock requires a trivially copyable type");
+
+ public:
+  SeqLock() : SeqLock(T()) {}
+
+  explicit SeqLock(const T& value) {
+    store(value);
+  }
+
+  void store(const T& value) {
+    uint32_t words[kNumWords] = {};
+    memcpy(words, &value, sizeof(T));
+
+    const uint32_t seq = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kNumWords; ++i) {
+      words_[i].store(words[i], std::memory_order_relaxed);
+    }
+    sequence_.store(seq + 2, std::memory_order_release);
+  }
+
+  T load() const {
+    uint32_t words[kNumWords];
+    uint32_t before = 0;
+    uint32_t after = 0;
+    do {
+      before = sequence_.load(std::memory_order_acquire);
+      for (size_t i = 0; i < kNumWords; ++i) {
+        words[i] = words_[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      after = sequence_.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+
+    T value;
+    memcpy(&value, words, sizeof(T));
+    return value;
+  }
+
+ private:
+  static const size_t kNumWords = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+  std::atomic<uint32_t> sequence_{0};
+  std::atomic<uint32_t> words_[kNumWords];
+};
+} // namespace TBE
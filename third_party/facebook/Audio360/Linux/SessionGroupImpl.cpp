@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/Linux/SessionGroupImpl.h"
+
+namespace TBE {
+SessionGroupImpl::SessionGroupImpl(const SessionGroupSettings& settings)
+    : settings_(settings), pool_(settings.numThreads) {}
+
+SessionGroupImpl::~SessionGroupImpl() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (const auto& session : sessions_) {
+    const Session* s = session.second.get();
+    condition_.wait(lock, [s] { return s->state == IDLE; });
+  }
+}
+
+EngineError SessionGroupImpl::createSession(AudioEngine*& session, MemorySettings memorySettings) {
+  session = nullptr;
+
+  // Decoding and event dispatching happen on the group's threads
+  EngineInitSettings settings;
+  settings.audioSettings = settings_.audioSettings;
+  settings.audioSettings.deviceType = AudioDeviceType::DISABLED;
+  settings.memorySettings = memorySettings;
+  settings.extensions.maxActiveVoices = settings_.maxActiveVoices;
+  settings.threads.useDecoderThread = false;
+  settings.threads.useEventThread = false;
+
+  std::unique_ptr<Session> s(new Session());
+  s->engine.reset(new AudioEngineImpl(settings));
+  const EngineError error = s->engine->init();
+  if (error != EngineError::OK) {
+    return error;
+  }
+  // Sized once, so that render() does not allocate
+  s->buffer.resize(static_cast<size_t>(s->engine->getBufferSize()) * 2);
+
+  if (settings_.pcmCacheSizeInBytes > 0) {
+    // Every session has the same sample rate and buffer size, so the first one sets up the cache
+    if (!pcmCache_) {
+      pcmCache_ = std::make_shared<PcmCache>(
+          settings_.pcmCacheSizeInBytes,
+          settings_.numCacheThreads,
+          s->engine->getBufferSize(),
+          s->engine->getSampleRate(),
+          nullptr);
+    }
+    s->engine->setPcmCache(pcmCache_);
+  }
+
+  session = s->engine.get();
+  sessions_[session] = std::move(s);
+  return EngineError::OK;
+}
+
+void SessionGroupImpl::destroySession(AudioEngine*& session) {
+  const auto found = sessions_.find(session);
+  if (found == sessions_.end()) {
+    return;
+  }
+  {
+    const Session* s = found->second.get();
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [s] { return s->state == IDLE; });
+  }
+  sessions_.erase(found);
+  session = nullptr;
+}
+
+size_t SessionGroupImpl::getNumSessions() const {
+  return sessions_.size();
+}
+
+EngineError SessionGroupImpl::render(SessionBlock* blocks, size_t numBlocks, double deadlineMs) {
+  // Also rejects NaN
+  if (!(deadlineMs >= 0.0) || (blocks == nullptr && numBlocks > 0)) {
+    return EngineError::INVALID_SETTINGS;
+  }
+  for (size_t i = 0; i < numBlocks; ++i) {
+    const SessionBlock& block = blocks[i];
+    const auto found = sessions_.find(block.session);
+    if (found == sessions_.end()) {
+      return EngineError::FAIL;
+    }
+    if (block.buffer == nullptr) {
+      return EngineError::INVALID_SETTINGS;
+    }
+    if (block.numOfSamples < 0 || block.numOfSamples % 2 != 0 ||
+        static_cast<size_t>(block.numOfSamples) > found->second->buffer.size()) {
+      return EngineError::INVALID_BUFFER_SIZE;
+    }
+  }
+
+  const bool hasDeadline = deadlineMs > 0.0;
+  const Clock::time_point deadline = Clock::now() +
+      std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double, std::milli>(deadlineMs));
+
+  // Queue every idle session. Busy ones are still rendering a late block.
+  submitted_.assign(numBlocks, nullptr);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < numBlocks; ++i) {
+      Session& s = *sessions_[blocks[i].session];
+      if (s.state != IDLE) {
+        continue;
+      }
+      s.numOfSamples = blocks[i].numOfSamples;
+      s.deadline = deadline;
+      s.hasDeadline = hasDeadline;
+      s.state = QUEUED;
+      ++numOutstanding_;
+      submitted_[i] = &s;
+    }
+  }
+  for (Session* s : submitted_) {
+    if (s != nullptr) {
+      pool_.submit([this, s] { renderSession(*s); });
+    }
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const auto finished = [this] { return numOutstanding_ == 0; };
+    if (hasDeadline) {
+      condition_.wait_until(lock, deadline, finished);
+    } else {
+      condition_.wait(lock, finished);
+    }
+
+    // Give up on the sessions that have not finished
+    for (size_t i = 0; i < numBlocks; ++i) {
+      Session* s = submitted_[i];
+      SessionBlockResult& result = blocks[i].result;
+      if (s == nullptr) {
+        result = SessionBlockResult::BUSY;
+        continue;
+      }
+      switch (s->state) {
+        case DONE:
+          result = SessionBlockResult::RENDERED;
+          s->state = IDLE;
+          break;
+        case RUNNING:
+          result = SessionBlockResult::LATE;
+          s->state = ABANDONED;
+          break;
+        case QUEUED:
+          result = SessionBlockResult::DROPPED;
+          s->state = CANCELLED;
+          break;
+        default:
+          result = SessionBlockResult::DROPPED;
+          s->state = IDLE;
+          break;
+      }
+    }
+    numOutstanding_ = 0;
+  }
+
+  // The rendered buffers are not touched by the workers until the next call
+  for (size_t i = 0; i < numBlocks; ++i) {
+    SessionBlock& block = blocks[i];
+    if (block.result == SessionBlockResult::RENDERED) {
+      const std::vector<float>& buffer = submitted_[i]->buffer;
+      std::copy(buffer.begin(), buffer.begin() + block.numOfSamples, block.buffer);
+    } else {
+      std::fill(block.buffer, block.buffer + block.numOfSamples, 0.f);
+    }
+    block.session->processEventsOnThisThread();
+  }
+  return EngineError::OK;
+}
+
+void SessionGroupImpl::renderSession(Session& session) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (session.state == CANCELLED) {
+      session.state = IDLE;
+      condition_.notify_all();
+      return;
+    }
+    if (session.hasDeadline && Clock::now() > session.deadline) {
+      session.state = DROPPED;
+      --numOutstanding_;
+      condition_.notify_all();
+      return;
+    }
+    session.state = RUNNING;
+  }
+
+  session.engine->getAudioMix(session.buffer.data(), session.numOfSamples, 2);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (session.state == ABANDONED) {
+    session.state = IDLE;
+  } else {
+    session.state = DONE;
+    --numOutstanding_;
+  }
+  condition_.notify_all();
+}
+} // namespace TBE
+
+TBE::EngineError TBE_CreateSessionGroup(
+    TBE::SessionGroup*& group,
+    TBE::SessionGroupSettings settings) {
+  group = nullptr;
+  if (settings.numThreads < 1 || settings.numCacheThreads < 0) {
+    return TBE::EngineError::INVALID_SETTINGS;
+  }
+  group = new TBE::SessionGroupImpl(settings);
+  return TBE::EngineError::OK;
+}
+
+void TBE_DestroySessionGroup(TBE::SessionGroup*& group) {
+  delete group;
+  group = nullptr;
+}
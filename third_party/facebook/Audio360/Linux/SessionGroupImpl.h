@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include "third_party/facebook/Audio360/Linux/AudioEngineImpl.h"
+#include "third_party/facebook/Audio360/Linux/PcmCache.h"
+#include "third_party/facebook/Audio360/Linux/WorkStealingPool.h"
+#include "third_party/facebook/Audio360/include/TBE_SessionGroup.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace TBE {
+/// Renders the blocks of many AudioEngineImpl sessions on a WorkStealingPool. Each session renders
+/// into a buffer of its own, which is copied to the client's buffer if it completes before the
+/// deadline; a session that misses the deadline finishes in the background and is skipped until
+/// it is done, so the client's buffers are never written after render() returns.
+class SessionGroupImpl : public SessionGroup {
+ public:
+  explicit SessionGroupImpl(const SessionGroupSettings& settings);
+  ~SessionGroupImpl() override;
+
+  EngineError createSession(AudioEngine*& session, MemorySettings memorySettings) override;
+  void destroySession(AudioEngine*& session) override;
+  size_t getNumSessions() const override;
+  EngineError render(SessionBlock* blocks, size_t numBlocks, double deadlineMs) override;
+
+ private:
+  typedef std::chrono::steady_clock Clock;
+
+  enum State {
+    IDLE,
+    QUEUED, /// Waiting for a worker
+    RUNNING, /// Rendering on a worker
+    DONE, /// Rendered, waiting for render() to collect the block
+    DROPPED, /// Started after the deadline and did not render, waiting for render() to collect it
+    CANCELLED, /// Given up on by render() while queued. Returns to IDLE when a worker takes it.
+    ABANDONED, /// Given up on by render() while rendering. Returns to IDLE when it completes.
+  };
+
+  struct Session {
+    std::unique_ptr<AudioEngineImpl> engine;
+    std::vector<float> buffer; /// One stereo buffer, written by the worker while RUNNING
+    int32_t numOfSamples{0};
+    Clock::time_point deadline;
+    bool hasDeadline{false};
+    State state{IDLE}; /// Guarded by the group's mutex
+  };
+
+  /// Worker: render a session's block.
+  void renderSession(Session& session);
+
+  const SessionGroupSettings settings_;
+  std::shared_ptr<PcmCache> pcmCache_;
+  std::unordered_map<AudioEngine*, std::unique_ptr<Session>> sessions_;
+  std::vector<Session*> submitted_; /// Sessions queued by the current call to render()
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  size_t numOutstanding_{0}; /// Sessions of the current call that are QUEUED or RUNNING
+
+  // Declared last so that the workers stop before the sessions go away
+  WorkStealingPool pool_;
+};
+} // namespace TBE
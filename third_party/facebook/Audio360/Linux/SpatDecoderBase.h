@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include "third_party/facebook/Audio360/Linux/EventDispatcher.h"
+#include "third_party/facebook/Audio360/Linux/MixContext.h"
+#include "third_party/facebook/Audio360/Linux/SeqLock.h"
+#include "third_party/facebook/Audio360/Linux/Transport.h"
+#include "third_party/facebook/Audio360/include/TBE_AudioEngine.h"
+#include "third_party/facebook/Audio360/include/TBE_AudioEngineExtensions.h"
+
+namespace TBE {
+/// Focus settings shared between the client and audio threads.
+struct FocusSettings {
+  bool enabled{false};
+  bool followListener{false};
+  float offFocusLeveldB{-24.f};
+  float widthDegrees{90.f};
+  QuatValue orientation;
+};
+
+/// Linear gain of a direction under a focus setting.
+/// \param direction Unit direction of the source from the listener's perspective
+inline float getFocusGain(const FocusSettings& focus, const TBVector& direction) {
+  if (!focus.enabled) {
+    return 1.f;
+  }
+  const TBVector focusDirection = focus.followListener
+      ? TBVector::forward()
+      : TBQuat::getForwardFromQuat(focus.orientation.toQuat());
+  const float cosine =
+      std::min(1.f, std::max(-1.f, TBVector::DotProduct(direction, focusDirection)));
+  const float angle = std::acos(cosine) * 180.f / M_PIF;
+  const float halfWidth = 0.5f * focus.widthDegrees;
+  const float bump = angle < halfWidth ? 0.5f * (1.f + std::cos(M_PIF * angle / halfWidth)) : 0.f;
+  const float offFocusGain = std::pow(10.f, focus.offFocusLeveldB / 20.f);
+  return offFocusGain + (1.f - offFocusGain) * bump;
+}
+
+/// Implements the parts of SpatDecoderInterface and SpatDecoderExtensions that are common to
+/// SpatDecoderQueue, SpatDecoderFile and AudioObject: transport, volume, focus, position, rotation,
+/// the event callback and the statistics. Derived classes render the audio.
+template <typename Interface, typename Extensions>
+class SpatDecoderBase : public Interface, public Extensions, public MixerSource {
+ public:
+  SpatDecoderBase(EventDispatcher& events, float sampleRate)
+      : events_(events), transport_(sampleRate) {}
+
+  EngineError play() override {
+    return transport_.play();
+  }
+
+  EngineError playScheduled(float millisecondsFromNow) override {
+    return transport_.playScheduled(millisecondsFromNow);
+  }
+
+  EngineError playWithFade(float fadeDurationInMs) override {
+    return transport_.playWithFade(fadeDurationInMs);
+  }
+
+  EngineError pause() override {
+    return transport_.pause();
+  }
+
+  EngineError pauseScheduled(float millisecondsFromNow) override {
+    return transport_.pauseScheduled(millisecondsFromNow);
+  }
+
+  EngineError pauseWithFade(float fadeDurationInMs) override {
+    return transport_.pauseWithFade(fadeDurationInMs);
+  }
+
+  EngineError stop() override {
+    return transport_.stop();
+  }
+
+  EngineError stopScheduled(float millisecondsFromNow) override {
+    return transport_.stopScheduled(millisecondsFromNow);
+  }
+
+  EngineError stopWithFade(float fadeDurationInMs) override {
+    return transport_.stopWithFade(fadeDurationInMs);
+  }
+
+  PlayState getPlayState() const override {
+    return transport_.getPlayState();
+  }
+
+  EngineError setPosition(TBVector position) override {
+    position_.store(position);
+    return EngineError::OK;
+  }
+
+  TBVector getPosition() const override {
+    return position_.load();
+  }
+
+  EngineError setRotation(TBQuat rotation) override {
+    rotation_.store(QuatValue(rotation));
+    return EngineError::OK;
+  }
+
+  EngineError setRotation(TBVector forward, TBVector up) override {
+    return setRotation(TBQuat::getQuatFromForwardAndUpVectors(forward, up));
+  }
+
+  TBQuat getRotation() const override {
+    return rotation_.load().toQuat();
+  }
+
+  void enableFocus(bool enableFocus, bool followListener) override {
+    FocusSettings focus = focus_.load();
+    focus.enabled = enableFocus;
+    focus.followListener = followListener;
+    focus_.store(focus);
+  }
+
+  void setFocusProperties(float offFocusLevel, float focusWidth) override {
+    const float level = std::min(1.f, std::max(0.f, offFocusLevel));
+    setOffFocusLeveldB(-24.f * (1.f - level));
+    setFocusWidthDegrees(focusWidth);
+  }
+
+  void setOffFocusLeveldB(float offFocusLevelDB) override {
+    FocusSettings focus = focus_.load();
+    focus.offFocusLeveldB = std::min(0.f, std::max(-24.f, offFocusLevelDB));
+    focus_.store(focus);
+  }
+
+  void setFocusWidthDegrees(float focusWidthDegrees) override {
+    FocusSettings focus = focus_.load();
+    focus.widthDegrees = std::min(120.f, std::max(40.f, focusWidthDegrees));
+    focus_.store(focus);
+  }
+
+  void setFocusOrientationQuat(TBQuat focusQuat) override {
+    FocusSettings focus = focus_.load();
+    focus.orientation = QuatValue(focusQuat);
+    focus_.store(focus);
+  }
+
+  void setVolume(float linearGain, float rampTimeMs, bool forcePreviousRamp = false) override {
+    transport_.setVolume(linearGain, rampTimeMs, forcePreviousRamp);
+  }
+
+  void setVolumeDecibels(float dB, float rampTimeMs, bool forcePreviousRamp = false) override {
+    transport_.setVolume(std::pow(10.f, dB / 20.f), rampTimeMs, forcePreviousRamp);
+  }
+
+  float getVolume() const override {
+    return transport_.getVolume();
+  }
+
+  float getVolumeDecibels() const override {
+    return 20.f * std::log10(transport_.getVolume());
+  }
+
+  EngineError setEventCallback(EventCallback callback, void* userData) override {
+    EventCallbackInfo info;
+    info.callback = callback;
+    info.userData = userData;
+    callback_.store(info);
+    return EngineError::OK;
+  }
+
+  SourceStatistics getSourceStatistics() const override {
+    return statistics_.load();
+  }
+
+ protected:
+  /// Restore the default state when the object is taken from its pool. Not thread safe.
+  void resetBase() {
+    transport_.reset();
+    callback_.store(EventCallbackInfo());
+    position_.store(TBVector::zero());
+    rotation_.store(QuatValue());
+    focus_.store(FocusSettings());
+    statistics_.store(SourceStatistics());
+    numStarvations_ = 0;
+  }
+
+  /// Audio thread: publish the object's statistics at the end of a block and add it to the
+  /// engine's counters.
+  /// \param active If the object rendered audio this block
+  /// \param backlogged If the object is waiting for the decoder thread to catch up
+  void publishStatistics(
+      const MixContext& context,
+      bool active,
+      size_t numBufferedFrames,
+      size_t bufferSizeFrames,
+      bool backlogged) {
+    SourceStatistics statistics;
+    statistics.numBufferedFrames = static_cast<int32_t>(numBufferedFrames);
+    statistics.bufferSizeFrames = static_cast<int32_t>(bufferSizeFrames);
+    statistics.numStarvations = numStarvations_;
+    statistics.active = active;
+    statistics_.store(statistics);
+
+    if (active) {
+      ++context.statistics->numActiveVoices;
+      if (backlogged) {
+        ++context.statistics->decoderBacklog;
+      }
+    }
+  }
+
+  /// Audio thread: count a starvation and post Event::ERROR_QUEUE_STARVATION.
+  void postStarvation(const MixContext& context) {
+    ++numStarvations_;
+    ++context.statistics->numStarvations;
+    postEvent(Event::ERROR_QUEUE_STARVATION);
+  }
+
+  void postEvent(Event event) {
+    events_.post(event, static_cast<Interface*>(this), callback_);
+  }
+
+  EventDispatcher& events_;
+  Transport transport_;
+  SeqLock<EventCallbackInfo> callback_;
+  SeqLock<TBVector> position_;
+  SeqLock<QuatValue> rotation_;
+  SeqLock<FocusSettings> focus_;
+  SeqLock<SourceStatistics> statistics_;
+  uint32_t numStarvations_{0}; /// Audio thread
+};
+} // namespace TBE
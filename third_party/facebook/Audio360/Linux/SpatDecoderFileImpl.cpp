@@ -0,0 +1,339 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/Linux/SpatDecoderFileImpl.h"
+#include "third_party/facebook/Audio360/Linux/AudioEngineImpl.h"
+#include "third_party/facebook/Audio360/Linux/AudioFormatDecoderFactory.h"
+#include "third_party/facebook/Audio360/Linux/FileStream.h"
+#include "third_party/facebook/Audio360/include/TBE_AssetBank.h"
+
+namespace TBE {
+namespace {
+const size_t kMinStreamingBufferSize = 8192;
+const double kDefaultFreewheelMs = 1000.0;
+const double kDefaultResyncThresholdMs = 200.0;
+} // namespace
+
+SpatDecoderFileImpl::SpatDecoderFileImpl(AudioEngineImpl& engine)
+    : SpatDecoderBase<SpatDecoderFile, SpatDecoderFileExtensions>(
+          engine.getEventDispatcher(),
+          engine.getSampleRate()),
+      engine_(engine),
+      source_(
+          std::max(kMinStreamingBufferSize, static_cast<size_t>(engine.getBufferSize()) * 4),
+          static_cast<size_t>(engine.getBufferSize())),
+      freewheelMs_(kDefaultFreewheelMs),
+      resyncThresholdMs_(kDefaultResyncThresholdMs) {}
+
+SpatDecoderFileImpl::~SpatDecoderFileImpl() {}
+
+void SpatDecoderFileImpl::reset(Options options) {
+  resetBase();
+  options_ = options;
+  map_.store(static_cast<int>(ChannelMap::INVALID));
+  syncMode_.store(static_cast<int>(SyncMode::INTERNAL));
+  externalClock_.store(ExternalClock());
+  freewheelMs_.store(kDefaultFreewheelMs);
+  resyncThresholdMs_.store(kDefaultResyncThresholdMs);
+  renderer_.reset();
+  framesSinceSync_ = 0;
+  starving_ = false;
+}
+
+void SpatDecoderFileImpl::release() {
+  source_.detach();
+}
+
+EngineError SpatDecoderFileImpl::open(const char* nameAndPath, ChannelMap map) {
+  return open(nameAndPath, AssetDescriptor(), map);
+}
+
+EngineError
+SpatDecoderFileImpl::open(IOStream* streams[2], bool shouldOwnStreams, ChannelMap map) {
+  if (streams == nullptr || streams[0] == nullptr) {
+    return EngineError::FAIL;
+  }
+  // A single stream is enough as the host backend never decodes two positions at once
+  if (shouldOwnStreams && streams[1] != streams[0]) {
+    delete streams[1];
+  }
+  return openStream(streams[0], shouldOwnStreams, AssetCodec::WAV, map);
+}
+
+EngineError
+SpatDecoderFileImpl::open(const char* nameAndPath, AssetDescriptor ad, ChannelMap map) {
+  if (nameAndPath == nullptr) {
+    return EngineError::ERROR_OPENING_FILE;
+  }
+
+  FileStream* stream = new FileStream();
+  const EngineError error = stream->open(nameAndPath, ad);
+  if (error != EngineError::OK) {
+    delete stream;
+    return error;
+  }
+  return openStream(stream, true, getAssetCodec(nameAndPath), map);
+}
+
+EngineError SpatDecoderFileImpl::open(AssetBank* bank, const char* assetName, ChannelMap map) {
+  if (bank == nullptr) {
+    return EngineError::NO_ASSET;
+  }
+  if (!FieldRenderer::isSupported(map)) {
+    return EngineError::NOT_SUPPORTED;
+  }
+
+  // The index gives the channel count, so mismatched assets are rejected before decoding
+  AssetBankEntry entry;
+  EngineError error = bank->findAsset(assetName, entry);
+  if (error != EngineError::OK) {
+    return error;
+  }
+  if (entry.numChannels != 0 && entry.numChannels != getNumChannelsForMap(map) &&
+      !(map == ChannelMap::STEREO && entry.numChannels == 2)) {
+    return EngineError::INVALID_CHANNEL_COUNT;
+  }
+
+  AudioFormatDecoder* decoder = nullptr;
+  error = bank->createDecoder(
+      decoder, assetName, engine_.getBufferSize(), engine_.getSampleRate());
+  if (error != EngineError::OK) {
+    return error;
+  }
+  return openDecoder(decoder, map);
+}
+
+EngineError SpatDecoderFileImpl::openStream(
+    IOStream* stream,
+    bool shouldOwnStream,
+    AssetCodec codec,
+    ChannelMap map) {
+  if (!FieldRenderer::isSupported(map)) {
+    if (shouldOwnStream) {
+      delete stream;
+    }
+    return EngineError::NOT_SUPPORTED;
+  }
+
+  AudioFormatDecoder* decoder = nullptr;
+  const EngineError error = createAudioFormatDecoder(
+      decoder,
+      stream,
+      shouldOwnStream,
+      codec,
+      engine_.getBufferSize(),
+      engine_.getSampleRate());
+  if (error != EngineError::OK) {
+    return error;
+  }
+  return openDecoder(decoder, map);
+}
+
+EngineError SpatDecoderFileImpl::openDecoder(AudioFormatDecoder* decoder, ChannelMap map) {
+  if (decoder->getNumOfChannels() != getNumChannelsForMap(map) &&
+      !(map == ChannelMap::STEREO && decoder->getNumOfChannels() == 2)) {
+    delete decoder;
+    return EngineError::INVALID_CHANNEL_COUNT;
+  }
+
+  {
+    auto lock = engine_.lockRender();
+    source_.attach(decoder);
+    map_.store(static_cast<int>(map));
+    renderer_.reset();
+    framesSinceSync_ = 0;
+    starving_ = false;
+  }
+  engine_.wakeDecoderThread();
+  return EngineError::OK;
+}
+
+void SpatDecoderFileImpl::close() {
+  auto lock = engine_.lockRender();
+  source_.detach();
+  map_.store(static_cast<int>(ChannelMap::INVALID));
+}
+
+bool SpatDecoderFileImpl::isOpen() const {
+  return source_.isOpen();
+}
+
+EngineError SpatDecoderFileImpl::seekToSample(size_t timeInSamples) {
+  const EngineError error = source_.seekToSample(timeInSamples);
+  if (error == EngineError::OK) {
+    engine_.wakeDecoderThread();
+  }
+  return error;
+}
+
+EngineError SpatDecoderFileImpl::seekToMs(float timeInMs) {
+  if (timeInMs < 0.f) {
+    return EngineError::FAIL;
+  }
+  return seekToSample(static_cast<size_t>(timeInMs * engine_.getSampleRate() / 1000.f));
+}
+
+size_t SpatDecoderFileImpl::getElapsedTimeInSamples() const {
+  return source_.getElapsedSamples();
+}
+
+double SpatDecoderFileImpl::getElapsedTimeInMs() const {
+  return static_cast<double>(source_.getElapsedSamples()) * 1000.0 / engine_.getSampleRate();
+}
+
+size_t SpatDecoderFileImpl::getAssetDurationInSamples() const {
+  return source_.getDurationSamples();
+}
+
+float SpatDecoderFileImpl::getAssetDurationInMs() const {
+  return static_cast<float>(source_.getDurationSamples()) * 1000.f / engine_.getSampleRate();
+}
+
+void SpatDecoderFileImpl::setSyncMode(SyncMode syncMode) {
+  syncMode_.store(static_cast<int>(syncMode));
+}
+
+SyncMode SpatDecoderFileImpl::getSyncMode() const {
+  return static_cast<SyncMode>(syncMode_.load());
+}
+
+void SpatDecoderFileImpl::setExternalClockInMs(double externalClockInMs) {
+  ExternalClock clock;
+  clock.timeMs = externalClockInMs;
+  clock.dspTime = engine_.getDSPTime();
+  externalClock_.store(clock);
+}
+
+void SpatDecoderFileImpl::setFreewheelTimeInMs(double freewheelInMs) {
+  freewheelMs_.store(std::max(0.0, freewheelInMs));
+}
+
+double SpatDecoderFileImpl::getFreewheelTimeInMs() {
+  return freewheelMs_.load();
+}
+
+void SpatDecoderFileImpl::setResyncThresholdMs(double resyncThresholdMs) {
+  resyncThresholdMs_.store(std::max(0.0, resyncThresholdMs));
+}
+
+double SpatDecoderFileImpl::getResyncThresholdMs() const {
+  return resyncThresholdMs_.load();
+}
+
+void SpatDecoderFileImpl::applyVolumeFade(
+    float startLinearGain,
+    float endLinearGain,
+    float fadeDurationMs) {
+  transport_.setVolume(startLinearGain, 0.f, true);
+  transport_.setVolume(endLinearGain, std::max(0.f, fadeDurationMs), false);
+}
+
+void SpatDecoderFileImpl::enableLooping(bool shouldLoop) {
+  source_.enableLooping(shouldLoop);
+}
+
+bool SpatDecoderFileImpl::loopingEnabled() const {
+  return source_.loopingEnabled();
+}
+
+void SpatDecoderFileImpl::render(const MixContext& context, float* mix) {
+  bool stopped = false;
+  const bool active = transport_.process(context.numFrames, context.gains, stopped);
+  if (stopped) {
+    renderer_.reset();
+    starving_ = false;
+    if (source_.isOpen()) {
+      source_.seekToSample(0);
+    }
+  }
+  if (!active) {
+    publishSourceStatistics(context, false);
+    return;
+  }
+
+  const int32_t numChannels = source_.getNumChannels();
+  if (numChannels == 0) {
+    publishSourceStatistics(context, false);
+    return;
+  }
+
+  const size_t numFrames = context.numFrames;
+  float* input = context.scratch;
+  int32_t numLoops = 0;
+  const size_t numRead = source_.read(input, numFrames, numLoops);
+  std::fill(input + numRead * numChannels, input + numFrames * numChannels, 0.f);
+
+  for (; numLoops > 0; --numLoops) {
+    postEvent(Event::LOOPED);
+  }
+
+  if (numRead < numFrames) {
+    if (source_.finished()) {
+      postEvent(Event::END_OF_STREAM);
+      transport_.finish();
+      source_.seekToSample(0);
+    } else if (source_.ready() && !starving_) {
+      starving_ = true;
+      postStarvation(context);
+    }
+  } else {
+    starving_ = false;
+  }
+
+  const ChannelMap map = static_cast<ChannelMap>(map_.load());
+  renderer_.render(context, rotation_.load().toQuat(), map, input, context.gains, mix);
+
+  if (getSyncMode() == SyncMode::EXTERNAL) {
+    synchronise(context);
+  }
+  publishSourceStatistics(context, true);
+}
+
+void SpatDecoderFileImpl::publishSourceStatistics(const MixContext& context, bool active) {
+  publishStatistics(
+      context,
+      active,
+      source_.getNumBufferedFrames(),
+      source_.isOpen() ? source_.getBufferSizeFrames() : 0,
+      !decodesInAudioCallback() && source_.isBacklogged());
+}
+
+void SpatDecoderFileImpl::synchronise(const MixContext& context) {
+  framesSinceSync_ += context.numFrames;
+  const double freewheelFrames = freewheelMs_.load() * context.sampleRate / 1000.0;
+  if (static_cast<double>(framesSinceSync_) < freewheelFrames || !source_.ready()) {
+    return;
+  }
+  framesSinceSync_ = 0;
+
+  const ExternalClock clock = externalClock_.load();
+  const double externalMs = clock.timeMs +
+      static_cast<double>(context.dspTime - clock.dspTime) * 1000.0 / context.sampleRate;
+  const double elapsedMs =
+      static_cast<double>(source_.getElapsedSamples()) * 1000.0 / context.sampleRate;
+  if (std::abs(externalMs - elapsedMs) > resyncThresholdMs_.load()) {
+    const double target = std::max(0.0, externalMs) * context.sampleRate / 1000.0;
+    source_.seekToSample(static_cast<size_t>(target));
+  }
+}
+
+void SpatDecoderFileImpl::runDecoderJob() {
+  if (source_.decode()) {
+    postEvent(Event::DECODER_INIT);
+  }
+}
+
+bool SpatDecoderFileImpl::decodesInAudioCallback() const {
+  return (options_ & Options::DECODE_IN_AUDIO_CALLBACK) != 0 || !engine_.usesDecoderThread();
+}
+} // namespace TBE
+
+extern "C" {
+
+TBE::SpatDecoderFileExtensions* TBE_GetSpatDecoderFileExtensions(
+    TBE::SpatDecoderFile* spatDecoder) {
+  // Every SpatDecoderFile is created by the engine from its pool
+  return spatDecoder != nullptr ? static_cast<TBE::SpatDecoderFileImpl*>(spatDecoder) : nullptr;
+}
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include "third_party/facebook/Audio360/Linux/FieldRenderer.h"
+#include "third_party/facebook/Audio360/Linux/SpatDecoderBase.h"
+#include "third_party/facebook/Audio360/Linux/StreamingSource.h"
+#include "third_party/facebook/Audio360/include/TBE_AudioEngineExtensions.h"
+
+#include <atomic>
+
+namespace TBE {
+class AudioEngineImpl;
+
+/// Streams and renders a spatial audio file. Supports the channel maps of FieldRenderer.
+class SpatDecoderFileImpl
+    : public SpatDecoderBase<SpatDecoderFile, SpatDecoderFileExtensions> {
+ public:
+  explicit SpatDecoderFileImpl(AudioEngineImpl& engine);
+  ~SpatDecoderFileImpl() override;
+
+  /// Restore the default state when the object is taken from the pool. Not thread safe.
+  void reset(Options options);
+
+  /// Release the asset when the object is returned to the pool. Not thread safe.
+  void release();
+
+  EngineError open(const char* nameAndPath, ChannelMap map) override;
+  EngineError open(IOStream* streams[2], bool shouldOwnStreams, ChannelMap map) override;
+  EngineError open(const char* nameAndPath, AssetDescriptor ad, ChannelMap map) override;
+  void close() override;
+  bool isOpen() const override;
+  EngineError seekToSample(size_t timeInSamples) override;
+  EngineError seekToMs(float timeInMs) override;
+  size_t getElapsedTimeInSamples() const override;
+  double getElapsedTimeInMs() const override;
+  size_t getAssetDurationInSamples() const override;
+  float getAssetDurationInMs() const override;
+  void setSyncMode(SyncMode syncMode) override;
+  SyncMode getSyncMode() const override;
+  void setExternalClockInMs(double externalClockInMs) override;
+  void setFreewheelTimeInMs(double freewheelInMs) override;
+  double getFreewheelTimeInMs() override;
+  void setResyncThresholdMs(double resyncThresholdMs) override;
+  double getResyncThresholdMs() const override;
+  void applyVolumeFade(float startLinearGain, float endLinearGain, float fadeDurationMs) override;
+  void enableLooping(bool shouldLoop) override;
+  bool loopingEnabled() const override;
+
+  // SpatDecoderFileExtensions
+  EngineError open(AssetBank* bank, const char* assetName, ChannelMap map) override;
+
+  void render(const MixContext& context, float* mix) override;
+  void runDecoderJob() override;
+  bool decodesInAudioCallback() const override;
+
+ private:
+  /// External clock and the DSP time at which it was set, so it can be extrapolated.
+  struct ExternalClock {
+    double timeMs{0.0};
+    int64_t dspTime{0};
+  };
+
+  /// Open a stream containing an encoded asset.
+  EngineError
+  openStream(IOStream* stream, bool shouldOwnStream, AssetCodec codec, ChannelMap map);
+  /// Play from a decoder. Takes ownership of the decoder.
+  EngineError openDecoder(AudioFormatDecoder* decoder, ChannelMap map);
+
+  /// Audio thread: seek to the external clock if playback has drifted past the threshold.
+  void synchronise(const MixContext& context);
+
+  /// Audio thread: publish the buffer level of the stream after a block.
+  void publishSourceStatistics(const MixContext& context, bool active);
+
+  AudioEngineImpl& engine_;
+  StreamingSource source_;
+  Options options_{Options::DEFAULT};
+  std::atomic<int> map_{static_cast<int>(ChannelMap::INVALID)};
+  std::atomic<int> syncMode_{static_cast<int>(SyncMode::INTERNAL)};
+  SeqLock<ExternalClock> externalClock_;
+  std::atomic<double> freewheelMs_;
+  std::atomic<double> resyncThresholdMs_;
+
+  // Audio thread state
+  FieldRenderer renderer_;
+  size_t framesSinceSync_{0};
+  bool starving_{false};
+};
+} // namespace TBE
@@ -0,0 +1,326 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/Linux/SpatDecoderQueueImpl.h"
+
+namespace TBE {
+SpatDecoderQueueImpl::SpatDecoderQueueImpl(
+    EventDispatcher& events,
+    float sampleRate,
+    size_t queueSizePerChannel)
+    : SpatDecoderBase<SpatDecoderQueue, SpatDecoderQueueExtensions>(events, sampleRate) {
+  queues_[AMBIX_4_QUEUE].numChannels = 4;
+  queues_[AMBIX_9_QUEUE].numChannels = 9;
+  queues_[HEADLOCKED_QUEUE].numChannels = 2;
+  for (Queue& queue : queues_) {
+    // The ring keeps one element free, so pad it to a whole number of frames. Writes and reads
+    // are whole frames, so frames are never split by the end of the ring and acquireWrite() can
+    // hand out interleaved regions.
+    const size_t stride = static_cast<size_t>(queue.numChannels);
+    queue.buffer.resize(queueSizePerChannel * stride + stride - 1);
+  }
+}
+
+SpatDecoderQueueImpl::~SpatDecoderQueueImpl() {}
+
+void SpatDecoderQueueImpl::reset() {
+  resetBase();
+  for (Queue& queue : queues_) {
+    queue.buffer.reset();
+    queue.numWritten.store(0);
+    queue.flushTarget.store(0);
+    queue.numRead = 0;
+  }
+  endOfStream_.store(false);
+  numDequeued_.store(0);
+  pending_ = PendingWrite();
+  ambix4Renderer_.reset();
+  ambix9Renderer_.reset();
+  starving_ = false;
+}
+
+int32_t SpatDecoderQueueImpl::getQueues(ChannelMap channelMap, QueueIndex* queues) {
+  switch (channelMap) {
+    case ChannelMap::AMBIX_4:
+      queues[0] = AMBIX_4_QUEUE;
+      return 1;
+    case ChannelMap::AMBIX_9:
+      queues[0] = AMBIX_9_QUEUE;
+      return 1;
+    case ChannelMap::AMBIX_9_2:
+      queues[0] = AMBIX_9_QUEUE;
+      queues[1] = HEADLOCKED_QUEUE;
+      return 2;
+    case ChannelMap::HEADLOCKED_STEREO:
+      // STEREO is not accepted: getNumChannelsForMap() gives it no channel count, so the
+      // interleaved enqueues could not take it either
+      queues[0] = HEADLOCKED_QUEUE;
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+int32_t SpatDecoderQueueImpl::getFreeSpaceInQueue(ChannelMap channelMap) const {
+  QueueIndex indices[2];
+  const int32_t numQueues = getQueues(channelMap, indices);
+  if (numQueues == 0) {
+    return 0;
+  }
+  size_t numFrames = SIZE_MAX;
+  for (int32_t k = 0; k < numQueues; ++k) {
+    const Queue& queue = queues_[indices[k]];
+    numFrames = std::min(numFrames, queue.buffer.getNumWritable() / queue.numChannels);
+  }
+  return static_cast<int32_t>(numFrames) * getNumChannelsForMap(channelMap);
+}
+
+int32_t SpatDecoderQueueImpl::getQueueSize(ChannelMap channelMap) const {
+  QueueIndex indices[2];
+  if (getQueues(channelMap, indices) == 0) {
+    return 0;
+  }
+  const Queue& queue = queues_[indices[0]];
+  return static_cast<int32_t>(queue.buffer.capacity() / queue.numChannels) *
+      getNumChannelsForMap(channelMap);
+}
+
+template <typename Convert>
+int32_t SpatDecoderQueueImpl::enqueue(int32_t numFrames, ChannelMap map, Convert convert) {
+  QueueWriteRegion regions[2];
+  const size_t numAcquired = static_cast<size_t>(acquireWrite(map, numFrames, regions, 2));
+  size_t channelOffset = 0;
+  for (int32_t k = 0; k < pending_.numQueues; ++k) {
+    fillRegion(regions[k], numAcquired, [&](size_t frame, size_t channel) {
+      return convert(frame, channelOffset + channel);
+    });
+    channelOffset += static_cast<size_t>(regions[k].numChannels);
+  }
+  return commitWrite(static_cast<int32_t>(numAcquired), SampleFormat::FLOAT);
+}
+
+int32_t SpatDecoderQueueImpl::enqueueData(
+    const float* interleavedBuffer,
+    int32_t numTotalSamples,
+    ChannelMap channelMap) {
+  const int32_t numChannels = getNumChannelsForMap(channelMap);
+  if (interleavedBuffer == nullptr || numChannels <= 0 || numTotalSamples % numChannels != 0) {
+    return 0;
+  }
+  const size_t stride = static_cast<size_t>(numChannels);
+  return numChannels *
+      enqueue(numTotalSamples / numChannels, channelMap, [=](size_t frame, size_t channel) {
+           return interleavedBuffer[frame * stride + channel];
+         });
+}
+
+int32_t SpatDecoderQueueImpl::enqueueData(
+    const int16_t* interleavedBuffer,
+    int32_t numTotalSamples,
+    ChannelMap channelMap) {
+  const int32_t numChannels = getNumChannelsForMap(channelMap);
+  if (interleavedBuffer == nullptr || numChannels <= 0 || numTotalSamples % numChannels != 0) {
+    return 0;
+  }
+  const size_t stride = static_cast<size_t>(numChannels);
+  return numChannels *
+      enqueue(numTotalSamples / numChannels, channelMap, [=](size_t frame, size_t channel) {
+           return static_cast<float>(interleavedBuffer[frame * stride + channel]) / 32768.f;
+         });
+}
+
+int32_t SpatDecoderQueueImpl::enqueueSilence(int32_t numTotalSamples, ChannelMap channelMap) {
+  const int32_t numChannels = getNumChannelsForMap(channelMap);
+  if (numChannels <= 0 || numTotalSamples % numChannels != 0) {
+    return 0;
+  }
+  return numChannels *
+      enqueue(numTotalSamples / numChannels, channelMap, [](size_t, size_t) { return 0.f; });
+}
+
+int32_t SpatDecoderQueueImpl::enqueuePlanarData(
+    const float* const* channelBuffers,
+    int32_t numSamplesPerChannel,
+    ChannelMap channelMap) {
+  const int32_t numChannels = getNumChannelsForMap(channelMap);
+  if (numChannels <= 0 || !areBuffersValid(channelBuffers, static_cast<size_t>(numChannels))) {
+    return 0;
+  }
+  return enqueue(numSamplesPerChannel, channelMap, [=](size_t frame, size_t channel) {
+    return channelBuffers[channel][frame];
+  });
+}
+
+int32_t SpatDecoderQueueImpl::enqueuePlanarData(
+    const int16_t* const* channelBuffers,
+    int32_t numSamplesPerChannel,
+    ChannelMap channelMap) {
+  const int32_t numChannels = getNumChannelsForMap(channelMap);
+  if (numChannels <= 0 || !areBuffersValid(channelBuffers, static_cast<size_t>(numChannels))) {
+    return 0;
+  }
+  return enqueue(numSamplesPerChannel, channelMap, [=](size_t frame, size_t channel) {
+    return static_cast<float>(channelBuffers[channel][frame]) / 32768.f;
+  });
+}
+
+int32_t SpatDecoderQueueImpl::acquireWrite(
+    ChannelMap channelMap,
+    int32_t numSamplesPerChannel,
+    QueueWriteRegion* regions,
+    int32_t numRegions) {
+  pending_ = PendingWrite();
+  const int32_t numQueues = getQueues(channelMap, pending_.queues);
+  if (regions == nullptr || numQueues == 0 || numQueues > numRegions ||
+      numSamplesPerChannel <= 0) {
+    return 0;
+  }
+
+  size_t numFrames = static_cast<size_t>(numSamplesPerChannel);
+  for (int32_t k = 0; k < numQueues; ++k) {
+    const Queue& queue = queues_[pending_.queues[k]];
+    numFrames = std::min(numFrames, queue.buffer.getNumWritable() / queue.numChannels);
+  }
+  for (int32_t k = 0; k < numQueues; ++k) {
+    Queue& queue = queues_[pending_.queues[k]];
+    acquireRegion(queue.buffer, queue.numChannels, numFrames, pending_.regions[k]);
+    regions[k] = pending_.regions[k];
+  }
+  pending_.numQueues = numQueues;
+  pending_.numFrames = numFrames;
+  return static_cast<int32_t>(numFrames);
+}
+
+int32_t SpatDecoderQueueImpl::commitWrite(int32_t numSamplesPerChannel, SampleFormat format) {
+  const PendingWrite pending = pending_;
+  pending_ = PendingWrite();
+  if (numSamplesPerChannel <= 0 || static_cast<size_t>(numSamplesPerChannel) > pending.numFrames) {
+    return 0;
+  }
+
+  const size_t numFrames = static_cast<size_t>(numSamplesPerChannel);
+  for (int32_t k = 0; k < pending.numQueues; ++k) {
+    Queue& queue = queues_[pending.queues[k]];
+    if (format == SampleFormat::INT16) {
+      convertRegionFromInt16(pending.regions[k], numFrames);
+    }
+    queue.buffer.commitWrite(numFrames * queue.numChannels);
+    queue.numWritten.fetch_add(numFrames);
+  }
+  return numSamplesPerChannel;
+}
+
+void SpatDecoderQueueImpl::flushQueue() {
+  // The audio thread owns the read side of the queues, so it discards the data on the next block
+  for (Queue& queue : queues_) {
+    queue.flushTarget.store(queue.numWritten.load());
+  }
+  endOfStream_.store(false);
+}
+
+uint64_t SpatDecoderQueueImpl::getNumSamplesDequeuedPerChannel() const {
+  return numDequeued_.load();
+}
+
+void SpatDecoderQueueImpl::setEndOfStream(bool endOfStream) {
+  endOfStream_.store(endOfStream);
+}
+
+bool SpatDecoderQueueImpl::getEndOfStreamStatus() const {
+  return endOfStream_.load();
+}
+
+size_t SpatDecoderQueueImpl::dequeue(Queue& queue, size_t numFrames, bool endOfStream, float* out) {
+  const size_t stride = static_cast<size_t>(queue.numChannels);
+  const size_t numReadable = queue.buffer.getNumReadable() / stride;
+  if (numReadable == 0 || (numReadable < numFrames && !endOfStream)) {
+    return 0;
+  }
+
+  const size_t numRead = queue.buffer.read(out, std::min(numReadable, numFrames) * stride) / stride;
+  std::fill(out + numRead * stride, out + numFrames * stride, 0.f);
+  queue.numRead += numRead;
+  return numRead;
+}
+
+void SpatDecoderQueueImpl::render(const MixContext& context, float* mix) {
+  for (Queue& queue : queues_) {
+    const uint64_t flushTarget = queue.flushTarget.load();
+    if (queue.numRead < flushTarget) {
+      const size_t stride = static_cast<size_t>(queue.numChannels);
+      queue.numRead += queue.buffer.discard((flushTarget - queue.numRead) * stride) / stride;
+    }
+  }
+
+  bool stopped = false;
+  if (!transport_.process(context.numFrames, context.gains, stopped)) {
+    publishSourceStatistics(context, false);
+    return;
+  }
+
+  const size_t numFrames = context.numFrames;
+  const bool endOfStream = endOfStream_.load();
+  const TBQuat rotation = rotation_.load().toQuat();
+  float* input = context.scratch;
+  size_t numDequeued = 0;
+  bool haveData = false;
+
+  for (int32_t index = 0; index < NUM_QUEUES; ++index) {
+    Queue& queue = queues_[index];
+    haveData = haveData || queue.numWritten.load() > queue.numRead;
+    const size_t numRead = dequeue(queue, numFrames, endOfStream, input);
+    if (numRead == 0) {
+      continue;
+    }
+    numDequeued = std::max(numDequeued, numRead);
+    if (index == AMBIX_4_QUEUE) {
+      ambix4Renderer_.renderAmbisonic(context, rotation, input, 4, context.gains, mix);
+    } else if (index == AMBIX_9_QUEUE) {
+      ambix9Renderer_.renderAmbisonic(context, rotation, input, 9, context.gains, mix);
+    } else {
+      FieldRenderer::renderHeadLocked(numFrames, input, 2, 0, 2, 0, context.gains, mix);
+    }
+  }
+  numDequeued_.fetch_add(numDequeued);
+
+  // Starvation is reported once when the client stops keeping up, not on every block
+  const bool starving = numDequeued < numFrames && !endOfStream && (haveData || numDequeued > 0);
+  if (starving && !starving_) {
+    postStarvation(context);
+  }
+  starving_ = starving;
+  publishSourceStatistics(context, numDequeued > 0);
+}
+
+void SpatDecoderQueueImpl::publishSourceStatistics(const MixContext& context, bool active) {
+  // Report the emptiest of the queues the client is filling
+  const Queue* emptiest = nullptr;
+  size_t numBuffered = 0;
+  for (const Queue& queue : queues_) {
+    if (queue.numWritten.load() == 0) {
+      continue;
+    }
+    const size_t numReadable =
+        queue.buffer.getNumReadable() / static_cast<size_t>(queue.numChannels);
+    if (emptiest == nullptr || numReadable < numBuffered) {
+      emptiest = &queue;
+      numBuffered = numReadable;
+    }
+  }
+  const Queue& queue = emptiest ? *emptiest : queues_[AMBIX_4_QUEUE];
+  const size_t bufferSize = queue.buffer.capacity() / static_cast<size_t>(queue.numChannels);
+
+  // The client fills the queues, not the decoder thread
+  publishStatistics(context, active, numBuffered, bufferSize, false);
+}
+} // namespace TBE
+
+extern "C" {
+
+TBE::SpatDecoderQueueExtensions* TBE_GetSpatDecoderQueueExtensions(
+    TBE::SpatDecoderQueue* spatDecoder) {
+  // Every SpatDecoderQueue is created by the engine from its pool
+  return spatDecoder != nullptr ? static_cast<TBE::SpatDecoderQueueImpl*>(spatDecoder) : nullptr;
+}
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include "third_party/facebook/Audio360/Linux/FieldRenderer.h"
+#include "third_party/facebook/Audio360/Linux/QueueWriteRegion.h"
+#include "third_party/facebook/Audio360/Linux/RingBuffer.h"
+#include "third_party/facebook/Audio360/Linux/SpatDecoderBase.h"
+
+#include <atomic>
+
+namespace TBE {
+/// Renders spatial audio that is pushed by the client. Each kind of data has its own lock-free
+/// queue: first order ambiX (AMBIX_4), second order ambiX (AMBIX_9) and head-locked stereo
+/// (HEADLOCKED_STEREO). AMBIX_9_2 is split between the AMBIX_9 and head-locked queues.
+/// Thread safe for one producer and the audio thread.
+class SpatDecoderQueueImpl
+    : public SpatDecoderBase<SpatDecoderQueue, SpatDecoderQueueExtensions> {
+ public:
+  /// \param queueSizePerChannel Size of each queue in samples per channel
+  SpatDecoderQueueImpl(EventDispatcher& events, float sampleRate, size_t queueSizePerChannel);
+  ~SpatDecoderQueueImpl() override;
+
+  /// Restore the default state when the object is taken from the pool. Not thread safe.
+  void reset();
+
+  int32_t getFreeSpaceInQueue(ChannelMap channelMap) const override;
+  int32_t getQueueSize(ChannelMap channelMap) const override;
+  int32_t enqueueData(
+      const float* interleavedBuffer,
+      int32_t numTotalSamples,
+      ChannelMap channelMap) override;
+  int32_t enqueueData(
+      const int16_t* interleavedBuffer,
+      int32_t numTotalSamples,
+      ChannelMap channelMap) override;
+  int32_t enqueueSilence(int32_t numTotalSamples, ChannelMap channelMap) override;
+  void flushQueue() override;
+  uint64_t getNumSamplesDequeuedPerChannel() const override;
+  void setEndOfStream(bool endOfStream) override;
+  bool getEndOfStreamStatus() const override;
+
+  // SpatDecoderQueueExtensions
+  int32_t enqueuePlanarData(
+      const float* const* channelBuffers,
+      int32_t numSamplesPerChannel,
+      ChannelMap channelMap) override;
+  int32_t enqueuePlanarData(
+      const int16_t* const* channelBuffers,
+      int32_t numSamplesPerChannel,
+      ChannelMap channelMap) override;
+  int32_t acquireWrite(
+      ChannelMap channelMap,
+      int32_t numSamplesPerChannel,
+      QueueWriteRegion* regions,
+      int32_t numRegions) override;
+  int32_t commitWrite(int32_t numSamplesPerChannel, SampleFormat format) override;
+
+  void render(const MixContext& context, float* mix) override;
+
+ private:
+  enum QueueIndex { AMBIX_4_QUEUE, AMBIX_9_QUEUE, HEADLOCKED_QUEUE, NUM_QUEUES };
+
+  struct Queue {
+    int32_t numChannels{0};
+    RingBuffer<float> buffer; /// Sized so that frames never wrap around its end
+    std::atomic<uint64_t> numWritten{0}; /// Frames written since the object was reset
+    std::atomic<uint64_t> flushTarget{0}; /// Frames the consumer must discard up to
+    uint64_t numRead{0}; /// Audio thread: frames read or discarded since the object was reset
+  };
+
+  /// Find the queues for a channel map.
+  /// \return The number of queues, 0 if the channel map is not supported
+  static int32_t getQueues(ChannelMap channelMap, QueueIndex* queues);
+
+  /// Space handed out by acquireWrite() and not committed yet
+  struct PendingWrite {
+    QueueIndex queues[2];
+    QueueWriteRegion regions[2];
+    int32_t numQueues{0};
+    size_t numFrames{0};
+  };
+
+  /// Producer: enqueue frames straight into the queues. convert(frame, channel) returns each
+  /// sample, with the channels numbered as in the channel map.
+  /// \return Number of frames queued
+  template <typename Convert>
+  int32_t enqueue(int32_t numFrames, ChannelMap map, Convert convert);
+
+  /// Audio thread: read one block from a queue into the scratch buffer.
+  /// \return Number of frames read
+  size_t dequeue(Queue& queue, size_t numFrames, bool endOfStream, float* out);
+
+  /// Audio thread: publish the buffer level of the queues after a block.
+  void publishSourceStatistics(const MixContext& context, bool active);
+
+  Queue queues_[NUM_QUEUES];
+  std::atomic<bool> endOfStream_{false};
+  std::atomic<uint64_t> numDequeued_{0};
+
+  // Producer state
+  PendingWrite pending_;
+
+  // Audio thread state
+  FieldRenderer ambix4Renderer_;
+  FieldRenderer ambix9Renderer_;
+  bool starving_{false};
+};
+} // namespace TBE
@@ -0,0 +1,447 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/Linux/SpeakersVirtualizerImpl.h"
+#include "third_party/facebook/Audio360/Linux/AudioEngineImpl.h"
+#include "third_party/facebook/Audio360/Linux/AudioObjectImpl.h"
+
+namespace TBE {
+namespace {
+/// Azimuth of each speaker in degrees, positive to the right (ITU-R BS.775 layout).
+float getSpeakerAzimuth(SpeakerPosition position) {
+  switch (position) {
+    case SpeakerPosition::LEFT:
+      return -30.f;
+    case SpeakerPosition::RIGHT:
+      return 30.f;
+    case SpeakerPosition::LEFT_SURROUND:
+      return -110.f;
+    case SpeakerPosition::RIGHT_SURROUND:
+      return 110.f;
+    case SpeakerPosition::LEFT_BACK_SURROUND:
+      return -150.f;
+    case SpeakerPosition::RIGHT_BACK_SURROUND:
+      return 150.f;
+    default:
+      return 0.f;
+  }
+}
+} // namespace
+
+SpeakersVirtualizerImpl::SpeakersVirtualizerImpl(AudioEngineImpl& engine) : engine_(engine) {}
+
+SpeakersVirtualizerImpl::~SpeakersVirtualizerImpl() {}
+
+EngineError SpeakersVirtualizerImpl::create(
+    SpeakerPosition const* layout,
+    size_t channelBufferSizeInSamples) {
+  release();
+  if (layout == nullptr || layout[0] == SpeakerPosition::END_ENUM) {
+    return EngineError::FAIL;
+  }
+
+  callback_.store(EventCallbackInfo());
+  endOfStream_.store(false);
+  numWritten_.store(0);
+  flushTarget_.store(0);
+  numDequeued_.store(0);
+  haveProducerThread_ = false;
+  numAcquired_ = 0;
+  blockTime_ = -1;
+  blockFrames_ = 0;
+  numRead_ = 0;
+  starving_ = false;
+
+  for (size_t i = 0; layout[i] != SpeakerPosition::END_ENUM; ++i) {
+    AudioObjectImpl* object = engine_.acquireAudioObject(Options::DEFAULT);
+    if (object == nullptr) {
+      release();
+      return EngineError::NO_OBJECTS_IN_POOL;
+    }
+
+    std::unique_ptr<Speaker> speaker(new Speaker());
+    speaker->owner = this;
+    speaker->object = object;
+    speaker->queue.resize(channelBufferSizeInSamples);
+
+    object->setListenerRelative(true);
+    object->setAttenuationMode(AttenuationMode::DISABLE);
+    if (layout[i] == SpeakerPosition::LFE) {
+      object->shouldSpatialise(false);
+    } else {
+      object->setPosition(TBVector::getVectorFromAziEle(getSpeakerAzimuth(layout[i]), 0.f));
+    }
+    object->setAudioBufferCallback(&SpeakersVirtualizerImpl::readSpeaker, 1, speaker.get());
+    speakers_.push_back(std::move(speaker));
+  }
+
+  regions_.resize(speakers_.size());
+  return EngineError::OK;
+}
+
+void SpeakersVirtualizerImpl::release() {
+  for (auto& speaker : speakers_) {
+    engine_.releaseAudioObject(speaker->object);
+  }
+  speakers_.clear();
+}
+
+template <typename Command>
+EngineError SpeakersVirtualizerImpl::forEachSpeaker(Command command) {
+  if (speakers_.empty()) {
+    return EngineError::FAIL;
+  }
+
+  // Hold the render lock so that all the speakers apply the command in the same block
+  auto lock = engine_.lockRender();
+  EngineError result = EngineError::OK;
+  for (auto& speaker : speakers_) {
+    const EngineError error = command(*speaker->object);
+    result = result == EngineError::OK ? error : result;
+  }
+  return result;
+}
+
+EngineError SpeakersVirtualizerImpl::play() {
+  return forEachSpeaker([](AudioObjectImpl& object) { return object.play(); });
+}
+
+EngineError SpeakersVirtualizerImpl::playScheduled(float millisecondsFromNow) {
+  return forEachSpeaker(
+      [=](AudioObjectImpl& object) { return object.playScheduled(millisecondsFromNow); });
+}
+
+EngineError SpeakersVirtualizerImpl::playWithFade(float fadeDurationInMs) {
+  return forEachSpeaker(
+      [=](AudioObjectImpl& object) { return object.playWithFade(fadeDurationInMs); });
+}
+
+EngineError SpeakersVirtualizerImpl::pause() {
+  return forEachSpeaker([](AudioObjectImpl& object) { return object.pause(); });
+}
+
+EngineError SpeakersVirtualizerImpl::pauseScheduled(float millisecondsFromNow) {
+  return forEachSpeaker(
+      [=](AudioObjectImpl& object) { return object.pauseScheduled(millisecondsFromNow); });
+}
+
+EngineError SpeakersVirtualizerImpl::pauseWithFade(float fadeDurationInMs) {
+  return forEachSpeaker(
+      [=](AudioObjectImpl& object) { return object.pauseWithFade(fadeDurationInMs); });
+}
+
+EngineError SpeakersVirtualizerImpl::stop() {
+  return forEachSpeaker([](AudioObjectImpl& object) { return object.stop(); });
+}
+
+EngineError SpeakersVirtualizerImpl::stopScheduled(float millisecondsFromNow) {
+  return forEachSpeaker(
+      [=](AudioObjectImpl& object) { return object.stopScheduled(millisecondsFromNow); });
+}
+
+EngineError SpeakersVirtualizerImpl::stopWithFade(float fadeDurationInMs) {
+  return forEachSpeaker(
+      [=](AudioObjectImpl& object) { return object.stopWithFade(fadeDurationInMs); });
+}
+
+PlayState SpeakersVirtualizerImpl::getPlayState() const {
+  return speakers_.empty() ? PlayState::INVALID : speakers_[0]->object->getPlayState();
+}
+
+EngineError SpeakersVirtualizerImpl::checkProducer() {
+  if (!haveProducerThread_) {
+    producerThread_ = std::this_thread::get_id();
+    haveProducerThread_ = true;
+  } else if (producerThread_ != std::this_thread::get_id()) {
+    return EngineError::BAD_THREAD;
+  }
+  return speakers_.empty() ? EngineError::FAIL : EngineError::OK;
+}
+
+template <typename Convert>
+EngineError SpeakersVirtualizerImpl::enqueue(
+    int32_t numFrames,
+    int32_t& numEnqueued,
+    bool endOfStream,
+    Convert convert) {
+  numEnqueued = 0;
+  const int32_t numRegions = static_cast<int32_t>(regions_.size());
+  int32_t numAcquired = 0;
+  const EngineError error = acquireWrite(numFrames, regions_.data(), numRegions, numAcquired);
+  if (error != EngineError::OK && error != EngineError::QUEUE_FULL) {
+    return error;
+  }
+
+  for (size_t c = 0; c < regions_.size(); ++c) {
+    fillRegion(regions_[c], static_cast<size_t>(numAcquired), [&](size_t frame, size_t) {
+      return convert(frame, c);
+    });
+  }
+  commitWrite(numAcquired, SampleFormat::FLOAT, endOfStream);
+  numEnqueued = numAcquired;
+  return error;
+}
+
+EngineError SpeakersVirtualizerImpl::enqueueData(
+    const float* interleavedBuffer,
+    int32_t numTotalSamples,
+    int32_t& numEnqueued,
+    bool endOfStream) {
+  numEnqueued = 0;
+  const EngineError error = checkProducer();
+  if (error != EngineError::OK) {
+    return error;
+  }
+  const size_t numChannels = speakers_.size();
+  if (numTotalSamples < 0 || static_cast<size_t>(numTotalSamples) % numChannels != 0) {
+    return EngineError::INVALID_BUFFER_SIZE;
+  }
+
+  const int32_t numFrames = numTotalSamples / static_cast<int32_t>(numChannels);
+  const EngineError result =
+      enqueue(numFrames, numEnqueued, endOfStream, [=](size_t frame, size_t channel) {
+        return interleavedBuffer[frame * numChannels + channel];
+      });
+  numEnqueued *= static_cast<int32_t>(numChannels);
+  return result;
+}
+
+EngineError SpeakersVirtualizerImpl::enqueueData(
+    const int16_t* interleavedBuffer,
+    int32_t numTotalSamples,
+    int32_t& numEnqueued,
+    bool endOfStream) {
+  numEnqueued = 0;
+  const EngineError error = checkProducer();
+  if (error != EngineError::OK) {
+    return error;
+  }
+  const size_t numChannels = speakers_.size();
+  if (numTotalSamples < 0 || static_cast<size_t>(numTotalSamples) % numChannels != 0) {
+    return EngineError::INVALID_BUFFER_SIZE;
+  }
+
+  const int32_t numFrames = numTotalSamples / static_cast<int32_t>(numChannels);
+  const EngineError result =
+      enqueue(numFrames, numEnqueued, endOfStream, [=](size_t frame, size_t channel) {
+        return static_cast<float>(interleavedBuffer[frame * numChannels + channel]) / 32768.f;
+      });
+  numEnqueued *= static_cast<int32_t>(numChannels);
+  return result;
+}
+
+EngineError SpeakersVirtualizerImpl::enqueuePlanarData(
+    const float* const* channelBuffers,
+    int32_t numSamplesPerChannel,
+    int32_t& numEnqueued,
+    bool endOfStream) {
+  numEnqueued = 0;
+  if (!areBuffersValid(channelBuffers, speakers_.size())) {
+    return EngineError::INVALID_BUFFER;
+  }
+  return enqueue(
+      numSamplesPerChannel, numEnqueued, endOfStream, [=](size_t frame, size_t channel) {
+        return channelBuffers[channel][frame];
+      });
+}
+
+EngineError SpeakersVirtualizerImpl::enqueuePlanarData(
+    const int16_t* const* channelBuffers,
+    int32_t numSamplesPerChannel,
+    int32_t& numEnqueued,
+    bool endOfStream) {
+  numEnqueued = 0;
+  if (!areBuffersValid(channelBuffers, speakers_.size())) {
+    return EngineError::INVALID_BUFFER;
+  }
+  return enqueue(
+      numSamplesPerChannel, numEnqueued, endOfStream, [=](size_t frame, size_t channel) {
+        return static_cast<float>(channelBuffers[channel][frame]) / 32768.f;
+      });
+}
+
+EngineError SpeakersVirtualizerImpl::acquireWrite(
+    int32_t numSamplesPerChannel,
+    QueueWriteRegion* regions,
+    int32_t numRegions,
+    int32_t& numAcquired) {
+  numAcquired = 0;
+  numAcquired_ = 0;
+  const EngineError error = checkProducer();
+  if (error != EngineError::OK) {
+    return error;
+  }
+  if (regions == nullptr || numRegions < 0 || static_cast<size_t>(numRegions) < speakers_.size()) {
+    return EngineError::INVALID_CHANNEL_COUNT;
+  }
+
+  size_t numFrames = static_cast<size_t>(std::max(0, numSamplesPerChannel));
+  for (auto& speaker : speakers_) {
+    numFrames = std::min(numFrames, speaker->queue.getNumWritable());
+  }
+  for (size_t c = 0; c < speakers_.size(); ++c) {
+    acquireRegion(speakers_[c]->queue, 1, numFrames, regions[c]);
+  }
+
+  numAcquired_ = numFrames;
+  numAcquired = static_cast<int32_t>(numFrames);
+  return numAcquired == numSamplesPerChannel ? EngineError::OK : EngineError::QUEUE_FULL;
+}
+
+EngineError SpeakersVirtualizerImpl::commitWrite(
+    int32_t numSamplesPerChannel,
+    SampleFormat format,
+    bool endOfStream) {
+  const size_t numAcquired = numAcquired_;
+  numAcquired_ = 0;
+  const EngineError error = checkProducer();
+  if (error != EngineError::OK) {
+    return error;
+  }
+  if (numSamplesPerChannel < 0 || static_cast<size_t>(numSamplesPerChannel) > numAcquired) {
+    return EngineError::INVALID_BUFFER_SIZE;
+  }
+
+  const size_t numFrames = static_cast<size_t>(numSamplesPerChannel);
+  for (auto& speaker : speakers_) {
+    if (format == SampleFormat::INT16) {
+      // The write position has not moved since acquireWrite(), so this is the same region
+      QueueWriteRegion region;
+      acquireRegion(speaker->queue, 1, numFrames, region);
+      convertRegionFromInt16(region, numFrames);
+    }
+    speaker->queue.commitWrite(numFrames);
+  }
+  numWritten_.fetch_add(numFrames);
+
+  if (endOfStream) {
+    endOfStream_.store(true);
+  }
+  return EngineError::OK;
+}
+
+EngineError SpeakersVirtualizerImpl::setEventCallback(EventCallback callback, void* userData) {
+  EventCallbackInfo info;
+  info.callback = callback;
+  info.userData = userData;
+  callback_.store(info);
+  return EngineError::OK;
+}
+
+int32_t SpeakersVirtualizerImpl::getFreeSpaceInQueue() const {
+  if (speakers_.empty()) {
+    return 0;
+  }
+  size_t numFrames = SIZE_MAX;
+  for (auto& speaker : speakers_) {
+    numFrames = std::min(numFrames, speaker->queue.getNumWritable());
+  }
+  return static_cast<int32_t>(numFrames * speakers_.size());
+}
+
+int32_t SpeakersVirtualizerImpl::getQueueSize() const {
+  return speakers_.empty()
+      ? 0
+      : static_cast<int32_t>(speakers_[0]->queue.capacity() * speakers_.size());
+}
+
+void SpeakersVirtualizerImpl::flushQueue() {
+  // The audio thread owns the read side of the queues, so it discards the data on the next block
+  flushTarget_.store(numWritten_.load());
+  endOfStream_.store(false);
+}
+
+void SpeakersVirtualizerImpl::setEndOfStream(bool endOfStream) {
+  endOfStream_.store(endOfStream);
+}
+
+bool SpeakersVirtualizerImpl::getEndOfStreamStatus() const {
+  return endOfStream_.load();
+}
+
+uint64_t SpeakersVirtualizerImpl::getNumSamplesDequeuedPerChannel() const {
+  return numDequeued_.load();
+}
+
+void SpeakersVirtualizerImpl::setVolume(
+    float linearGain,
+    float rampTimeMs,
+    bool forcePreviousRamp) {
+  forEachSpeaker([=](AudioObjectImpl& object) {
+    object.setVolume(linearGain, rampTimeMs, forcePreviousRamp);
+    return EngineError::OK;
+  });
+}
+
+void SpeakersVirtualizerImpl::setVolumeDecibels(
+    float dB,
+    float rampTimeMs,
+    bool forcePreviousRamp) {
+  setVolume(std::pow(10.f, dB / 20.f), rampTimeMs, forcePreviousRamp);
+}
+
+float SpeakersVirtualizerImpl::getVolume() const {
+  return speakers_.empty() ? 0.f : speakers_[0]->object->getVolume();
+}
+
+float SpeakersVirtualizerImpl::getVolumeDecibels() const {
+  return 20.f * std::log10(getVolume());
+}
+
+void SpeakersVirtualizerImpl::beginBlock(size_t numFrames) {
+  const uint64_t flushTarget = flushTarget_.load();
+  if (numRead_ < flushTarget) {
+    for (auto& speaker : speakers_) {
+      speaker->queue.discard(static_cast<size_t>(flushTarget - numRead_));
+    }
+    numRead_ = flushTarget;
+  }
+
+  size_t numReadable = SIZE_MAX;
+  for (auto& speaker : speakers_) {
+    numReadable = std::min(numReadable, speaker->queue.getNumReadable());
+  }
+
+  const bool endOfStream = endOfStream_.load();
+  blockFrames_ = numReadable >= numFrames || endOfStream ? std::min(numReadable, numFrames) : 0;
+  numRead_ += blockFrames_;
+  numDequeued_.fetch_add(blockFrames_);
+
+  const bool starving = blockFrames_ < numFrames && !endOfStream;
+  if (starving && !starving_) {
+    engine_.getEventDispatcher().post(
+        Event::ERROR_BUFFER_UNDERRUN, static_cast<SpeakersVirtualizer*>(this), callback_);
+  }
+  starving_ = starving;
+}
+
+void SpeakersVirtualizerImpl::readSpeaker(
+    float* buffer,
+    size_t numFrames,
+    size_t numChannels,
+    void* userData) {
+  (void)numChannels;
+  Speaker* speaker = static_cast<Speaker*>(userData);
+  SpeakersVirtualizerImpl* owner = speaker->owner;
+
+  // The first speaker rendered in a block decides how much every speaker consumes
+  const int64_t time = owner->engine_.getDSPTime();
+  if (time != owner->blockTime_) {
+    owner->blockTime_ = time;
+    owner->beginBlock(numFrames);
+  }
+
+  const size_t numRead = speaker->queue.read(buffer, std::min(owner->blockFrames_, numFrames));
+  std::fill(buffer + numRead, buffer + numFrames, 0.f);
+}
+} // namespace TBE
+
+extern "C" {
+
+TBE::SpeakersVirtualizerExtensions* TBE_GetSpeakersVirtualizerExtensions(
+    TBE::SpeakersVirtualizer* virtualizer) {
+  // Every SpeakersVirtualizer is created by the engine from its pool
+  return virtualizer != nullptr ? static_cast<TBE::SpeakersVirtualizerImpl*>(virtualizer) : nullptr;
+}
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include "third_party/facebook/Audio360/Linux/EventDispatcher.h"
+#include "third_party/facebook/Audio360/Linux/QueueWriteRegion.h"
+#include "third_party/facebook/Audio360/Linux/RingBuffer.h"
+#include "third_party/facebook/Audio360/include/TBE_AudioEngine.h"
+#include "third_party/facebook/Audio360/include/TBE_AudioEngineExtensions.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace TBE {
+class AudioEngineImpl;
+class AudioObjectImpl;
+
+/// Plays a speaker layout through one AudioObject per speaker, positioned around the listener.
+/// Each speaker reads from its own lock-free queue. The queues are always consumed by the same
+/// number of frames per block so the channels stay aligned.
+class SpeakersVirtualizerImpl : public SpeakersVirtualizer, public SpeakersVirtualizerExtensions {
+ public:
+  explicit SpeakersVirtualizerImpl(AudioEngineImpl& engine);
+  ~SpeakersVirtualizerImpl() override;
+
+  /// Take audio objects from the engine's pool for each speaker of the layout.
+  /// \return EngineError::OK or EngineError::NO_OBJECTS_IN_POOL
+  EngineError create(SpeakerPosition const* layout, size_t channelBufferSizeInSamples);
+
+  /// Return the audio objects to the engine's pool.
+  void release();
+
+  EngineError play() override;
+  EngineError playScheduled(float millisecondsFromNow) override;
+  EngineError playWithFade(float fadeDurationInMs) override;
+  EngineError pause() override;
+  EngineError pauseScheduled(float millisecondsFromNow) override;
+  EngineError pauseWithFade(float fadeDurationInMs) override;
+  EngineError stop() override;
+  EngineError stopScheduled(float millisecondsFromNow) override;
+  EngineError stopWithFade(float fadeDurationInMs) override;
+  PlayState getPlayState() const override;
+
+  EngineError enqueueData(
+      const float* interleavedBuffer,
+      int32_t numTotalSamples,
+      int32_t& numEnqueued,
+      bool endOfStream) override;
+  EngineError enqueueData(
+      const int16_t* interleavedBuffer,
+      int32_t numTotalSamples,
+      int32_t& numEnqueued,
+      bool endOfStream) override;
+  EngineError setEventCallback(EventCallback callback, void* userData) override;
+  int32_t getFreeSpaceInQueue() const override;
+  int32_t getQueueSize() const override;
+  void flushQueue() override;
+  void setEndOfStream(bool endOfStream) override;
+  bool getEndOfStreamStatus() const override;
+  uint64_t getNumSamplesDequeuedPerChannel() const override;
+  void setVolume(float linearGain, float rampTimeMs, bool forcePreviousRamp) override;
+  void setVolumeDecibels(float dB, float rampTimeMs, bool forcePreviousRamp) override;
+  float getVolume() const override;
+  float getVolumeDecibels() const override;
+
+  // SpeakersVirtualizerExtensions
+  EngineError enqueuePlanarData(
+      const float* const* channelBuffers,
+      int32_t numSamplesPerChannel,
+      int32_t& numEnqueued,
+      bool endOfStream) override;
+  EngineError enqueuePlanarData(
+      const int16_t* const* channelBuffers,
+      int32_t numSamplesPerChannel,
+      int32_t& numEnqueued,
+      bool endOfStream) override;
+  EngineError acquireWrite(
+      int32_t numSamplesPerChannel,
+      QueueWriteRegion* regions,
+      int32_t numRegions,
+      int32_t& numAcquired) override;
+  EngineError
+  commitWrite(int32_t numSamplesPerChannel, SampleFormat format, bool endOfStream) override;
+
+ private:
+  struct Speaker {
+    SpeakersVirtualizerImpl* owner{nullptr};
+    AudioObjectImpl* object{nullptr};
+    RingBuffer<float> queue;
+  };
+
+  static void readSpeaker(float* buffer, size_t numFrames, size_t numChannels, void* userData);
+
+  /// Audio thread: decide how many frames every speaker reads in the current block.
+  void beginBlock(size_t numFrames);
+
+  /// Apply a transport command to every speaker in the same block.
+  template <typename Command>
+  EngineError forEachSpeaker(Command command);
+
+  /// Producer: check the calling thread and that there are speakers.
+  EngineError checkProducer();
+
+  /// Producer: enqueue frames straight into the queues. convert(frame, channel) returns each
+  /// sample.
+  template <typename Convert>
+  EngineError
+  enqueue(int32_t numFrames, int32_t& numEnqueued, bool endOfStream, Convert convert);
+
+  AudioEngineImpl& engine_;
+  std::vector<std::unique_ptr<Speaker>> speakers_;
+  SeqLock<EventCallbackInfo> callback_;
+  std::atomic<bool> endOfStream_{false};
+  std::atomic<uint64_t> numWritten_{0};
+  std::atomic<uint64_t> flushTarget_{0};
+  std::atomic<uint64_t> numDequeued_{0};
+
+  // Producer state
+  std::thread::id producerThread_;
+  bool haveProducerThread_{false};
+  std::vector<QueueWriteRegion> regions_;
+  size_t numAcquired_{0}; /// Frames handed out by acquireWrite() and not committed yet
+
+  // Audio thread state
+  int64_t blockTime_{-1};
+  size_t blockFrames_{0};
+  uint64_t numRead_{0};
+  bool starving_{false};
+};
+} // namespace TBE
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/Linux/StreamingSource.h"
+
+namespace TBE {
+namespace {
+const size_t kMaxPendingLoops = 16;
+const uint64_t kSeekStateBits = 2;
+
+/// Pack a seek state and its target, so that each transition of the state is a single compare
+/// and swap that also checks the target has not been replaced
+uint64_t makeSeek(int state, size_t target) {
+  return (static_cast<uint64_t>(target) << kSeekStateBits) | static_cast<uint64_t>(state);
+}
+
+int getSeekState(uint64_t seek) {
+  return static_cast<int>(seek & ((uint64_t(1) << kSeekStateBits) - 1));
+}
+
+size_t getSeekTarget(uint64_t seek) {
+  return static_cast<size_t>(seek >> kSeekStateBits);
+}
+} // namespace
+
+StreamingSource::StreamingSource(size_t bufferSizePerChannel, size_t decodeChunkSize)
+    : bufferSizePerChannel_(std::max(bufferSizePerChannel, decodeChunkSize * 2)),
+      decodeChunkSize_(decodeChunkSize),
+      loopMarkers_(kMaxPendingLoops) {}
+
+StreamingSource::~StreamingSource() {}
+
+void StreamingSource::attach(AudioFormatDecoder* decoder, bool progressive) {
+  std::lock_guard<std::mutex> lock(decoderMutex_);
+  decoder_.reset(decoder);
+  progressive_ = progressive;
+  const int32_t numChannels = decoder_ ? decoder_->getNumOfChannels() : 0;
+  buffer_.resize(bufferSizePerChannel_ * numChannels);
+  decodeBuffer_.resize(decodeChunkSize_ * numChannels);
+  loopMarkers_.reset();
+  numChannels_.store(numChannels);
+  duration_.store(decoder_ ? decoder_->getNumSamplesPerChannel() : 0);
+  primed_.store(false);
+  endOfStream_.store(false);
+  seek_.store(makeSeek(SEEK_NONE, 0));
+  elapsed_.store(0);
+  framesWritten_ = 0;
+  announcedPrimed_ = false;
+  framesRead_ = 0;
+  startPosition_ = 0;
+  pastLoopMarker_ = false;
+  lastLoopMarker_ = 0;
+}
+
+void StreamingSource::detach() {
+  attach(nullptr);
+}
+
+bool StreamingSource::isOpen() const {
+  return numChannels_.load() > 0;
+}
+
+int32_t StreamingSource::getNumChannels() const {
+  return numChannels_.load();
+}
+
+bool StreamingSource::decode() {
+  std::unique_lock<std::mutex> lock(decoderMutex_, std::try_to_lock);
+  if (!lock.owns_lock() || !decoder_) {
+    return false;
+  }
+
+  uint64_t seek = seek_.load();
+  while (getSeekState(seek) == SEEK_REQUESTED &&
+         !seek_.compare_exchange_weak(seek, makeSeek(SEEK_ACKNOWLEDGED, getSeekTarget(seek)))) {
+  }
+  if (getSeekState(seek) == SEEK_REQUESTED || getSeekState(seek) == SEEK_ACKNOWLEDGED) {
+    // Wait for the consumer to drop what has already been decoded
+    return false;
+  }
+  if (getSeekState(seek) == SEEK_FLUSHED &&
+      seek_.compare_exchange_strong(seek, makeSeek(SEEK_NONE, getSeekTarget(seek)))) {
+    decoder_->seekToSample(getSeekTarget(seek));
+    framesWritten_ = 0;
+    endOfStream_.store(false, std::memory_order_release);
+  }
+
+  const size_t numChannels = static_cast<size_t>(numChannels_.load());
+  bool full = false;
+  while (!endOfStream_.load(std::memory_order_relaxed)) {
+    if (buffer_.getNumWritable() < decodeChunkSize_ * numChannels) {
+      full = true;
+      break;
+    }
+
+    const int32_t numSamples = static_cast<int32_t>(decodeChunkSize_ * numChannels);
+    const size_t numFrames = decoder_->decode(decodeBuffer_.data(), numSamples) / numChannels;
+    if (numFrames > 0) {
+      buffer_.write(decodeBuffer_.data(), numFrames * numChannels);
+      framesWritten_ += numFrames;
+      continue;
+    }
+    if (progressive_ && !decoder_->endOfStream()) {
+      // Wait for more of the asset
+      break;
+    }
+
+    if (decoder_->endOfStream() && !decoder_->decoderError() && looping_.load() &&
+        duration_.load() > 0) {
+      if (loopMarkers_.getNumWritable() == 0) {
+        break;
+      }
+      if (decoder_->seekToSample(0) == EngineError::OK) {
+        loopMarkers_.push(framesWritten_);
+        continue;
+      }
+    }
+    endOfStream_.store(true, std::memory_order_release);
+  }
+
+  if (!announcedPrimed_ && (full || endOfStream_.load(std::memory_order_relaxed))) {
+    announcedPrimed_ = true;
+    primed_.store(true, std::memory_order_release);
+    return true;
+  }
+  return false;
+}
+
+size_t StreamingSource::read(float* out, size_t numFrames, int32_t& numLoops) {
+  numLoops = 0;
+
+  // A seek acknowledged before the buffer was primed is flushed too, or the decoder would wait
+  // for it forever
+  uint64_t seek = seek_.load();
+  if (getSeekState(seek) == SEEK_ACKNOWLEDGED &&
+      seek_.compare_exchange_strong(seek, makeSeek(SEEK_FLUSHED, getSeekTarget(seek)))) {
+    buffer_.discard(buffer_.getNumReadable());
+    uint64_t marker = 0;
+    while (loopMarkers_.pop(marker)) {
+    }
+    framesRead_ = 0;
+    startPosition_ = getSeekTarget(seek);
+    pastLoopMarker_ = false;
+    elapsed_.store(startPosition_);
+    return 0;
+  }
+  if (getSeekState(seek) != SEEK_NONE || !primed_.load(std::memory_order_acquire)) {
+    return 0;
+  }
+
+  const size_t numChannels = static_cast<size_t>(numChannels_.load());
+  const size_t numRead = buffer_.read(out, numFrames * numChannels) / numChannels;
+  framesRead_ += numRead;
+
+  uint64_t marker = 0;
+  while (loopMarkers_.peek(marker) && framesRead_ >= marker) {
+    loopMarkers_.pop(marker);
+    pastLoopMarker_ = true;
+    lastLoopMarker_ = marker;
+    ++numLoops;
+  }
+
+  elapsed_.store(
+      pastLoopMarker_ ? static_cast<size_t>(framesRead_ - lastLoopMarker_)
+                      : startPosition_ + static_cast<size_t>(framesRead_));
+  return numRead;
+}
+
+bool StreamingSource::finished() const {
+  return primed_.load(std::memory_order_acquire) &&
+      endOfStream_.load(std::memory_order_acquire) && buffer_.getNumReadable() == 0 &&
+      getSeekState(seek_.load()) == SEEK_NONE;
+}
+
+bool StreamingSource::ready() const {
+  return primed_.load(std::memory_order_acquire) && getSeekState(seek_.load()) == SEEK_NONE;
+}
+
+size_t StreamingSource::getNumBufferedFrames() const {
+  const int32_t numChannels = numChannels_.load();
+  return numChannels > 0 ? buffer_.getNumReadable() / static_cast<size_t>(numChannels) : 0;
+}
+
+size_t StreamingSource::getBufferSizeFrames() const {
+  return bufferSizePerChannel_;
+}
+
+bool StreamingSource::isBacklogged() const {
+  return isOpen() && !endOfStream_.load(std::memory_order_acquire) &&
+      getNumBufferedFrames() * 2 < bufferSizePerChannel_;
+}
+
+EngineError StreamingSource::seekToSample(size_t timeInSamples) {
+  if (!isOpen() || timeInSamples > duration_.load()) {
+    return EngineError::FAIL;
+  }
+  elapsed_.store(timeInSamples);
+  seek_.store(makeSeek(SEEK_REQUESTED, timeInSamples));
+  return EngineError::OK;
+}
+
+bool StreamingSource::retargetAcknowledgedSeek(size_t timeInSamples) {
+  uint64_t seek = seek_.load();
+  if (getSeekState(seek) != SEEK_ACKNOWLEDGED || timeInSamples > duration_.load()) {
+    return false;
+  }
+  // Fails if the client has requested another seek since, which then goes ahead untouched. The
+  // elapsed time is set when read() drops the buffered audio.
+  return seek_.compare_exchange_strong(seek, makeSeek(SEEK_ACKNOWLEDGED, timeInSamples));
+}
+
+void StreamingSource::enableLooping(bool loop) {
+  looping_.store(loop);
+}
+
+bool StreamingSource::loopingEnabled() const {
+  return looping_.load();
+}
+
+size_t StreamingSource::getElapsedSamples() const {
+  return elapsed_.load();
+}
+
+size_t StreamingSource::getDurationSamples() const {
+  return duration_.load();
+}
+} // namespace TBE
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include "third_party/facebook/Audio360/Linux/RingBuffer.h"
+#include "third_party/facebook/Audio360/include/TBE_AudioEngine.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+namespace TBE {
+/// Streams an AudioFormatDecoder through a lock-free buffer. The decoder side (decode()) runs on
+/// the decoder thread or the audio thread, the consumer side (read()) runs on the audio thread.
+/// Seeking and looping are handled without locks: seeks are handed from the client to the decoder
+/// and the consumer through a small state machine, and loop points are passed to the consumer as
+/// markers so the elapsed time and Event::LOOPED are sample accurate.
+class StreamingSource {
+ public:
+  /// \param bufferSizePerChannel Size of the streaming buffer in samples per channel
+  /// \param decodeChunkSize Number of samples per channel decoded at a time
+  StreamingSource(size_t bufferSizePerChannel, size_t decodeChunkSize);
+  ~StreamingSource();
+
+  /// Client thread: take ownership of a decoder and reset playback to the start of the asset.
+  /// The owner must ensure read() is not called in parallel.
+  /// \param progressive If the decoder can run dry before the end of the stream while the asset is
+  /// still being filled, as PcmCacheDecoder does. decode() then picks up where it left off.
+  void attach(AudioFormatDecoder* decoder, bool progressive = false);
+
+  /// Client thread: release the decoder. The owner must ensure read() is not called in parallel.
+  void detach();
+
+  bool isOpen() const;
+  int32_t getNumChannels() const;
+
+  /// Decoder side: top up the streaming buffer.
+  /// \return true the first time the buffer has been primed and the asset is ready to play
+  bool decode();
+
+  /// Audio thread: read up to numFrames interleaved frames.
+  /// \param numLoops Filled in with the number of times playback wrapped around a loop point
+  /// \return Number of frames read
+  size_t read(float* out, size_t numFrames, int32_t& numLoops);
+
+  /// \return true if the asset has been fully decoded and played
+  bool finished() const;
+
+  /// \return true if the buffer has been primed and no seek is in progress
+  bool ready() const;
+
+  /// Audio thread: \return Number of frames buffered ahead of playback
+  size_t getNumBufferedFrames() const;
+
+  /// \return Size of the streaming buffer in frames
+  size_t getBufferSizeFrames() const;
+
+  /// Audio thread: \return true if the decoder is falling behind, with the buffer less than half
+  /// full before the end of the stream
+  bool isBacklogged() const;
+
+  EngineError seekToSample(size_t timeInSamples);
+
+  /// Audio thread: if the decoder has acknowledged the pending seek, move its target. The decoder
+  /// only seeks once the next read() has dropped the buffered audio, so the target can be chosen
+  /// for the block in which the new audio arrives. A seek requested by the client in the meantime
+  /// is never overwritten.
+  /// \return true if the seek was acknowledged and its target moved
+  bool retargetAcknowledgedSeek(size_t timeInSamples);
+
+  void enableLooping(bool loop);
+  bool loopingEnabled() const;
+  size_t getElapsedSamples() const;
+  size_t getDurationSamples() const;
+
+ private:
+  enum SeekState { SEEK_NONE, SEEK_REQUESTED, SEEK_ACKNOWLEDGED, SEEK_FLUSHED };
+
+  const size_t bufferSizePerChannel_;
+  const size_t decodeChunkSize_;
+  std::mutex decoderMutex_;
+  std::unique_ptr<AudioFormatDecoder> decoder_;
+  std::vector<float> decodeBuffer_;
+  RingBuffer<float> buffer_;
+  RingBuffer<uint64_t> loopMarkers_;
+  std::atomic<int32_t> numChannels_{0};
+  std::atomic<size_t> duration_{0};
+  bool progressive_{false};
+  std::atomic<bool> looping_{false};
+  std::atomic<bool> primed_{false};
+  std::atomic<bool> endOfStream_{false};
+  std::atomic<uint64_t> seek_{0}; /// SeekState and target of the seek in one word, see makeSeek()
+  std::atomic<size_t> elapsed_{0};
+
+  // Decoder side
+  uint64_t framesWritten_{0};
+  bool announcedPrimed_{false};
+
+  // Consumer side
+  uint64_t framesRead_{0};
+  size_t startPosition_{0};
+  bool pastLoopMarker_{false};
+  uint64_t lastLoopMarker_{0};
+};
+} // namespace TBE
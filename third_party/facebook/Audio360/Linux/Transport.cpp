@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/Linux/Transport.h"
+
+namespace TBE {
+namespace {
+const size_t kCommandQueueSize = 64;
+} // namespace
+
+Transport::Transport(float sampleRate) : sampleRate_(sampleRate), commands_(kCommandQueueSize) {}
+
+EngineError Transport::play() {
+  const EngineError err = post(Action::PLAY, 0.f, 0.f);
+  if (err == EngineError::OK) {
+    playState_.store(static_cast<int>(PlayState::PLAYING), std::memory_order_relaxed);
+  }
+  return err;
+}
+
+EngineError Transport::playScheduled(float millisecondsFromNow) {
+  return post(Action::PLAY, millisecondsFromNow, 0.f);
+}
+
+EngineError Transport::playWithFade(float fadeDurationInMs) {
+  const EngineError err = post(Action::PLAY, 0.f, fadeDurationInMs);
+  if (err == EngineError::OK) {
+    playState_.store(static_cast<int>(PlayState::PLAYING), std::memory_order_relaxed);
+  }
+  return err;
+}
+
+EngineError Transport::pause() {
+  const EngineError err = post(Action::PAUSE, 0.f, 0.f);
+  int expected = static_cast<int>(PlayState::PLAYING);
+  if (err == EngineError::OK) {
+    playState_.compare_exchange_strong(expected, static_cast<int>(PlayState::PAUSED));
+  }
+  return err;
+}
+
+EngineError Transport::pauseScheduled(float millisecondsFromNow) {
+  return post(Action::PAUSE, millisecondsFromNow, 0.f);
+}
+
+EngineError Transport::pauseWithFade(float fadeDurationInMs) {
+  return post(Action::PAUSE, 0.f, fadeDurationInMs);
+}
+
+EngineError Transport::stop() {
+  const EngineError err = post(Action::STOP, 0.f, 0.f);
+  if (err == EngineError::OK) {
+    playState_.store(static_cast<int>(PlayState::STOPPED), std::memory_order_relaxed);
+  }
+  return err;
+}
+
+EngineError Transport::stopScheduled(float millisecondsFromNow) {
+  return post(Action::STOP, millisecondsFromNow, 0.f);
+}
+
+EngineError Transport::stopWithFade(float fadeDurationInMs) {
+  return post(Action::STOP, 0.f, fadeDurationInMs);
+}
+
+void Transport::setVolume(float linearGain, float rampTimeMs, bool forcePreviousRamp) {
+  linearGain = std::max(0.f, linearGain);
+  targetVolume_.store(linearGain, std::memory_order_relaxed);
+  const int64_t rampFrames = msToFrames(std::max(0.f, rampTimeMs));
+  Command cmd{Action::VOLUME, 0, rampFrames, linearGain, forcePreviousRamp};
+  commands_.push(cmd);
+}
+
+float Transport::getVolume() const {
+  return targetVolume_.load(std::memory_order_relaxed);
+}
+
+PlayState Transport::getPlayState() const {
+  return static_cast<PlayState>(playState_.load(std::memory_order_relaxed));
+}
+
+void Transport::reset() {
+  commands_.reset();
+  playState_.store(static_cast<int>(PlayState::STOPPED), std::memory_order_relaxed);
+  targetVolume_.store(1.f, std::memory_order_relaxed);
+  for (auto& scheduled : scheduled_) {
+    scheduled.pending = false;
+  }
+  state_ = PlayState::STOPPED;
+  fadeGain_ = 0.f;
+  fadeFramesLeft_ = 0;
+  stateAfterFade_ = PlayState::PLAYING;
+  volume_ = 1.f;
+  volumeTarget_ = 1.f;
+  volumeFramesLeft_ = 0;
+}
+
+EngineError Transport::post(Action action, float delayMs, float fadeMs) {
+  if (delayMs < 0.f || fadeMs < 0.f) {
+    return EngineError::FAIL;
+  }
+  Command cmd{action, msToFrames(delayMs), msToFrames(fadeMs), 0.f, false};
+  return commands_.push(cmd) ? EngineError::OK : EngineError::QUEUE_FULL;
+}
+
+int64_t Transport::msToFrames(float ms) const {
+  return static_cast<int64_t>(static_cast<double>(ms) * sampleRate_ / 1000.0 + 0.5);
+}
+
+void Transport::execute(Action action, int64_t fadeFrames) {
+  if (action == Action::PLAY) {
+    if (state_ != PlayState::PLAYING) {
+      fadeGain_ = 0.f;
+    }
+    state_ = PlayState::PLAYING;
+    stateAfterFade_ = PlayState::PLAYING;
+    if (fadeFrames > 0) {
+      fadeStep_ = (1.f - fadeGain_) / fadeFrames;
+      fadeFramesLeft_ = fadeFrames;
+    } else {
+      fadeGain_ = 1.f;
+      fadeFramesLeft_ = 0;
+    }
+    playState_.store(static_cast<int>(PlayState::PLAYING), std::memory_order_relaxed);
+    return;
+  }
+
+  const PlayState target = action == Action::STOP ? PlayState::STOPPED : PlayState::PAUSED;
+  if (state_ == PlayState::PLAYING && fadeFrames > 0) {
+    stateAfterFade_ = target;
+    fadeStep_ = -fadeGain_ / fadeFrames;
+    fadeFramesLeft_ = fadeFrames;
+    return;
+  }
+
+  if (target == PlayState::STOPPED || state_ != PlayState::STOPPED) {
+    state_ = target;
+  }
+  fadeGain_ = 0.f;
+  fadeFramesLeft_ = 0;
+  stateAfterFade_ = PlayState::PLAYING;
+  playState_.store(static_cast<int>(state_), std::memory_order_relaxed);
+}
+
+void Transport::finish() {
+  for (auto& scheduled : scheduled_) {
+    scheduled.pending = false;
+  }
+  execute(Action::STOP, 0);
+}
+
+bool Transport::process(size_t numFrames, float* gains, bool& stopped) {
+  stopped = false;
+
+  Command cmd;
+  while (commands_.pop(cmd)) {
+    if (cmd.action == Action::VOLUME) {
+      if (cmd.force) {
+        volume_ = volumeTarget_;
+      }
+      volumeTarget_ = cmd.value;
+      if (cmd.fadeFrames > 0) {
+        volumeStep_ = (volumeTarget_ - volume_) / cmd.fadeFrames;
+        volumeFramesLeft_ = cmd.fadeFrames;
+      } else {
+        volume_ = volumeTarget_;
+        volumeFramesLeft_ = 0;
+      }
+      continue;
+    }
+
+    Scheduled& scheduled = scheduled_[static_cast<int>(cmd.action)];
+    scheduled.pending = cmd.delayFrames > 0;
+    scheduled.fireAtFrame = frameClock_ + cmd.delayFrames;
+    if (!scheduled.pending) {
+      execute(cmd.action, cmd.fadeFrames);
+      stopped |= cmd.action == Action::STOP && state_ == PlayState::STOPPED;
+    }
+  }
+
+  for (int i = 0; i < 3; ++i) {
+    Scheduled& scheduled = scheduled_[i];
+    if (scheduled.pending && scheduled.fireAtFrame <= frameClock_) {
+      scheduled.pending = false;
+      execute(static_cast<Action>(i), 0);
+      stopped |= static_cast<Action>(i) == Action::STOP;
+    }
+  }
+
+  const bool active = state_ == PlayState::PLAYING;
+  for (size_t i = 0; i < numFrames; ++i) {
+    if (volumeFramesLeft_ > 0) {
+      volume_ += volumeStep_;
+      if (--volumeFramesLeft_ == 0) {
+        volume_ = volumeTarget_;
+      }
+    }
+    if (state_ != PlayState::PLAYING) {
+      gains[i] = 0.f;
+      continue;
+    }
+    if (fadeFramesLeft_ > 0) {
+      fadeGain_ += fadeStep_;
+      if (--fadeFramesLeft_ == 0) {
+        fadeGain_ = stateAfterFade_ == PlayState::PLAYING ? 1.f : 0.f;
+        if (stateAfterFade_ != PlayState::PLAYING) {
+          state_ = stateAfterFade_;
+          stateAfterFade_ = PlayState::PLAYING;
+          stopped |= state_ == PlayState::STOPPED;
+          playState_.store(static_cast<int>(state_), std::memory_order_relaxed);
+        }
+      }
+    }
+    gains[i] = fadeGain_ * volume_;
+  }
+
+  frameClock_ += static_cast<int64_t>(numFrames);
+  return active;
+}
+} // namespace TBE
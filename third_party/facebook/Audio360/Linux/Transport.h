@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include "third_party/facebook/Audio360/Linux/RingBuffer.h"
+#include "third_party/facebook/Audio360/include/TBE_AudioEngineDefinitions.h"
+
+#include <atomic>
+
+namespace TBE {
+/// Play/pause/stop state machine with scheduled commands, fades and volume ramps.
+/// The client methods are threadsafe but non reentrant and only post commands; the commands are
+/// applied on the audio thread by process(), at block granularity for scheduled commands and
+/// sample accurately for fades and ramps.
+class Transport {
+ public:
+  explicit Transport(float sampleRate);
+
+  EngineError play();
+  EngineError playScheduled(float millisecondsFromNow);
+  EngineError playWithFade(float fadeDurationInMs);
+  EngineError pause();
+  EngineError pauseScheduled(float millisecondsFromNow);
+  EngineError pauseWithFade(float fadeDurationInMs);
+  EngineError stop();
+  EngineError stopScheduled(float millisecondsFromNow);
+  EngineError stopWithFade(float fadeDurationInMs);
+
+  void setVolume(float linearGain, float rampTimeMs, bool forcePreviousRamp);
+  float getVolume() const;
+
+  PlayState getPlayState() const;
+
+  /// Return to the stopped state at unity volume, dropping pending commands. Not thread safe.
+  void reset();
+
+  /// Audio thread: apply pending commands and advance the transport by numFrames.
+  /// \param numFrames Number of frames in the block
+  /// \param gains Filled in with the combined fade and volume gain for each frame
+  /// \param stopped Set to true if a stop took effect during this block and the owner must rewind
+  /// \return true if the owner must render (and consume) audio for this block
+  bool process(size_t numFrames, float* gains, bool& stopped);
+
+  /// Audio thread: stop immediately, e.g. when the end of an asset has been reached.
+  void finish();
+
+ private:
+  enum class Action { PLAY, PAUSE, STOP, VOLUME };
+
+  struct Command {
+    Action action;
+    int64_t delayFrames;
+    int64_t fadeFrames;
+    float value;
+    bool force;
+  };
+
+  struct Scheduled {
+    bool pending{false};
+    int64_t fireAtFrame{0};
+  };
+
+  EngineError post(Action action, float delayMs, float fadeMs);
+  int64_t msToFrames(float ms) const;
+  void execute(Action action, int64_t fadeFrames);
+
+  const float sampleRate_;
+  RingBuffer<Command> commands_;
+  std::atomic<int> playState_{static_cast<int>(PlayState::STOPPED)};
+  std::atomic<float> targetVolume_{1.f};
+
+  // Audio thread state
+  int64_t frameClock_{0};
+  Scheduled scheduled_[3];
+  PlayState state_{PlayState::STOPPED};
+  float fadeGain_{0.f};
+  float fadeStep_{0.f};
+  int64_t fadeFramesLeft_{0};
+  PlayState stateAfterFade_{PlayState::PLAYING};
+  float volume_{1.f};
+  float volumeTarget_{1.f};
+  float volumeStep_{0.f};
+  int64_t volumeFramesLeft_{0};
+};
+} // namespace TBE
@@ -0,0 +1,428 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/Linux/WavFormatDecoder.h"
+#include "third_party/facebook/Audio360/Linux/MemoryStream.h"
+
+#include <string.h>
+
+namespace TBE {
+namespace {
+const uint16_t kFormatPcm = 0x0001;
+const uint16_t kFormatFloat = 0x0003;
+const uint16_t kFormatExtensible = 0xFFFE;
+const size_t kMaxFmtChunkSize = 40;
+
+uint16_t readLE16(const unsigned char* data) {
+  return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+uint32_t readLE32(const unsigned char* data) {
+  return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+      (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+} // namespace
+
+WavFormatDecoder::WavFormatDecoder(int32_t maxBufferSizePerChannel, float outputSampleRate)
+    : maxBufferSizePerChannel_(std::max(1, maxBufferSizePerChannel)),
+      outputSampleRate_(outputSampleRate) {}
+
+WavFormatDecoder::~WavFormatDecoder() {}
+
+EngineError WavFormatDecoder::open(IOStream* stream, bool shouldOwnStream) {
+  if (shouldOwnStream) {
+    ownedStream_.reset(stream);
+  }
+  if (stream == nullptr || !stream->ready() || !stream->canSeek()) {
+    return EngineError::ERROR_OPENING_FILE;
+  }
+
+  Header header;
+  const EngineError err = parseHeader(*stream, header);
+  if (err != EngineError::OK) {
+    return err;
+  }
+  // Already owned above
+  return open(stream, false, header);
+}
+
+EngineError
+WavFormatDecoder::open(IOStream* stream, bool shouldOwnStream, const Header& header) {
+  if (shouldOwnStream) {
+    ownedStream_.reset(stream);
+  }
+  if (stream == nullptr || !stream->ready() || !stream->canSeek() ||
+      header.format.blockAlign == 0 || header.dataOffset > stream->getSize()) {
+    return EngineError::ERROR_OPENING_FILE;
+  }
+
+  stream_ = stream;
+  format_ = header.format;
+  dataOffset_ = header.dataOffset;
+  dataSize_ = std::min(header.dataSize, stream_->getSize() - dataOffset_);
+  numSourceFrames_ = dataSize_ / format_.blockAlign;
+  initialise();
+  return EngineError::OK;
+}
+
+EngineError WavFormatDecoder::openFromHeader(const char* headerData, size_t headerDataSize) {
+  if (headerData == nullptr) {
+    return EngineError::INVALID_HEADER;
+  }
+  MemoryStream stream(headerData, headerDataSize);
+  Header header;
+  const EngineError err = parseHeader(stream, header);
+  if (err != EngineError::OK) {
+    return err;
+  }
+  format_ = header.format;
+  dataOffset_ = header.dataOffset;
+  dataSize_ = header.dataSize;
+  initialise();
+  return EngineError::OK;
+}
+
+void WavFormatDecoder::initialise() {
+  if (outputSampleRate_ <= 0.f) {
+    outputSampleRate_ = format_.sampleRate;
+  }
+  ratio_ = static_cast<double>(format_.sampleRate) / outputSampleRate_;
+  raw_.resize(static_cast<size_t>(maxBufferSizePerChannel_) * format_.blockAlign);
+  const size_t pendingFrames =
+      static_cast<size_t>(maxBufferSizePerChannel_ * std::max(ratio_, 1.0)) +
+      maxBufferSizePerChannel_ + 2;
+  pending_.resize(pendingFrames * format_.numChannels);
+  flush(true);
+}
+
+EngineError WavFormatDecoder::parseHeader(IOStream& stream, Header& header) {
+  Format& format = header.format;
+  size_t& dataOffset = header.dataOffset;
+  dataOffset = 0;
+  unsigned char riff[12];
+  if (!stream.setPosition(0) || stream.read(riff, sizeof(riff)) != sizeof(riff) ||
+      memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) {
+    return EngineError::INVALID_HEADER;
+  }
+
+  bool haveFormat = false;
+  uint16_t formatTag = 0;
+  unsigned char chunk[8];
+  while (stream.read(chunk, sizeof(chunk)) == sizeof(chunk)) {
+    const uint32_t chunkSize = readLE32(chunk + 4);
+
+    if (memcmp(chunk, "fmt ", 4) == 0) {
+      unsigned char fmt[kMaxFmtChunkSize] = {};
+      const size_t fmtSize = std::min<size_t>(chunkSize, kMaxFmtChunkSize);
+      if (fmtSize < 16 || stream.read(fmt, fmtSize) != fmtSize) {
+        return EngineError::INVALID_HEADER;
+      }
+      formatTag = readLE16(fmt);
+      format.numChannels = readLE16(fmt + 2);
+      format.sampleRate = static_cast<float>(readLE32(fmt + 4));
+      format.blockAlign = readLE16(fmt + 12);
+      format.numBits = readLE16(fmt + 14);
+      if (formatTag == kFormatExtensible && fmtSize >= 26) {
+        formatTag = readLE16(fmt + 24);
+      }
+      haveFormat = true;
+      const size_t remaining = chunkSize - fmtSize + (chunkSize & 1);
+      if (remaining > 0 && !stream.setPosition(remaining, SEEK_CUR)) {
+        return EngineError::INVALID_HEADER;
+      }
+    } else if (memcmp(chunk, "data", 4) == 0) {
+      if (!haveFormat) {
+        return EngineError::INVALID_HEADER;
+      }
+      dataOffset = stream.getPosition();
+      header.dataSize = chunkSize;
+      break;
+    } else if (!stream.setPosition(chunkSize + (chunkSize & 1), SEEK_CUR)) {
+      return EngineError::INVALID_HEADER;
+    }
+  }
+
+  if (!haveFormat || dataOffset == 0) {
+    return EngineError::INVALID_HEADER;
+  }
+  if (format.numChannels <= 0) {
+    return EngineError::INVALID_CHANNEL_COUNT;
+  }
+
+  format.isFloat = formatTag == kFormatFloat;
+  const bool validPcm = formatTag == kFormatPcm &&
+      (format.numBits == 8 || format.numBits == 16 || format.numBits == 24 ||
+       format.numBits == 32);
+  const bool validFloat = format.isFloat && (format.numBits == 32 || format.numBits == 64);
+  if ((!validPcm && !validFloat) || format.sampleRate <= 0.f ||
+      format.blockAlign != static_cast<size_t>(format.numChannels * format.numBits / 8)) {
+    return EngineError::INVALID_HEADER;
+  }
+  return EngineError::OK;
+}
+
+void WavFormatDecoder::convert(const char* raw, size_t numFrames, float* out) const {
+  const unsigned char* in = reinterpret_cast<const unsigned char*>(raw);
+  const size_t numSamples = numFrames * format_.numChannels;
+
+  switch (format_.numBits) {
+    case 8:
+      for (size_t i = 0; i < numSamples; ++i) {
+        out[i] = (static_cast<int>(in[i]) - 128) * (1.f / 128.f);
+      }
+      break;
+    case 16:
+      for (size_t i = 0; i < numSamples; ++i) {
+        out[i] = static_cast<int16_t>(readLE16(in + i * 2)) * (1.f / 32768.f);
+      }
+      break;
+    case 24:
+      for (size_t i = 0; i < numSamples; ++i) {
+        const unsigned char* s = in + i * 3;
+        const int32_t value = static_cast<int32_t>(
+                                  static_cast<uint32_t>(s[0]) << 8 |
+                                  static_cast<uint32_t>(s[1]) << 16 |
+                                  static_cast<uint32_t>(s[2]) << 24) >>
+            8;
+        out[i] = value * (1.f / 8388608.f);
+      }
+      break;
+    case 32:
+      for (size_t i = 0; i < numSamples; ++i) {
+        const uint32_t bits = readLE32(in + i * 4);
+        if (format_.isFloat) {
+          memcpy(&out[i], &bits, sizeof(float));
+        } else {
+          out[i] = static_cast<int32_t>(bits) * (1.f / 2147483648.f);
+        }
+      }
+      break;
+    case 64:
+      for (size_t i = 0; i < numSamples; ++i) {
+        double value;
+        memcpy(&value, in + i * 8, sizeof(double));
+        out[i] = static_cast<float>(value);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+size_t WavFormatDecoder::readFrames(size_t numFrames, float* out) {
+  size_t numAvailable = 0;
+  const char* data = static_cast<const char*>(stream_->getReadPointer(numAvailable));
+  if (data != nullptr) {
+    const size_t numRead = std::min(numFrames, numAvailable / format_.blockAlign);
+    convert(data, numRead, out);
+    stream_->setPosition(numRead * format_.blockAlign, SEEK_CUR);
+    return numRead;
+  }
+
+  numFrames = std::min(numFrames, static_cast<size_t>(maxBufferSizePerChannel_));
+  const size_t numBytes = stream_->read(raw_.data(), numFrames * format_.blockAlign);
+  const size_t numRead = numBytes / format_.blockAlign;
+  convert(raw_.data(), numRead, out);
+  return numRead;
+}
+
+size_t WavFormatDecoder::fillFromStream() {
+  const size_t capacity = pending_.size() / format_.numChannels;
+  const size_t numFrames = std::min(
+      std::min(capacity - numPendingFrames_, static_cast<size_t>(maxBufferSizePerChannel_)),
+      numSourceFrames_ - sourceFramesRead_);
+  if (numFrames == 0) {
+    return 0;
+  }
+
+  const size_t numRead =
+      readFrames(numFrames, pending_.data() + numPendingFrames_ * format_.numChannels);
+  if (numRead < numFrames) {
+    // Truncated file, treat what we have as the end of the stream
+    numSourceFrames_ = sourceFramesRead_ + numRead;
+  }
+  numPendingFrames_ += numRead;
+  sourceFramesRead_ += numRead;
+  return numRead;
+}
+
+size_t WavFormatDecoder::resample(float* out, size_t numFrames, bool drain) {
+  const int32_t numChannels = format_.numChannels;
+  size_t produced = 0;
+  while (produced < numFrames) {
+    const size_t index = static_cast<size_t>(phase_);
+    const float frac = static_cast<float>(phase_ - index);
+    const float* a = pending_.data() + index * numChannels;
+    if (index + 1 < numPendingFrames_) {
+      const float* b = a + numChannels;
+      for (int32_t c = 0; c < numChannels; ++c) {
+        out[c] = a[c] + (b[c] - a[c]) * frac;
+      }
+    } else if (drain && index < numPendingFrames_) {
+      // The final frame has no neighbour to interpolate with
+      std::copy(a, a + numChannels, out);
+    } else {
+      break;
+    }
+    out += numChannels;
+    phase_ += ratio_;
+    ++produced;
+  }
+
+  const size_t consumed = std::min(static_cast<size_t>(phase_), numPendingFrames_);
+  std::copy(
+      pending_.begin() + consumed * numChannels,
+      pending_.begin() + numPendingFrames_ * numChannels,
+      pending_.begin());
+  numPendingFrames_ -= consumed;
+  phase_ -= consumed;
+  return produced;
+}
+
+int32_t WavFormatDecoder::getNumOfChannels() const {
+  return format_.numChannels;
+}
+
+size_t WavFormatDecoder::getNumTotalSamples() const {
+  return getNumSamplesPerChannel() * format_.numChannels;
+}
+
+size_t WavFormatDecoder::getNumSamplesPerChannel() const {
+  if (numSourceFrames_ == 0) {
+    return 0;
+  }
+  return static_cast<size_t>((numSourceFrames_ - 1) / ratio_) + 1;
+}
+
+double WavFormatDecoder::getMsPerChannel() const {
+  return outputSampleRate_ > 0.f ? getNumSamplesPerChannel() * 1000.0 / outputSampleRate_ : 0.0;
+}
+
+size_t WavFormatDecoder::getSamplePosition() {
+  return outputPosition_;
+}
+
+EngineError WavFormatDecoder::seekToSample(size_t samplePosition) {
+  if (stream_ == nullptr) {
+    return EngineError::FAIL;
+  }
+
+  const double sourcePosition = samplePosition * ratio_;
+  const size_t sourceFrame = static_cast<size_t>(sourcePosition);
+  if (sourceFrame > numSourceFrames_ ||
+      !stream_->setPosition(dataOffset_ + sourceFrame * format_.blockAlign)) {
+    return EngineError::FAIL;
+  }
+
+  sourceFramesRead_ = sourceFrame;
+  numPendingFrames_ = 0;
+  phase_ = sourcePosition - sourceFrame;
+  outputPosition_ = samplePosition;
+  return EngineError::OK;
+}
+
+size_t WavFormatDecoder::decode(
+    const char* data,
+    size_t dataSize,
+    float* bufferOut,
+    int32_t numOfSamplesInBuffer) {
+  if (format_.numChannels == 0 || data == nullptr || bufferOut == nullptr) {
+    return 0;
+  }
+
+  const size_t numFrames = dataSize / format_.blockAlign;
+  const size_t required = (numPendingFrames_ + numFrames) * format_.numChannels;
+  if (pending_.size() < required) {
+    pending_.resize(required);
+  }
+  convert(data, numFrames, pending_.data() + numPendingFrames_ * format_.numChannels);
+  numPendingFrames_ += numFrames;
+
+  const size_t produced = resample(bufferOut, numOfSamplesInBuffer / format_.numChannels, false);
+  outputPosition_ += produced;
+  return produced * format_.numChannels;
+}
+
+size_t WavFormatDecoder::decode(float* bufferOut, int32_t numOfSamplesInBuffer) {
+  if (stream_ == nullptr || bufferOut == nullptr || numOfSamplesInBuffer <= 0) {
+    return 0;
+  }
+
+  const int32_t numChannels = format_.numChannels;
+  const size_t remaining = getNumSamplesPerChannel() - std::min(outputPosition_,
+                                                                getNumSamplesPerChannel());
+  const size_t numFrames = std::min<size_t>(numOfSamplesInBuffer / numChannels, remaining);
+
+  size_t produced = 0;
+  if (ratio_ == 1.0) {
+    while (produced < numFrames) {
+      const size_t chunk = numFrames - produced;
+      const size_t numRead = readFrames(chunk, bufferOut + produced * numChannels);
+      produced += numRead;
+      sourceFramesRead_ += numRead;
+      if (numRead == 0) {
+        numSourceFrames_ = sourceFramesRead_;
+        break;
+      }
+    }
+  } else {
+    while (produced < numFrames) {
+      const bool drain = sourceFramesRead_ >= numSourceFrames_;
+      const size_t numResampled =
+          resample(bufferOut + produced * numChannels, numFrames - produced, drain);
+      produced += numResampled;
+      if (produced < numFrames && fillFromStream() == 0 && drain) {
+        break;
+      }
+    }
+  }
+
+  outputPosition_ += produced;
+  return produced * numChannels;
+}
+
+float WavFormatDecoder::getSampleRate() const {
+  return format_.sampleRate;
+}
+
+float WavFormatDecoder::getOutputSampleRate() const {
+  return outputSampleRate_;
+}
+
+int32_t WavFormatDecoder::getNumBits() const {
+  return format_.numBits;
+}
+
+bool WavFormatDecoder::endOfStream() {
+  return stream_ == nullptr || outputPosition_ >= getNumSamplesPerChannel();
+}
+
+bool WavFormatDecoder::decoderError() {
+  return error_;
+}
+
+int32_t WavFormatDecoder::getMaxBufferSizePerChannel() const {
+  return maxBufferSizePerChannel_;
+}
+
+const char* WavFormatDecoder::getName() const {
+  return "wav";
+}
+
+void WavFormatDecoder::flush(bool resetToZero) {
+  numPendingFrames_ = 0;
+  phase_ = 0.0;
+  if (resetToZero) {
+    outputPosition_ = 0;
+    sourceFramesRead_ = 0;
+    if (stream_ != nullptr && !stream_->setPosition(dataOffset_)) {
+      error_ = true;
+    }
+  }
+}
+
+int32_t WavFormatDecoder::getInfo(Info) {
+  return 0;
+}
+} // namespace TBE
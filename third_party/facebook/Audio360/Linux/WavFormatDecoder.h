@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include "third_party/facebook/Audio360/include/TBE_AudioEngine.h"
+
+#include <memory>
+#include <vector>
+
+namespace TBE {
+/// AudioFormatDecoder for PCM and IEEE float WAV files, including broadcast WAV and
+/// WAVE_FORMAT_EXTENSIBLE. The audio is resampled with linear interpolation if the output sample
+/// rate differs from the sample rate of the file.
+class WavFormatDecoder : public AudioFormatDecoder {
+ public:
+  struct Format {
+    int32_t numChannels{0};
+    float sampleRate{0.f};
+    int32_t numBits{0};
+    bool isFloat{false};
+    size_t blockAlign{0};
+  };
+
+  /// What the header of a WAV stream says about its audio
+  struct Header {
+    Format format;
+    size_t dataOffset{0}; /// Position of the first frame in the stream, in bytes
+    size_t dataSize{0}; /// Size of the audio in bytes, as given by the header
+  };
+
+  /// \param maxBufferSizePerChannel Maximum number of samples per channel requested by decode(..)
+  /// \param outputSampleRate Output sample rate. 0 disables resampling.
+  WavFormatDecoder(int32_t maxBufferSizePerChannel, float outputSampleRate);
+  ~WavFormatDecoder() override;
+
+  /// Parse the header of a stream and prepare it for decoding.
+  /// \param stream Stream positioned anywhere. Must support seeking.
+  /// \param shouldOwnStream If the stream must be deleted with this object
+  /// \return EngineError::OK, EngineError::INVALID_HEADER or EngineError::INVALID_CHANNEL_COUNT
+  EngineError open(IOStream* stream, bool shouldOwnStream);
+
+  /// Prepare a stream for decoding with a header parsed beforehand, which saves reading it again
+  /// for streams of the same asset.
+  /// \param stream Stream positioned anywhere. Must support seeking.
+  /// \param shouldOwnStream If the stream must be deleted with this object
+  /// \param header Header of the stream, from parseHeader()
+  /// \return EngineError::OK or EngineError::ERROR_OPENING_FILE
+  EngineError open(IOStream* stream, bool shouldOwnStream, const Header& header);
+
+  /// Parse the header of a WAV stream.
+  /// \param stream Stream positioned anywhere. Must support seeking.
+  /// \param header Filled in with the header
+  /// \return EngineError::OK, EngineError::INVALID_HEADER or EngineError::INVALID_CHANNEL_COUNT
+  static EngineError parseHeader(IOStream& stream, Header& header);
+
+  /// Parse a WAV header for in-place decoding of PCM packets with decode(data, dataSize, ...).
+  /// \return EngineError::OK or EngineError::INVALID_HEADER
+  EngineError openFromHeader(const char* headerData, size_t headerDataSize);
+
+  int32_t getNumOfChannels() const override;
+  size_t getNumTotalSamples() const override;
+  size_t getNumSamplesPerChannel() const override;
+  double getMsPerChannel() const override;
+  size_t getSamplePosition() override;
+  EngineError seekToSample(size_t samplePosition) override;
+  size_t decode(
+      const char* data,
+      size_t dataSize,
+      float* bufferOut,
+      int32_t numOfSamplesInBuffer) override;
+  size_t decode(float* bufferOut, int32_t numOfSamplesInBuffer) override;
+  float getSampleRate() const override;
+  float getOutputSampleRate() const override;
+  int32_t getNumBits() const override;
+  bool endOfStream() override;
+  bool decoderError() override;
+  int32_t getMaxBufferSizePerChannel() const override;
+  const char* getName() const override;
+  void flush(bool resetToZero = false) override;
+  int32_t getInfo(Info info) override;
+
+ private:
+  void initialise();
+  void convert(const char* raw, size_t numFrames, float* out) const;
+  /// Read and convert up to numFrames frames from the stream, straight from its memory if it
+  /// supports zero-copy reads. At most maxBufferSizePerChannel_ frames otherwise.
+  /// \return Number of frames read
+  size_t readFrames(size_t numFrames, float* out);
+  size_t fillFromStream();
+  size_t resample(float* out, size_t numFrames, bool drain);
+
+  const int32_t maxBufferSizePerChannel_;
+  float outputSampleRate_;
+  std::unique_ptr<IOStream> ownedStream_;
+  IOStream* stream_{nullptr};
+  Format format_;
+  size_t dataOffset_{0};
+  size_t dataSize_{0};
+  size_t numSourceFrames_{0};
+  size_t sourceFramesRead_{0};
+  double ratio_{1.0};
+  std::vector<char> raw_;
+  std::vector<float> pending_;
+  size_t numPendingFrames_{0};
+  double phase_{0.0};
+  size_t outputPosition_{0};
+  bool error_{false};
+};
+} // namespace TBE
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/Linux/WorkStealingPool.h"
+
+#include <algorithm>
+
+namespace TBE {
+namespace {
+const size_t kInitialSlots = 64; /// Task slots per worker, a power of two
+} // namespace
+
+WorkStealingPool::WorkStealingPool(int32_t numThreads) {
+  if (numThreads <= 0) {
+    numThreads = std::max(1, static_cast<int32_t>(std::thread::hardware_concurrency()));
+  }
+  for (int32_t i = 0; i < numThreads; ++i) {
+    workers_.emplace_back(new Worker());
+    workers_.back()->slots.resize(kInitialSlots);
+  }
+  // Start the threads once every queue exists, as they steal from each other
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    workers_[i]->thread = std::thread(&WorkStealingPool::workerLoop, this, i);
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex_);
+    quit_ = true;
+  }
+  sleepCondition_.notify_all();
+  for (auto& worker : workers_) {
+    worker->thread.join();
+  }
+}
+
+int32_t WorkStealingPool::getNumThreads() const {
+  return static_cast<int32_t>(workers_.size());
+}
+
+void WorkStealingPool::submit(const Task& task) {
+  {
+    // Counted before the task is queued so that the count never drops below zero, and with the
+    // sleep mutex held so that a worker cannot miss the wake up
+    std::lock_guard<std::mutex> lock(sleepMutex_);
+    numQueued_.fetch_add(1);
+  }
+  Worker& worker = *workers_[next_.fetch_add(1) % workers_.size()];
+  {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.numTasks == worker.slots.size()) {
+      // Unwrap the ring into a larger one, oldest task first
+      std::vector<Task> slots(worker.slots.size() * 2);
+      for (size_t i = 0; i < worker.numTasks; ++i) {
+        slots[i] = worker.slots[(worker.front + i) & (worker.slots.size() - 1)];
+      }
+      worker.slots.swap(slots);
+      worker.front = 0;
+    }
+    worker.slots[(worker.front + worker.numTasks) & (worker.slots.size() - 1)] = task;
+    ++worker.numTasks;
+  }
+  sleepCondition_.notify_one();
+}
+
+bool WorkStealingPool::pop(size_t index, Task& task) {
+  {
+    Worker& own = *workers_[index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (own.numTasks > 0) {
+      --own.numTasks;
+      task = own.slots[(own.front + own.numTasks) & (own.slots.size() - 1)];
+      numQueued_.fetch_sub(1);
+      return true;
+    }
+  }
+  for (size_t i = 1; i < workers_.size(); ++i) {
+    Worker& victim = *workers_[(index + i) % workers_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (victim.numTasks > 0) {
+      task = victim.slots[victim.front];
+      victim.front = (victim.front + 1) & (victim.slots.size() - 1);
+      --victim.numTasks;
+      numQueued_.fetch_sub(1);
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingPool::workerLoop(size_t index) {
+  Task task;
+  while (true) {
+    if (pop(index, task)) {
+      task();
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleepMutex_);
+    sleepCondition_.wait(lock, [this] { return quit_ || numQueued_.load() > 0; });
+    if (quit_) {
+      return;
+    }
+  }
+}
+} // namespace TBE
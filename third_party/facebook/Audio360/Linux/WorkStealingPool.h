@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace TBE {
+/// Fixed pool of threads that run tasks. Tasks are spread over the workers' own queues; a worker
+/// runs the newest task of its own queue and, when it runs out, steals the oldest task of another
+/// worker. The load evens out when tasks take very different times, without a shared queue that
+/// every worker contends on. Thread safe.
+///
+/// Tasks are stored in place in a ring of slots per worker, so submitting a task does not allocate
+/// unless more tasks are queued on a worker than it has ever held before.
+class WorkStealingPool {
+ public:
+  /// A callable of up to two pointers, such as a lambda that captures an object and its argument,
+  /// stored in place rather than on the heap
+  class Task {
+   public:
+    Task() {}
+
+    template <typename Function>
+    explicit Task(const Function& function) {
+      static_assert(sizeof(Function) <= sizeof(storage_), "Task captures too much to store");
+      static_assert(alignof(Function) <= alignof(Storage), "Task is over aligned");
+      static_assert(
+          std::is_trivially_copyable<Function>::value,
+          "Task must be trivially copyable, as it is copied between slots and never destroyed");
+      new (&storage_) Function(function);
+      invoke_ = [](const void* storage) { (*static_cast<const Function*>(storage))(); };
+    }
+
+    void operator()() const {
+      invoke_(&storage_);
+    }
+
+   private:
+    typedef typename std::aligned_storage<2 * sizeof(void*), alignof(void*)>::type Storage;
+    Storage storage_;
+    void (*invoke_)(const void* storage){nullptr};
+  };
+
+  /// \param numThreads Number of worker threads. If 0, one per processor core.
+  explicit WorkStealingPool(int32_t numThreads);
+
+  /// Stop the workers. Tasks that have not started are dropped.
+  ~WorkStealingPool();
+
+  int32_t getNumThreads() const;
+
+  /// Queue a task on the next worker, round robin.
+  template <typename Function>
+  void submit(const Function& function) {
+    submit(Task(function));
+  }
+  void submit(const Task& task);
+
+ private:
+  /// A worker's queue: a ring of task slots, with its own tasks taken from the back and stolen
+  /// ones from the front
+  struct Worker {
+    std::mutex mutex;
+    std::vector<Task> slots; /// Power of two size, guarded by mutex
+    size_t front{0}; /// Slot of the oldest task, guarded by mutex
+    size_t numTasks{0}; /// Guarded by mutex
+    std::thread thread;
+  };
+
+  /// Take a task from a worker's own queue, or steal one from another worker.
+  bool pop(size_t index, Task& task);
+  void workerLoop(size_t index);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic<size_t> next_{0};
+  std::atomic<size_t> numQueued_{0};
+  std::mutex sleepMutex_;
+  std::condition_variable sleepCondition_;
+  bool quit_{false};
+};
+} // namespace TBE
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/benchmark/Benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <thread>
+
+namespace TBE {
+namespace benchmark {
+namespace {
+const double kMinTimeNs = 50e6; /// Minimum duration of a repetition
+const double kQuickMinTimeNs = 1e6;
+const size_t kNumRepetitions = 5;
+const size_t kMaxIterations = size_t(1) << 30;
+
+const char* getArgument(const char* arg, const char* name) {
+  const size_t length = std::strlen(name);
+  return std::strncmp(arg, name, length) == 0 ? arg + length : nullptr;
+}
+
+std::string escape(const std::string& text) {
+  std::string escaped;
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+      escaped += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char code[8];
+      std::snprintf(code, sizeof(code), "\\u%04x", c);
+      escaped += code;
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+std::string toJson(const std::vector<Parameter>& parameters) {
+  std::string json = "{";
+  for (size_t i = 0; i < parameters.size(); ++i) {
+    json += (i > 0 ? ", \"" : "\"") + escape(parameters[i].first) + "\": \"" +
+        escape(parameters[i].second) + "\"";
+  }
+  return json + "}";
+}
+
+std::string toJson(double value) {
+  char text[32];
+  std::snprintf(text, sizeof(text), "%.6g", value);
+  return text;
+}
+} // namespace
+
+BenchmarkRunner::BenchmarkRunner(const char* suite, int argc, char** argv) : suite_(suite) {
+  for (int i = 1; i < argc; ++i) {
+    const char* value = nullptr;
+    if (std::strcmp(argv[i], "--quick") == 0) {
+      quick_ = true;
+    } else if ((value = getArgument(argv[i], "--filter=")) != nullptr) {
+      filter_ = value;
+    } else if ((value = getArgument(argv[i], "--output=")) != nullptr) {
+      outputPath_ = value;
+    } else {
+      std::fprintf(stderr, "Ignoring unknown argument %s\n", argv[i]);
+    }
+  }
+  const char* testOutputs = std::getenv("TEST_UNDECLARED_OUTPUTS_DIR");
+  if (outputPath_.empty() && testOutputs != nullptr) {
+    outputPath_ = std::string(testOutputs) + "/" + suite_ + ".json";
+  }
+
+  char date[32];
+  const std::time_t now = std::time(nullptr);
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+  addContext("date", date);
+  addContext("numCpus", std::to_string(std::thread::hardware_concurrency()));
+#ifdef NDEBUG
+  addContext("build", "release");
+#else
+  addContext("build", "debug");
+#endif
+  addContext("mode", quick_ ? "quick" : "full");
+}
+
+void BenchmarkRunner::addContext(const std::string& key, const std::string& value) {
+  context_.emplace_back(key, value);
+}
+
+double BenchmarkRunner::time(const Function& function, size_t numIterations) {
+  pausedNs_ = 0.0;
+  const Clock::time_point start = Clock::now();
+  function(numIterations);
+  const Clock::time_point end = Clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() - pausedNs_;
+}
+
+void BenchmarkRunner::pauseTiming() {
+  pauseStart_ = Clock::now();
+}
+
+void BenchmarkRunner::resumeTiming() {
+  pausedNs_ += std::chrono::duration<double, std::nano>(Clock::now() - pauseStart_).count();
+}
+
+bool BenchmarkRunner::matches(const std::string& name) const {
+  return filter_.empty() || name.find(filter_) != std::string::npos;
+}
+
+void BenchmarkRunner::run(
+    const std::string& name,
+    const std::vector<Parameter>& parameters,
+    double itemsPerIteration,
+    const Function& function) {
+  if (!matches(name)) {
+    return;
+  }
+  const double minTimeNs = quick_ ? kQuickMinTimeNs : kMinTimeNs;
+  const size_t numRepetitions = quick_ ? 1 : kNumRepetitions;
+
+  // Grow the number of iterations until a repetition takes long enough to time reliably. The
+  // first run also warms up the caches.
+  size_t iterations = 1;
+  double elapsed = time(function, iterations);
+  while (elapsed < minTimeNs && iterations < kMaxIterations) {
+    const double scale = elapsed > 0.0 ? 1.2 * minTimeNs / elapsed : 10.0;
+    const double growth = std::min(std::max(scale, 2.0), 10.0);
+    iterations = std::min(kMaxIterations, static_cast<size_t>(iterations * growth));
+    elapsed = time(function, iterations);
+  }
+
+  std::vector<double> nsPerIteration;
+  nsPerIteration.push_back(elapsed / iterations);
+  while (nsPerIteration.size() < numRepetitions) {
+    nsPerIteration.push_back(time(function, iterations) / iterations);
+  }
+  std::sort(nsPerIteration.begin(), nsPerIteration.end());
+
+  Result result;
+  result.name = name;
+  result.parameters = parameters;
+  result.iterations = iterations;
+  result.repetitions = nsPerIteration.size();
+  result.nsPerIterationMin = nsPerIteration.front();
+  result.nsPerIterationMedian = nsPerIteration[nsPerIteration.size() / 2];
+  result.itemsPerSecond = itemsPerIteration * 1e9 / result.nsPerIterationMedian;
+  results_.push_back(result);
+
+  std::string description = name;
+  for (const Parameter& parameter : parameters) {
+    description += " " + parameter.first + "=" + parameter.second;
+  }
+  std::fprintf(
+      stderr,
+      "%-64s %12.1f ns %14.4g items/s\n",
+      description.c_str(),
+      result.nsPerIterationMedian,
+      result.itemsPerSecond);
+}
+
+void BenchmarkRunner::fail(
+    const std::string& name,
+    const std::vector<Parameter>& parameters,
+    const char* error) {
+  if (!matches(name)) {
+    return;
+  }
+  Result result;
+  result.name = name;
+  result.parameters = parameters;
+  result.error = error;
+  results_.push_back(result);
+  std::fprintf(stderr, "%s failed: %s\n", name.c_str(), error);
+}
+
+std::string BenchmarkRunner::toJson() const {
+  std::string json = "{\n  \"suite\": \"" + escape(suite_) + "\",\n";
+  json += "  \"context\": " + benchmark::toJson(context_) + ",\n";
+  json += "  \"results\": [";
+  for (size_t i = 0; i < results_.size(); ++i) {
+    const Result& result = results_[i];
+    json += i > 0 ? ",\n    {" : "\n    {";
+    json += "\"name\": \"" + escape(result.name) + "\"";
+    json += ", \"parameters\": " + benchmark::toJson(result.parameters);
+    if (!result.error.empty()) {
+      json += ", \"error\": \"" + escape(result.error) + "\"}";
+      continue;
+    }
+    json += ", \"iterations\": " + std::to_string(result.iterations);
+    json += ", \"repetitions\": " + std::to_string(result.repetitions);
+    json += ", \"ns_per_iteration_min\": " + benchmark::toJson(result.nsPerIterationMin);
+    json += ", \"ns_per_iteration_median\": " + benchmark::toJson(result.nsPerIterationMedian);
+    json += ", \"items_per_second\": " + benchmark::toJson(result.itemsPerSecond) + "}";
+  }
+  return json + "\n  ]\n}\n";
+}
+
+int BenchmarkRunner::finish() {
+  const std::string json = toJson();
+  bool written = true;
+  if (outputPath_.empty()) {
+    written = std::fputs(json.c_str(), stdout) >= 0;
+  } else {
+    FILE* file = std::fopen(outputPath_.c_str(), "w");
+    written = file != nullptr && std::fputs(json.c_str(), file) >= 0;
+    written = file != nullptr && std::fclose(file) == 0 && written;
+    if (!written) {
+      std::fprintf(stderr, "Could not write %s\n", outputPath_.c_str());
+    }
+  }
+  const bool failed = std::any_of(
+      results_.begin(), results_.end(), [](const Result& result) { return !result.error.empty(); });
+  return written && !failed ? 0 : 1;
+}
+} // namespace benchmark
+} // namespace TBE
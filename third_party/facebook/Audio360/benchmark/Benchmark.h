@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace TBE {
+namespace benchmark {
+/// Keep the compiler from optimising away a value computed by a benchmark
+template <typename T>
+inline void doNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/// Named parameter of a benchmark case, such as the number of objects or the channel map
+typedef std::pair<std::string, std::string> Parameter;
+
+/// Times benchmark cases and writes their results as JSON, so that runs against different builds
+/// or library drops can be compared by a script. Each case is a function that runs a given number
+/// of iterations; it is calibrated to run for a minimum time, then repeated and the median kept.
+///
+/// Command line:
+///   --quick         One short repetition per case, for smoke testing under bazel test
+///   --filter=text   Only run the cases whose name contains text
+///   --output=path   Write the JSON to path instead of stdout. Under bazel test, the results go
+///                   to TEST_UNDECLARED_OUTPUTS_DIR by default.
+class BenchmarkRunner {
+ public:
+  typedef std::function<void(size_t numIterations)> Function;
+
+  BenchmarkRunner(const char* suite, int argc, char** argv);
+
+  /// \return True if --quick was passed
+  bool isQuick() const {
+    return quick_;
+  }
+
+  /// Add a key and value to the context of the results, such as the engine version
+  void addContext(const std::string& key, const std::string& value);
+
+  /// Time a case.
+  /// \param name Name of the case
+  /// \param parameters Parameters of the case, written with the results
+  /// \param itemsPerIteration Number of items, such as frames or samples, processed by an
+  /// iteration. Used for the throughput.
+  /// \param function Runs the given number of iterations
+  void run(
+      const std::string& name,
+      const std::vector<Parameter>& parameters,
+      double itemsPerIteration,
+      const Function& function);
+
+  /// Exclude the time from here to resumeTiming() from the current case, such as the time spent
+  /// draining a queue that the case fills
+  void pauseTiming();
+  void resumeTiming();
+
+  /// Record a case that could not run, such as an engine that failed to initialise
+  void fail(const std::string& name, const std::vector<Parameter>& parameters, const char* error);
+
+  /// Write the results.
+  /// \return Exit code of the benchmark: 0, or 1 if a case failed or the results were not written
+  int finish();
+
+ private:
+  struct Result {
+    std::string name;
+    std::vector<Parameter> parameters;
+    size_t iterations{0}; /// Per repetition
+    size_t repetitions{0};
+    double nsPerIterationMin{0.0};
+    double nsPerIterationMedian{0.0};
+    double itemsPerSecond{0.0}; /// From the median
+    std::string error; /// Empty if the case ran
+  };
+
+  typedef std::chrono::steady_clock Clock;
+
+  /// \return Time taken by the given number of iterations, in nanoseconds, less the paused time
+  double time(const Function& function, size_t numIterations);
+
+  bool matches(const std::string& name) const;
+  std::string toJson() const;
+
+  const std::string suite_;
+  bool quick_{false};
+  std::string filter_;
+  std::string outputPath_;
+  std::vector<Parameter> context_;
+  std::vector<Result> results_;
+  Clock::time_point pauseStart_;
+  double pausedNs_{0.0};
+};
+} // namespace benchmark
+} // namespace TBE
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/benchmark/Benchmark.h"
+#include "third_party/facebook/Audio360/include/TBE_Quat.hh"
+#include "third_party/facebook/Audio360/include/TBE_SpatialBatch.hh"
+
+#include <random>
+
+using namespace TBE;
+using namespace TBE::benchmark;
+
+namespace {
+/// Numbers of sources processed per iteration, to show how the math scales with the scene
+const size_t kCounts[] = {1, 16, 256, 4096};
+const size_t kMaxCount = 4096;
+
+struct Inputs {
+  std::vector<TBQuat> quats;
+  std::vector<TBVector> forwards;
+  std::vector<TBVector> ups;
+  std::vector<TBVector> positions;
+  std::vector<float> x, y, z; /// positions as structure of arrays
+};
+
+/// Random rotations and source positions within 50 metres. Seeded so that every run times the
+/// same data.
+Inputs makeInputs() {
+  std::mt19937 generator(1234);
+  std::uniform_real_distribution<float> angle(-3.14159265f, 3.14159265f);
+  std::uniform_real_distribution<float> coordinate(-50.f, 50.f);
+
+  Inputs inputs;
+  for (size_t i = 0; i < kMaxCount; ++i) {
+    const TBQuat quat =
+        TBQuat::getQuatFromEulerAngles(angle(generator), angle(generator), angle(generator));
+    const TBVector position(coordinate(generator), coordinate(generator), coordinate(generator));
+    inputs.quats.push_back(quat);
+    inputs.forwards.push_back(TBQuat::getForwardFromQuat(quat));
+    inputs.ups.push_back(TBQuat::getUpFromQuat(quat));
+    inputs.positions.push_back(position);
+    inputs.x.push_back(position.x);
+    inputs.y.push_back(position.y);
+    inputs.z.push_back(position.z);
+  }
+  return inputs;
+}
+
+std::vector<Parameter> countParameter(size_t count) {
+  return {Parameter("count", std::to_string(count))};
+}
+} // namespace
+
+int main(int argc, char** argv) {
+  BenchmarkRunner runner("math", argc, argv);
+  const Inputs in = makeInputs();
+  const TBQuat listener = in.quats[0];
+  const TBVector listenerPosition(1.f, 2.f, 3.f);
+  std::vector<float> azimuth(kMaxCount), elevation(kMaxCount), distance(kMaxCount);
+  std::vector<float> gain(kMaxCount);
+
+  for (const size_t count : kCounts) {
+    runner.run("rotateVectorByQuat", countParameter(count), count, [&](size_t numIterations) {
+      for (size_t n = 0; n < numIterations; ++n) {
+        for (size_t i = 0; i < count; ++i) {
+          doNotOptimize(TBQuat::rotateVectorByQuat(in.quats[i], in.positions[i]));
+        }
+      }
+    });
+
+    runner.run("antiRotateVectorByQuat", countParameter(count), count, [&](size_t numIterations) {
+      for (size_t n = 0; n < numIterations; ++n) {
+        for (size_t i = 0; i < count; ++i) {
+          doNotOptimize(TBQuat::antiRotateVectorByQuat(in.quats[i], in.positions[i]));
+        }
+      }
+    });
+
+    runner.run("getAedFromQuat", countParameter(count), count, [&](size_t numIterations) {
+      for (size_t n = 0; n < numIterations; ++n) {
+        for (size_t i = 0; i < count; ++i) {
+          doNotOptimize(TBQuat::getAedFromQuat(listener, listenerPosition, in.positions[i]));
+        }
+      }
+    });
+
+    runner.run(
+        "getQuatFromForwardAndUpVectors", countParameter(count), count, [&](size_t numIterations) {
+          for (size_t n = 0; n < numIterations; ++n) {
+            for (size_t i = 0; i < count; ++i) {
+              doNotOptimize(TBQuat::getQuatFromForwardAndUpVectors(in.forwards[i], in.ups[i]));
+            }
+          }
+        });
+
+    runner.run("slerp", countParameter(count), count, [&](size_t numIterations) {
+      for (size_t n = 0; n < numIterations; ++n) {
+        for (size_t i = 0; i < count; ++i) {
+          doNotOptimize(TBQuat::slerp(listener, in.quats[i], 0.3f));
+        }
+      }
+    });
+
+    runner.run(
+        "TBSpatialBatch::getAedFromQuat", countParameter(count), count, [&](size_t numIterations) {
+          for (size_t n = 0; n < numIterations; ++n) {
+            TBSpatialBatch::getAedFromQuat(
+                listener,
+                listenerPosition,
+                in.x.data(),
+                in.y.data(),
+                in.z.data(),
+                count,
+                azimuth.data(),
+                elevation.data(),
+                distance.data());
+            doNotOptimize(azimuth[count - 1]);
+          }
+        });
+
+    runner.run(
+        "TBSpatialBatch::getAedAndAttenuationGain",
+        countParameter(count),
+        count,
+        [&](size_t numIterations) {
+          for (size_t n = 0; n < numIterations; ++n) {
+            TBSpatialBatch::getAedAndAttenuationGain(
+                listener,
+                listenerPosition,
+                in.x.data(),
+                in.y.data(),
+                in.z.data(),
+                count,
+                AttenuationMode::LOGARITHMIC,
+                AttenuationProps(),
+                azimuth.data(),
+                elevation.data(),
+                distance.data(),
+                gain.data());
+            doNotOptimize(gain[count - 1]);
+          }
+        });
+  }
+  return runner.finish();
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/benchmark/Benchmark.h"
+#include "third_party/facebook/Audio360/include/TBE_AudioEngine.h"
+#include "third_party/facebook/Audio360/include/TBE_AudioObject.h"
+
+#include <cmath>
+#include <random>
+
+using namespace TBE;
+using namespace TBE::benchmark;
+
+namespace {
+const int32_t kBufferSizes[] = {256, 512, 1024};
+const int32_t kObjectCounts[] = {1, 16, 64, 128};
+const int32_t kMaxObjects = 128;
+const size_t kToneLength = 4096; /// Samples in the table played by the objects
+
+struct ChannelMapCase {
+  ChannelMap map;
+  const char* name;
+};
+
+/// The channel maps that the queue accepts
+const ChannelMapCase kChannelMaps[] = {
+    {ChannelMap::HEADLOCKED_STEREO, "HEADLOCKED_STEREO"},
+    {ChannelMap::AMBIX_4, "AMBIX_4"},
+    {ChannelMap::AMBIX_9, "AMBIX_9"},
+    {ChannelMap::AMBIX_9_2, "AMBIX_9_2"},
+};
+
+/// Mono tone played by every object, each from its own offset
+struct Tone {
+  std::vector<float> samples;
+  size_t position{0};
+};
+
+void fillFromTone(float* channelBuffer, size_t numSamples, size_t, void* userData) {
+  Tone& tone = *static_cast<Tone*>(userData);
+  for (size_t i = 0; i < numSamples; ++i) {
+    channelBuffer[i] = tone.samples[tone.position];
+    tone.position = (tone.position + 1) % tone.samples.size();
+  }
+}
+
+EngineError createEngine(AudioEngine*& engine, int32_t bufferSize) {
+  EngineInitSettings settings;
+  settings.audioSettings.deviceType = AudioDeviceType::DISABLED;
+  settings.audioSettings.bufferSize = bufferSize;
+  settings.memorySettings.audioObjectPoolSize = kMaxObjects;
+  settings.threads.useDecoderThread = false;
+  settings.threads.useEventThread = false;
+  return TBE_CreateAudioEngine(engine, settings);
+}
+
+std::string getVersion(const AudioEngine& engine) {
+  return std::to_string(engine.getVersionMajor()) + "." +
+      std::to_string(engine.getVersionMinor()) + "." + std::to_string(engine.getVersionPatch());
+}
+
+/// Spatialised objects fed by buffer callbacks, spread around the listener
+void runObjects(BenchmarkRunner& runner, int32_t bufferSize, int32_t numObjects) {
+  const std::vector<Parameter> parameters = {
+      Parameter("source", "audioObject"),
+      Parameter("numObjects", std::to_string(numObjects)),
+      Parameter("bufferSize", std::to_string(bufferSize)),
+  };
+  AudioEngine* engine = nullptr;
+  if (createEngine(engine, bufferSize) != EngineError::OK) {
+    runner.fail("getAudioMix", parameters, "could not create the engine");
+    return;
+  }
+
+  std::mt19937 generator(1234);
+  std::uniform_real_distribution<float> coordinate(-10.f, 10.f);
+  std::vector<Tone> tones(numObjects);
+  std::vector<AudioObject*> objects(numObjects, nullptr);
+  for (int32_t i = 0; i < numObjects; ++i) {
+    for (size_t k = 0; k < kToneLength; ++k) {
+      tones[i].samples.push_back(0.1f * std::sin(0.02f * (i + 1) * k));
+    }
+    if (engine->createAudioObject(objects[i]) != EngineError::OK) {
+      runner.fail("getAudioMix", parameters, "could not create the audio objects");
+      TBE_DestroyAudioEngine(engine);
+      return;
+    }
+    objects[i]->setAudioBufferCallback(fillFromTone, 1, &tones[i]);
+    objects[i]->setPosition(TBVector(coordinate(generator), coordinate(generator), 1.f));
+    objects[i]->play();
+  }
+
+  std::vector<float> mix(bufferSize * 2);
+  runner.run("getAudioMix", parameters, bufferSize, [&](size_t numIterations) {
+    for (size_t n = 0; n < numIterations; ++n) {
+      engine->getAudioMix(mix.data(), static_cast<int>(mix.size()), 2);
+      doNotOptimize(mix[0]);
+    }
+  });
+
+  for (AudioObject*& object : objects) {
+    engine->destroyAudioObject(object);
+  }
+  TBE_DestroyAudioEngine(engine);
+}
+
+/// A queue of ambisonic or head-locked audio, topped up outside the timed section before each mix
+void runQueue(BenchmarkRunner& runner, int32_t bufferSize, const ChannelMapCase& map) {
+  const std::vector<Parameter> parameters = {
+      Parameter("source", "spatDecoderQueue"),
+      Parameter("channelMap", map.name),
+      Parameter("bufferSize", std::to_string(bufferSize)),
+  };
+  AudioEngine* engine = nullptr;
+  SpatDecoderQueue* queue = nullptr;
+  if (createEngine(engine, bufferSize) != EngineError::OK) {
+    runner.fail("getAudioMix", parameters, "could not create the engine");
+    return;
+  }
+  if (engine->createSpatDecoderQueue(queue) != EngineError::OK) {
+    runner.fail("getAudioMix", parameters, "could not create the queue");
+    TBE_DestroyAudioEngine(engine);
+    return;
+  }
+  queue->play();
+
+  const int32_t numSamples = bufferSize * getNumChannelsForMap(map.map);
+  std::vector<float> data(numSamples);
+  for (int32_t i = 0; i < numSamples; ++i) {
+    data[i] = 0.1f * std::sin(0.01f * i);
+  }
+  std::vector<float> mix(bufferSize * 2);
+  runner.run("getAudioMix", parameters, bufferSize, [&](size_t numIterations) {
+    for (size_t n = 0; n < numIterations; ++n) {
+      runner.pauseTiming();
+      if (queue->getFreeSpaceInQueue(map.map) >= numSamples) {
+        queue->enqueueData(data.data(), numSamples, map.map);
+      }
+      runner.resumeTiming();
+      engine->getAudioMix(mix.data(), static_cast<int>(mix.size()), 2);
+      doNotOptimize(mix[0]);
+    }
+  });
+
+  engine->destroySpatDecoderQueue(queue);
+  TBE_DestroyAudioEngine(engine);
+}
+} // namespace
+
+int main(int argc, char** argv) {
+  BenchmarkRunner runner("mix", argc, argv);
+  AudioEngine* engine = nullptr;
+  if (createEngine(engine, kBufferSizes[0]) == EngineError::OK) {
+    runner.addContext("engineVersion", getVersion(*engine));
+    TBE_DestroyAudioEngine(engine);
+  }
+
+  for (const int32_t bufferSize : kBufferSizes) {
+    for (const int32_t numObjects : kObjectCounts) {
+      runObjects(runner, bufferSize, numObjects);
+    }
+    for (const ChannelMapCase& map : kChannelMaps) {
+      runQueue(runner, bufferSize, map);
+    }
+  }
+  return runner.finish();
+}
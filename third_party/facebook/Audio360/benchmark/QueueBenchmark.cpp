@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/benchmark/Benchmark.h"
+#include "third_party/facebook/Audio360/include/TBE_AudioEngine.h"
+
+#include <cmath>
+
+using namespace TBE;
+using namespace TBE::benchmark;
+
+namespace {
+const int32_t kBufferSize = 1024;
+const int32_t kChunkSizes[] = {256, 1024}; /// Frames per call to enqueueData
+
+struct ChannelMapCase {
+  ChannelMap map;
+  const char* name;
+};
+
+/// The channel maps that the queue accepts
+const ChannelMapCase kChannelMaps[] = {
+    {ChannelMap::HEADLOCKED_STEREO, "HEADLOCKED_STEREO"},
+    {ChannelMap::AMBIX_4, "AMBIX_4"},
+    {ChannelMap::AMBIX_9, "AMBIX_9"},
+    {ChannelMap::AMBIX_9_2, "AMBIX_9_2"},
+};
+
+/// Render the queue's data until a chunk fits, so that every enqueueData call writes a full chunk
+void drain(AudioEngine& engine, SpatDecoderQueue& queue, ChannelMap map, int32_t numSamples) {
+  std::vector<float> mix(kBufferSize * 2);
+  while (queue.getFreeSpaceInQueue(map) < numSamples) {
+    engine.getAudioMix(mix.data(), static_cast<int>(mix.size()), 2);
+  }
+}
+
+template <typename T>
+void runEnqueue(
+    BenchmarkRunner& runner,
+    AudioEngine& engine,
+    SpatDecoderQueue& queue,
+    const ChannelMapCase& map,
+    int32_t chunkSize,
+    const char* format,
+    const std::vector<T>& data) {
+  const int32_t numSamples = chunkSize * getNumChannelsForMap(map.map);
+  const std::vector<Parameter> parameters = {
+      Parameter("channelMap", map.name),
+      Parameter("format", format),
+      Parameter("chunkFrames", std::to_string(chunkSize)),
+  };
+  queue.flushQueue();
+  drain(engine, queue, map.map, queue.getQueueSize(map.map));
+  if (queue.enqueueData(data.data(), numSamples, map.map) != numSamples) {
+    runner.fail("enqueueData", parameters, "the queue did not accept a full chunk");
+    return;
+  }
+  runner.run("enqueueData", parameters, chunkSize, [&](size_t numIterations) {
+    for (size_t n = 0; n < numIterations; ++n) {
+      if (queue.getFreeSpaceInQueue(map.map) < numSamples) {
+        runner.pauseTiming();
+        drain(engine, queue, map.map, numSamples);
+        runner.resumeTiming();
+      }
+      doNotOptimize(queue.enqueueData(data.data(), numSamples, map.map));
+    }
+  });
+}
+} // namespace
+
+int main(int argc, char** argv) {
+  BenchmarkRunner runner("queue", argc, argv);
+
+  EngineInitSettings settings;
+  settings.audioSettings.deviceType = AudioDeviceType::DISABLED;
+  settings.audioSettings.bufferSize = kBufferSize;
+  settings.threads.useDecoderThread = false;
+  settings.threads.useEventThread = false;
+  AudioEngine* engine = nullptr;
+  SpatDecoderQueue* queue = nullptr;
+  if (TBE_CreateAudioEngine(engine, settings) != EngineError::OK) {
+    runner.fail("enqueueData", {}, "could not create the engine");
+    return runner.finish();
+  }
+  runner.addContext(
+      "engineVersion",
+      std::to_string(engine->getVersionMajor()) + "." + std::to_string(engine->getVersionMinor()) +
+          "." + std::to_string(engine->getVersionPatch()));
+  if (engine->createSpatDecoderQueue(queue) != EngineError::OK) {
+    runner.fail("enqueueData", {}, "could not create the queue");
+    TBE_DestroyAudioEngine(engine);
+    return runner.finish();
+  }
+  queue->play();
+
+  // One chunk of the largest size and channel count, as a quiet sine
+  const size_t maxSamples = kChunkSizes[1] * getNumChannelsForMap(ChannelMap::AMBIX_9_2);
+  std::vector<float> floatData(maxSamples);
+  std::vector<int16_t> int16Data(maxSamples);
+  for (size_t i = 0; i < maxSamples; ++i) {
+    floatData[i] = 0.25f * std::sin(0.01f * i);
+    int16Data[i] = static_cast<int16_t>(floatData[i] * 32767.f);
+  }
+
+  for (const ChannelMapCase& map : kChannelMaps) {
+    for (const int32_t chunkSize : kChunkSizes) {
+      runEnqueue(runner, *engine, *queue, map, chunkSize, "float", floatData);
+      runEnqueue(runner, *engine, *queue, map, chunkSize, "int16", int16Data);
+    }
+  }
+
+  engine->destroySpatDecoderQueue(queue);
+  TBE_DestroyAudioEngine(engine);
+  return runner.finish();
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+/**
+ * @file TBE_AssetBank.h
+ * Packed banks of audio assets, looked up by name
+ */
+
+#pragma once
+
+#include "TBE_AudioEngineDefinitions.h"
+#include "TBE_IOStream.h"
+
+namespace TBE {
+class AudioFormatDecoder;
+
+/// Asset banks pack many encoded assets into one file, with an index at the start that maps the
+/// name of each asset to its location, codec and channel count. A bank is memory mapped once when
+/// it is opened. Assets are then found without touching the file system and read straight from
+/// the mapping, which suits large numbers of short one-shot sounds. Play an asset with
+/// AudioObjectExtensions::open or SpatDecoderFileExtensions::open (TBE_AudioEngineExtensions.h).
+/// Banks are written with the make_asset_bank tool, or with tools/AssetBankWriter.h.
+///
+/// File layout, all integers little endian:
+/// - Header, kAssetBankHeaderSize bytes:
+///   - char[4] magic, "TBEB"
+///   - uint32 version, kAssetBankVersion
+///   - uint32 number of assets
+///   - uint32 reserved, 0
+/// - Index, one entry of kAssetBankEntrySize bytes per asset, sorted by name in strcmp order:
+///   - char[kAssetBankNameSize] name, NUL terminated
+///   - uint64 offset of the asset from the start of the file, in bytes
+///   - uint64 length of the asset in bytes
+///   - uint32 codec, an AssetCodec value
+///   - uint32 number of channels, 0 if unknown
+///   - uint64 reserved, 0
+/// - Asset data, anywhere after the index
+const uint32_t kAssetBankVersion = 1;
+const size_t kAssetBankHeaderSize = 16;
+const size_t kAssetBankEntrySize = 96;
+const size_t kAssetBankNameSize = 64;
+
+/// An asset in an AssetBank
+struct AssetBankEntry {
+  const char* name{nullptr}; /// Name of the asset. Valid for the lifetime of the bank.
+  AssetDescriptor descriptor; /// Location of the asset within the bank file
+  AssetCodec codec{AssetCodec::WAV}; /// Codec of the asset
+  int32_t numChannels{0}; /// Number of channels of the asset, 0 if unknown
+};
+
+/// A memory mapped asset bank. Create with TBE_CreateAssetBank. The object can be de-allocated
+/// with delete. Thread safe.
+class AssetBank {
+ public:
+  virtual ~AssetBank() {}
+
+  /// \return The number of assets in the bank
+  virtual size_t getNumAssets() const = 0;
+
+  /// Get an asset by index, in name order. Useful to list the contents of a bank.
+  /// \param index Index of the asset, from 0 to getNumAssets() - 1
+  /// \param entry Filled in with the asset
+  /// \return EngineError::OK or EngineError::NO_ASSET if the index is out of range
+  virtual EngineError getAsset(size_t index, AssetBankEntry& entry) const = 0;
+
+  /// Find an asset by name.
+  /// \param name Name of the asset
+  /// \param entry Filled in with the asset
+  /// \return EngineError::OK or EngineError::NO_ASSET if there is no asset with this name
+  virtual EngineError findAsset(const char* name, AssetBankEntry& entry) const = 0;
+
+  /// Open an asset as a stream that reads from the bank's memory mapping. The stream supports
+  /// zero-copy reads through IOStream::getReadPointer(). It keeps the mapping alive, so it can
+  /// outlive the bank. The stream can be de-allocated with delete, or handed to an object that
+  /// takes ownership of it such as SpatDecoderFile::open(streams, true, map).
+  /// \param name Name of the asset
+  /// \param stream Filled in with the stream
+  /// \return EngineError::OK or EngineError::NO_ASSET if there is no asset with this name
+  virtual EngineError openStream(const char* name, IOStream*& stream) = 0;
+
+  /// Create a decoder for an asset, as TBE_CreateAudioFormatDecoder would for a file. The header of
+  /// a WAV asset is parsed the first time the asset is opened and kept by the bank, so later opens
+  /// of the asset go straight to its audio. AudioObjectExtensions::open and
+  /// SpatDecoderFileExtensions::open play assets through this method. The decoder can be
+  /// de-allocated with delete and keeps the mapping alive, so it can outlive the bank.
+  /// \param decoder Filled in with the decoder on success
+  /// \param name Name of the asset
+  /// \param maxBufferSizePerChannel Maximum number of samples per channel requested by decode(..)
+  /// \param outputSampleRate Output sample rate. 0 disables resampling.
+  /// \return EngineError::OK, EngineError::NO_ASSET if there is no asset with this name, or the
+  /// error from creating the decoder
+  virtual EngineError createDecoder(
+      AudioFormatDecoder*& decoder,
+      const char* name,
+      int32_t maxBufferSizePerChannel,
+      float outputSampleRate) = 0;
+};
+} // namespace TBE
+
+extern "C" {
+
+/// Open an asset bank. The file is memory mapped and its index checked, the assets are read when
+/// they are played. \see TBE::AssetBank for the file format.
+/// \param bank Filled in with the bank
+/// \param nameAndPath Absolute path to the bank file
+/// \return EngineError::OK, EngineError::ERROR_OPENING_FILE, EngineError::MEMORY_MAP_FAIL if the
+/// file cannot be mapped or EngineError::INVALID_HEADER if the header or index is malformed
+API_EXPORT TBE::EngineError TBE_CreateAssetBank(TBE::AssetBank*& bank, const char* nameAndPath);
+}
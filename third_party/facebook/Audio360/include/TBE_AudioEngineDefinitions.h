@@ -86,6 +86,8 @@ enum class AttenuationType {
 };
 
 enum class EngineError {
+  INVALID_SETTINGS = -23,
+  INVALID_BUFFER = -22,
   QUEUE_FULL = -21,
   BAD_THREAD = -20,
   NOT_SUPPORTED = -19,
@@ -203,6 +205,29 @@ struct AssetDescriptor {
   AssetDescriptor(size_t offset, size_t length) : offsetInBytes(offset), lengthInBytes(length) {}
 };
 
+/// Codec of an encoded asset. The values are stored in asset banks and must not change.
+enum class AssetCodec {
+  WAV = 0, /// PCM or IEEE float WAV, including broadcast WAV
+  OPUS = 1, /// Opus file
+  TBE = 2, /// TBE container
+};
+
+enum class SampleFormat {
+  FLOAT, /// 32 bit float samples in the range -1 to 1
+  INT16 /// 16 bit int samples
+};
+
+/// Space in a queue that audio can be decoded or converted into directly, instead of being copied
+/// in from a separate buffer. \see SpatDecoderQueueExtensions::acquireWrite,
+/// SpeakersVirtualizerExtensions::acquireWrite. The space can wrap around the end of the queue, in
+/// which case it is split in two parts: the first numFrames[0] frames go to data[0] and the rest
+/// to data[1]. Frames are interleaved with numChannels samples each.
+struct QueueWriteRegion {
+  float* data[2]{nullptr, nullptr}; /// Start of each part
+  int32_t numFrames[2]{0, 0}; /// Number of frames in each part
+  int32_t numChannels{0}; /// Number of channels in each frame
+};
+
 enum class AudioDeviceType {
   DEFAULT, /// Use the system's default audio device
   CUSTOM, /// Specify a custom audio device
@@ -262,12 +287,28 @@ struct ThreadSettings {
              /// SpatDecoderFile, except it is applied globally for all objects and jobs.
 };
 
+/// Settings added after the prebuilt Android libraries, which ignore them. They are only
+/// implemented on the default platform. New settings are added at the end.
+struct ExtensionSettings {
+  size_t pcmCacheSizeInBytes{0}; /// Memory budget of the cache of decoded audio shared by audio
+                                 /// objects that play the same asset. 0 disables the cache.
+  int32_t numCacheThreads{0}; /// Number of threads that decode assets into the PCM cache. If 0,
+                              /// one per processor core. Unused if the cache is disabled.
+  int32_t maxActiveVoices{0}; /// Maximum number of playing audio objects rendered each block. The
+                              /// others are culled by priority and estimated loudness: they keep
+                              /// time without decoding or rendering, and fade back in when they
+                              /// make the cut again. Inaudible objects are always culled, objects
+                              /// fed by a buffer callback never are. 0 renders every audible
+                              /// object. \see AudioObjectExtensions::setPriority
+};
+
 struct EngineInitSettings {
   AudioSettings audioSettings;
   MemorySettings memorySettings;
   PlatformSettings platformSettings;
   ThreadSettings threads;
   Experimental experimental;
+  ExtensionSettings extensions; /// Must stay the last member, see ExtensionSettings
 };
 
 //--------- FUNC PTRS / CALLBACKS --------------//
@@ -335,6 +376,66 @@ struct LoudnessStatistics {
   float truePeak{(float)-INFINITY};
 };
 
+/// Number of buckets of the histograms in DSPStageStatistics
+const int32_t kNumDSPHistogramBuckets = 16;
+
+/// Number of blocks kept in the DSP trace, see AudioEngineExtensions::getDSPTrace
+const int32_t kDSPTraceSize = 256;
+
+/// Timing of one stage of rendering
+struct DSPStageStatistics {
+  uint64_t numBlocks{0}; /// Number of blocks timed
+  double totalMs{0.0}; /// Total time spent in the stage
+  double maxMs{0.0}; /// Longest time spent in the stage in one block
+  uint64_t histogram[kNumDSPHistogramBuckets]{}; /// Number of blocks by time spent in the stage.
+                                                 /// Bucket i counts times of 2^i to 2^(i+1)
+                                                 /// microseconds; the first bucket also counts
+                                                 /// shorter times and the last longer ones.
+};
+
+/// Performance statistics of the engine, see AudioEngineExtensions::getDSPStatistics
+struct DSPStatistics {
+  DSPStageStatistics decode; /// Decoding in the audio callback, by objects that decode there
+  DSPStageStatistics spatialise; /// Rendering of each source into the mix
+  DSPStageStatistics mix; /// Summing buffer and processing of the mix: test tone, loudness, mix
+                          /// callback and output
+  DSPStageStatistics block; /// Whole block, including the spatial parameters and voice culling
+                            /// that come before the other stages
+  DSPStageStatistics decoderThread; /// Each pass of the decoder thread over the objects
+  uint64_t numOverruns{0}; /// Blocks that took longer to render than their duration
+  uint64_t numStarvations{0}; /// Times an object ran out of audio. See
+                              /// Event::ERROR_QUEUE_STARVATION.
+  int32_t numVoices{0}; /// Objects rendered in the last block, whether or not they are playing.
+                        /// Culled objects are counted in numVirtualVoices instead.
+  int32_t numActiveVoices{0}; /// Objects that rendered audio in the last block
+  int32_t decoderBacklog{0}; /// Playing objects in the last block that are decoded on the decoder
+                             /// thread and whose streaming buffer was less than half full
+  int32_t numVirtualVoices{0}; /// Objects culled in the last block, see
+                               /// ExtensionSettings::maxActiveVoices
+};
+
+/// Buffer level and starvation count of an object, see
+/// SpatDecoderExtensions::getSourceStatistics
+struct SourceStatistics {
+  int32_t numBufferedFrames{0}; /// Frames buffered ahead of playback after the last block. For a
+                                /// SpatDecoderQueue, those of its emptiest queue in use.
+  int32_t bufferSizeFrames{0}; /// Size of the buffer in frames
+  uint32_t numStarvations{0}; /// Times the object ran out of audio since it was created
+  bool active{false}; /// If the object rendered audio in the last block
+};
+
+/// Timing of one block, see AudioEngineExtensions::getDSPTrace
+struct DSPTraceEntry {
+  int64_t dspTime{0}; /// DSP time at the start of the block, in samples
+  int32_t numFrames{0}; /// Number of frames in the block
+  int32_t numActiveVoices{0}; /// Objects that rendered audio
+  int32_t decoderBacklog{0}; /// See DSPStatistics::decoderBacklog
+  float decodeMs{0.f}; /// Time spent decoding in the audio callback
+  float spatialiseMs{0.f}; /// Time spent rendering the sources
+  float mixMs{0.f}; /// Time spent clearing and processing the mix
+  float blockMs{0.f}; /// Time spent on the whole block
+};
+
 //--------- DEFAULT VALUES --------------//
 
 static const AudioSettings AudioSettings_default = AudioSettings();
@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+/**
+ * @file TBE_AudioEngineExtensions.h
+ * Methods added to the engine's objects after the prebuilt libraries
+ */
+
+#pragma once
+
+#include "TBE_AssetBank.h"
+#include "TBE_AudioEngine.h"
+#include "TBE_AudioObject.h"
+
+namespace TBE {
+/// Pose of the listener sampled by a head tracker, see AudioEngineExtensions::pushListenerPose
+struct ListenerPose {
+  TBQuat rotation{TBQuat::identity()}; /// Rotation of the listener
+  TBVector position; /// Position of the listener
+  int64_t dspTime{0}; /// Time at which the pose applies on the DSP clock, in samples. See
+                      /// AudioEngine::getDSPTime.
+};
+
+/// How the engine renders the listener poses queued with AudioEngineExtensions::pushListenerPose
+struct ListenerPoseSettings {
+  bool enabled{false}; /// Render the listener from the queued poses. setListenerRotation() and
+                       /// setListenerPosition() are ignored while enabled.
+  float predictionMs{0.f}; /// How far past the newest pose the listener's motion is extrapolated,
+                           /// when poses arrive late. 0 holds the newest pose.
+  int32_t subBlockSize{0}; /// Number of frames rendered per pose update. Smaller sub-blocks follow
+                           /// fast head motion more closely at some CPU cost. 0 updates the pose
+                           /// once per buffer.
+};
+
+/// The prebuilt Android libraries are built against the original layout of AudioEngine,
+/// AudioObject and the other objects, so methods cannot be added to those classes without
+/// breaking their vtables. Newer methods live in these extension interfaces instead. An object's
+/// extensions are reached with the TBE_Get...Extensions() functions below, which only the default
+/// platform implements: using them against the prebuilt libraries fails to link. Newer settings
+/// are in EngineInitSettings::extensions.
+
+/// Extensions of AudioEngine. \see TBE_GetAudioEngineExtensions
+class AudioEngineExtensions {
+ public:
+  /// Start decoding an asset into the PCM cache in the background, so that audio objects that
+  /// open it later play it without decoding it. Many assets can be preloaded at once: they are
+  /// decoded in parallel by ExtensionSettings::numCacheThreads threads. The cache is enabled with
+  /// ExtensionSettings::pcmCacheSizeInBytes. An asset whose decoding fails or ends early is
+  /// dropped from the cache, so that the next preload or open of the asset decodes it again.
+  /// \param nameAndPath Absolute path to the asset
+  /// \param ad Location of the asset within the file. Assets are cached by path and descriptor.
+  /// \return EngineError::OK if the asset is cached or being decoded, EngineError::NOT_SUPPORTED if
+  /// the cache is disabled, EngineError::CANNOT_ALLOCATE_MEMORY if the asset does not fit in the
+  /// cache, the error from opening the asset, or EngineError::FAIL if the last decoding of the
+  /// asset failed. A failure is returned once, and the asset is not queued by that call.
+  virtual EngineError preloadAsset(
+      const char* nameAndPath,
+      AssetDescriptor ad = AssetDescriptor()) = 0;
+
+  /// Returns the performance statistics of rendering since initialisation or the last call to
+  /// resetDSPStatistics(): how long decoding, spatialisation and mixing take per block, blocks that
+  /// took longer than real time, starvation and the number of voices. Gathered without locks or
+  /// allocations on the audio thread and updated after every block. Lock-free, can be called from
+  /// any thread.
+  virtual DSPStatistics getDSPStatistics() const = 0;
+
+  /// Reset the DSP statistics. Takes effect on the next block. Thread safe.
+  virtual void resetDSPStatistics() = 0;
+
+  /// Record the timing of every block in a ring of the last kDSPTraceSize blocks. Default state:
+  /// disabled. Thread safe.
+  virtual void enableDSPTrace(bool enabled = true) = 0;
+
+  /// Copy the most recent blocks of the DSP trace, oldest first. Lock-free, can be called from any
+  /// thread. A block being recorded during the call may be skipped.
+  /// \param entries Array to fill in
+  /// \param maxEntries Size of the array
+  /// \return Number of entries filled in
+  virtual size_t getDSPTrace(DSPTraceEntry* entries, size_t maxEntries) const = 0;
+
+  /// Set how the listener poses queued with pushListenerPose() are rendered. Thread safe.
+  /// \param settings Pose settings
+  /// \return EngineError::OK or EngineError::INVALID_BUFFER_SIZE if the sub-block size is negative
+  virtual EngineError setListenerPoseSettings(ListenerPoseSettings settings) = 0;
+
+  /// \return The settings set with setListenerPoseSettings()
+  virtual ListenerPoseSettings getListenerPoseSettings() const = 0;
+
+  /// Queue a timestamped pose from a head tracker, for trackers that run faster than the audio
+  /// buffers. The engine evaluates the pose at the end of every sub-block, interpolating between
+  /// the queued poses (slerp for the rotation) and extrapolating past the newest one. Thread safe.
+  /// The audio thread takes poses from a lock-free queue and never waits on callers. Callers are
+  /// serialised by a lock, on purpose: the order check and the push must happen together for poses
+  /// to reach the audio thread in order, and a tracker usually has a single thread to push from.
+  /// \param pose Pose of the listener. Poses must be queued in increasing order of DSP time.
+  /// \return EngineError::OK, EngineError::NOT_SUPPORTED if poses are disabled,
+  /// EngineError::QUEUE_FULL if the poses are not being rendered or EngineError::FAIL if the pose
+  /// is not later than the previous one
+  virtual EngineError pushListenerPose(const ListenerPose& pose) = 0;
+
+ protected:
+  virtual ~AudioEngineExtensions() {}
+};
+
+/// Extensions common to SpatDecoderQueue, SpatDecoderFile and AudioObject
+class SpatDecoderExtensions {
+ public:
+  /// \return Buffer level and starvation count of the object as of the last rendered block.
+  /// Lock-free, can be called from any thread.
+  virtual SourceStatistics getSourceStatistics() const = 0;
+
+ protected:
+  virtual ~SpatDecoderExtensions() {}
+};
+
+/// Extensions of SpatDecoderQueue. \see TBE_GetSpatDecoderQueueExtensions
+class SpatDecoderQueueExtensions : public SpatDecoderExtensions {
+ public:
+  /// Enqueue planar (non-interleaved) float buffers of data, one buffer per channel. The data is
+  /// interleaved straight into the queue.
+  /// \param channelBuffers One buffer per channel of the channel map
+  /// \param numSamplesPerChannel Number of samples in each buffer
+  /// \param channelMap The channel map for the data being enqueued
+  /// \return Number of samples per channel successfully queued. Should be the same as
+  /// numSamplesPerChannel. 0 if channelBuffers or one of its buffers is null.
+  virtual int32_t enqueuePlanarData(
+      const float* const* channelBuffers,
+      int32_t numSamplesPerChannel,
+      ChannelMap channelMap) = 0;
+
+  /// Enqueue planar (non-interleaved) 16 bit int buffers of data, one buffer per channel.
+  /// \see enqueuePlanarData(const float* const*, int32_t, ChannelMap)
+  virtual int32_t enqueuePlanarData(
+      const int16_t* const* channelBuffers,
+      int32_t numSamplesPerChannel,
+      ChannelMap channelMap) = 0;
+
+  /// Get space in the queue to decode or convert audio into directly, which saves the copy made
+  /// by SpatDecoderQueue::enqueueData(). The data is queued once commitWrite() is called. The
+  /// space stays valid until then and must not be used afterwards.
+  /// \param channelMap The channel map for the data being written
+  /// \param numSamplesPerChannel Number of samples per channel wanted
+  /// \param regions Filled in with the space for each part of the channel map: two regions for
+  /// AMBIX_9_2 (9 ambisonic channels, then 2 head-locked channels), one otherwise
+  /// \param numRegions Size of the regions array
+  /// \return Number of samples per channel available in every region, at most
+  /// numSamplesPerChannel. 0 if the queue is full, the channel map is not supported or
+  /// numRegions is too small.
+  virtual int32_t acquireWrite(
+      ChannelMap channelMap,
+      int32_t numSamplesPerChannel,
+      QueueWriteRegion* regions,
+      int32_t numRegions) = 0;
+
+  /// Queue the data written to the regions returned by acquireWrite().
+  /// \param numSamplesPerChannel Number of samples per channel written, from the start of the
+  /// regions. Must not be more than the number returned by acquireWrite().
+  /// \param format SampleFormat::INT16 if 16 bit samples were written to the start of each part
+  /// of the regions instead of floats. They are converted to float in place.
+  /// \return Number of samples per channel successfully queued
+  virtual int32_t commitWrite(
+      int32_t numSamplesPerChannel,
+      SampleFormat format = SampleFormat::FLOAT) = 0;
+
+ protected:
+  virtual ~SpatDecoderQueueExtensions() {}
+};
+
+/// Extensions of AudioObject. \see TBE_GetAudioObjectExtensions
+class AudioObjectExtensions : public SpatDecoderExtensions {
+ public:
+  /// Opens an asset from an asset bank for playback. The asset is read from the bank's memory
+  /// mapping, so no file is opened. Otherwise the same as \ref AudioObject::open(const char*).
+  /// \param bank Asset bank containing the asset, created with TBE_CreateAssetBank. It can be
+  /// destroyed while the asset is open.
+  /// \param assetName Name of the asset in the bank
+  /// \return Relevant error or EngineError::OK. EngineError::NO_ASSET if the asset is not in
+  /// the bank.
+  virtual EngineError open(AssetBank* bank, const char* assetName) = 0;
+
+  /// Set the priority of the object. When more objects play than
+  /// ExtensionSettings::maxActiveVoices, the ones with the highest priority are rendered first,
+  /// then the loudest ones. Default: 0. Thread safe.
+  /// \param priority Priority of the object. Higher values win.
+  virtual void setPriority(int32_t priority) = 0;
+
+  /// \return The priority of the object
+  virtual int32_t getPriority() const = 0;
+
+ protected:
+  virtual ~AudioObjectExtensions() {}
+};
+
+/// Extensions of SpatDecoderFile. \see TBE_GetSpatDecoderFileExtensions
+class SpatDecoderFileExtensions : public SpatDecoderExtensions {
+ public:
+  /// Opens an asset from an asset bank for playback. The asset is read from the bank's memory
+  /// mapping, so no file is opened. Otherwise the same as
+  /// \ref SpatDecoderFile::open(const char*, ChannelMap).
+  /// \param bank Asset bank containing the asset, created with TBE_CreateAssetBank. It can be
+  /// destroyed while the asset is open.
+  /// \param assetName Name of the asset in the bank
+  /// \param map The channel mapping / spatial audio format of the asset
+  /// \return Relevant error or EngineError::OK. EngineError::NO_ASSET if the asset is not in
+  /// the bank.
+  virtual EngineError
+  open(AssetBank* bank, const char* assetName, ChannelMap map = ChannelMap::TBE_8_2) = 0;
+
+ protected:
+  virtual ~SpatDecoderFileExtensions() {}
+};
+
+/// Extensions of SpeakersVirtualizer. \see TBE_GetSpeakersVirtualizerExtensions
+class SpeakersVirtualizerExtensions {
+ public:
+  /// Enqueue planar (non-interleaved) float buffers of data, one buffer per speaker in the order
+  /// of the layout given to \ref AudioEngine::createSpeakersVirtualizer(). Each buffer is copied
+  /// straight into its speaker's queue.
+  /// This method MUST be called consistently on the same thread!
+  /// \param channelBuffers One buffer per speaker
+  /// \param numSamplesPerChannel Number of samples in each buffer
+  /// \param numEnqueued Filled in with the number of samples per channel successfully queued.
+  /// \param endOfStream Optional parameter to indicate the end of stream.
+  /// \see SpeakersVirtualizer::enqueueData
+  /// \return EngineError::OK if all samples have been queued
+  ///         EngineError::QUEUE_FULL if some samples have been queued (check numEnqueued)
+  ///         EngineError::BAD_THREAD if this method is called from another thread
+  ///         EngineError::FAIL if there are no speaker objects
+  ///         EngineError::INVALID_BUFFER if channelBuffers or one of its buffers is null
+  virtual EngineError enqueuePlanarData(
+      const float* const* channelBuffers,
+      int32_t numSamplesPerChannel,
+      int32_t& numEnqueued,
+      bool endOfStream = false) = 0;
+
+  /// Enqueue planar (non-interleaved) 16 bit int buffers of data, one buffer per speaker.
+  /// \see enqueuePlanarData(const float* const*, int32_t, int32_t&, bool)
+  virtual EngineError enqueuePlanarData(
+      const int16_t* const* channelBuffers,
+      int32_t numSamplesPerChannel,
+      int32_t& numEnqueued,
+      bool endOfStream = false) = 0;
+
+  /// Get space in the queues to decode or convert audio into directly, which saves the copy made
+  /// by SpeakersVirtualizer::enqueueData(). Each speaker has its own queue, so there is one single
+  /// channel region per speaker, in the order of the layout given to
+  /// \ref AudioEngine::createSpeakersVirtualizer(). The data is queued once commitWrite() is
+  /// called. The space stays valid until then and must not be used afterwards.
+  /// This method MUST be called consistently on the same thread!
+  /// \param numSamplesPerChannel Number of samples per channel wanted
+  /// \param regions Filled in with the space for each speaker
+  /// \param numRegions Size of the regions array
+  /// \param numAcquired Filled in with the number of samples per channel available in every
+  /// region, at most numSamplesPerChannel
+  /// \return EngineError::OK if all the samples wanted are available
+  ///         EngineError::QUEUE_FULL if fewer samples are available (check numAcquired)
+  ///         EngineError::BAD_THREAD if this method is called from another thread
+  ///         EngineError::INVALID_CHANNEL_COUNT if numRegions is less than the number of speakers
+  ///         EngineError::FAIL if there are no speaker objects
+  virtual EngineError acquireWrite(
+      int32_t numSamplesPerChannel,
+      QueueWriteRegion* regions,
+      int32_t numRegions,
+      int32_t& numAcquired) = 0;
+
+  /// Queue the data written to the regions returned by acquireWrite().
+  /// This method MUST be called consistently on the same thread!
+  /// \param numSamplesPerChannel Number of samples per channel written, from the start of the
+  /// regions. Must not be more than the number acquired.
+  /// \param format SampleFormat::INT16 if 16 bit samples were written to the start of each part
+  /// of the regions instead of floats. They are converted to float in place.
+  /// \param endOfStream Optional parameter to indicate the end of stream.
+  /// \see SpeakersVirtualizer::enqueueData
+  /// \return EngineError::OK if the samples have been queued
+  ///         EngineError::BAD_THREAD if this method is called from another thread
+  ///         EngineError::INVALID_BUFFER_SIZE if more samples than acquired are committed
+  virtual EngineError commitWrite(
+      int32_t numSamplesPerChannel,
+      SampleFormat format = SampleFormat::FLOAT,
+      bool endOfStream = false) = 0;
+
+ protected:
+  virtual ~SpeakersVirtualizerExtensions() {}
+};
+} // namespace TBE
+
+extern "C" {
+
+/// Get the extensions of an AudioEngine.
+/// \param engine An engine created by TBE_CreateAudioEngine() or a session of a SessionGroup
+/// \return The extensions of the engine, valid as long as the engine, or nullptr if engine is null
+API_EXPORT TBE::AudioEngineExtensions* TBE_GetAudioEngineExtensions(TBE::AudioEngine* engine);
+
+/// Get the extensions of a SpatDecoderQueue.
+/// \param spatDecoder An object created by AudioEngine::createSpatDecoderQueue()
+/// \return The extensions of the object, valid as long as the object, or nullptr if spatDecoder is
+/// null
+API_EXPORT TBE::SpatDecoderQueueExtensions* TBE_GetSpatDecoderQueueExtensions(
+    TBE::SpatDecoderQueue* spatDecoder);
+
+/// Get the extensions of an AudioObject.
+/// \param object An object created by AudioEngine::createAudioObject()
+/// \return The extensions of the object, valid as long as the object, or nullptr if object is null
+API_EXPORT TBE::AudioObjectExtensions* TBE_GetAudioObjectExtensions(TBE::AudioObject* object);
+
+/// Get the extensions of a SpatDecoderFile.
+/// \param spatDecoder An object created by AudioEngine::createSpatDecoderFile()
+/// \return The extensions of the object, valid as long as the object, or nullptr if spatDecoder is
+/// null
+API_EXPORT TBE::SpatDecoderFileExtensions* TBE_GetSpatDecoderFileExtensions(
+    TBE::SpatDecoderFile* spatDecoder);
+
+/// Get the extensions of a SpeakersVirtualizer.
+/// \param virtualizer An object created by AudioEngine::createSpeakersVirtualizer()
+/// \return The extensions of the object, valid as long as the object, or nullptr if virtualizer
+/// is null
+API_EXPORT TBE::SpeakersVirtualizerExtensions* TBE_GetSpeakersVirtualizerExtensions(
+    TBE::SpeakersVirtualizer* virtualizer);
+}
@@ -53,5 +53,15 @@ class IOStream {
 
   /// \return True if the end of the stream has been reached
   virtual bool endOfStream() = 0;
+
+  /// Zero-copy read for streams backed by memory, such as the streams of an AssetBank. Returns the
+  /// data at the current position without moving it: use setPosition(n, SEEK_CUR) once n bytes
+  /// have been consumed. The default implementation is for streams that are not memory backed.
+  /// \param numBytes Filled in with the number of bytes available from the returned address
+  /// \return Address of the data at the current position or nullptr if unsupported
+  virtual const void* getReadPointer(size_t& numBytes) {
+    numBytes = 0;
+    return nullptr;
+  }
 };
 } // namespace TBE
@@ -82,6 +82,28 @@ namespace TBE
       /// \return The quaternion product a*b
       inline static TBQuat quatProductUnNormalised(TBQuat a, TBQuat b);
 
+      /// Dot product of two quaternions, the cosine of half the angle between the rotations if they are normalised
+      /// \param a The first quaternion
+      /// \param b The second quaternion
+      /// \return The dot product
+      inline static float dotProduct(TBQuat a, TBQuat b);
+
+      /// Normalised linear interpolation between two rotations, along the shortest path. Cheaper than slerp, but the
+      /// angular velocity is not constant, which only shows for large angles.
+      /// \param a Normalised rotation at t = 0
+      /// \param b Normalised rotation at t = 1
+      /// \param t Interpolation factor
+      /// \return The normalised interpolated rotation
+      inline static TBQuat nlerp(TBQuat a, TBQuat b, float t);
+
+      /// Spherical linear interpolation between two rotations, along the shortest path at a constant angular
+      /// velocity. A factor outside [0, 1] extrapolates the rotation at the same velocity.
+      /// \param a Normalised rotation at t = 0
+      /// \param b Normalised rotation at t = 1
+      /// \param t Interpolation factor
+      /// \return The normalised interpolated rotation
+      inline static TBQuat slerp(TBQuat a, TBQuat b, float t);
+
       /// Rotates the input vector by the specified quaternion
       /// \param quat Quaternion rotation
       /// \param vector Input vector
@@ -332,6 +354,46 @@ namespace TBE
       return result;
    }
 
+   inline float TBQuat::dotProduct(TBQuat a, TBQuat b)
+   {
+      return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+   }
+
+   inline TBQuat TBQuat::nlerp(TBQuat a, TBQuat b, float t)
+   {
+      // q and -q are the same rotation, pick the one closest to a
+      const float sign = dotProduct(a, b) < 0.f ? -1.f : 1.f;
+      TBQuat result(a.x + (sign * b.x - a.x) * t, a.y + (sign * b.y - a.y) * t, a.z + (sign * b.z - a.z) * t,
+                    a.w + (sign * b.w - a.w) * t);
+      result.normalise();
+      return result;
+   }
+
+   inline TBQuat TBQuat::slerp(TBQuat a, TBQuat b, float t)
+   {
+      float cosine = dotProduct(a, b);
+      if (cosine < 0.f)
+      {
+         b = b * -1.f;
+         cosine = -cosine;
+      }
+
+      // The weights below are ill-conditioned for nearly identical rotations, where nlerp is just as accurate
+      if (cosine > 0.9995f)
+      {
+         return nlerp(a, b, t);
+      }
+
+      const float angle = std::acos(cosine);
+      const float invSine = 1.f / std::sin(angle);
+      const float weightA = std::sin((1.f - t) * angle) * invSine;
+      const float weightB = std::sin(t * angle) * invSine;
+      TBQuat result(weightA * a.x + weightB * b.x, weightA * a.y + weightB * b.y, weightA * a.z + weightB * b.z,
+                    weightA * a.w + weightB * b.w);
+      result.normalise();
+      return result;
+   }
+
    inline TBVector TBQuat::rotateVectorByQuat(TBQuat rotQuat, TBVector vector)
    {
       // calculate conjugate
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+/**
+ * @file TBE_SessionGroup.h
+ * Rendering of many independent engines on a shared pool of threads
+ */
+
+#pragma once
+
+#include "TBE_AudioEngine.h"
+
+#include <thread>
+
+namespace TBE {
+struct SessionGroupSettings {
+  AudioSettings audioSettings; /// Sample rate and buffer size of every session. deviceType is
+                               /// ignored: sessions have no audio device.
+  /// Number of threads that render the sessions, at least 1. Defaults to one per processor core,
+  /// or 0 if the number of cores is unknown, in which case it must be set.
+  int32_t numThreads{static_cast<int32_t>(std::thread::hardware_concurrency())};
+  size_t pcmCacheSizeInBytes{0}; /// Memory budget of the cache of decoded audio shared by all
+                                 /// sessions. 0 disables the cache.
+  int32_t numCacheThreads{0}; /// Number of threads that decode assets into the PCM cache. If 0,
+                              /// one per processor core. Unused if the cache is disabled.
+  int32_t maxActiveVoices{0}; /// Maximum number of audio objects rendered each block in every
+                              /// session. See ExtensionSettings::maxActiveVoices.
+};
+
+/// Outcome of rendering a session's block
+enum class SessionBlockResult {
+  RENDERED, /// The block was rendered before the deadline
+  LATE, /// The session was still rendering at the deadline. The buffer is silent and the block
+        /// is discarded when it completes.
+  DROPPED, /// The deadline passed before the session started rendering. The buffer is silent and
+           /// the session did not advance.
+  BUSY, /// The session was still rendering a late block from a previous call, so it was skipped.
+        /// The buffer is silent.
+};
+
+/// One session's block for SessionGroup::render
+struct SessionBlock {
+  AudioEngine* session{nullptr}; /// Session to render, created by the group
+  float* buffer{nullptr}; /// Interleaved stereo output
+  int32_t numOfSamples{0}; /// Number of samples to render, a multiple of 2 and at most twice the
+                           /// buffer size of the group's AudioSettings
+  SessionBlockResult result{SessionBlockResult::RENDERED}; /// Filled in by render
+};
+
+/// A group of independent audio engines, or sessions, such as one per listener on a server. The
+/// sessions' blocks are rendered in parallel on a fixed pool of threads, and sessions share
+/// read-only data such as decoded assets. Sessions have no threads of their own: decoding happens
+/// while rendering, and events are dispatched on the thread that calls render(). Each call has a
+/// deadline, so that a slow session cannot hold up the others. Create with TBE_CreateSessionGroup.
+/// Not thread safe: create, destroy and render sessions from one thread.
+class SessionGroup {
+ public:
+  virtual ~SessionGroup() {}
+
+  /// Create a session. It is used like any AudioEngine, with its mix rendered by render().
+  /// \param session Filled in with the session
+  /// \param memorySettings Object pools of the session. Sessions share the group's PCM cache.
+  /// \return Relevant error or EngineError::OK
+  virtual EngineError createSession(
+      AudioEngine*& session,
+      MemorySettings memorySettings = MemorySettings()) = 0;
+
+  /// Destroy a session. Waits for the session to finish a late block if needed.
+  /// \param session Session created by this group
+  virtual void destroySession(AudioEngine*& session) = 0;
+
+  /// \return Number of sessions in the group
+  virtual size_t getNumSessions() const = 0;
+
+  /// Render one block of several sessions in parallel, and dispatch their events.
+  /// \param blocks One block per session. A session that appears twice is BUSY the second time.
+  /// \param numBlocks Number of blocks
+  /// \param deadlineMs Time from the call after which unfinished sessions are given up on, so that
+  /// the call returns. If 0, the call waits for every session.
+  /// \return EngineError::OK, EngineError::FAIL if a session is not part of the group,
+  /// EngineError::INVALID_SETTINGS if deadlineMs is negative or blocks or a buffer is null, or
+  /// EngineError::INVALID_BUFFER_SIZE if a block's size is invalid. Nothing is rendered on error.
+  virtual EngineError render(SessionBlock* blocks, size_t numBlocks, double deadlineMs) = 0;
+};
+} // namespace TBE
+
+extern "C" {
+
+/// Create a session group.
+/// \param group Filled in with the group
+/// \param settings Settings of the group
+/// \return EngineError::OK or EngineError::INVALID_SETTINGS if numThreads is less than 1 or
+/// numCacheThreads is negative
+API_EXPORT TBE::EngineError TBE_CreateSessionGroup(
+    TBE::SessionGroup*& group,
+    TBE::SessionGroupSettings settings = TBE::SessionGroupSettings());
+
+/// Destroy a session group and all its sessions.
+/// \param group Pointer to the group
+API_EXPORT void TBE_DestroySessionGroup(TBE::SessionGroup*& group);
+}
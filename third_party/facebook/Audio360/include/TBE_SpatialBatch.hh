@@ -0,0 +1,567 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include "TBE_AudioEngineDefinitions.h"
+#include "TBE_Quat.hh"
+#include "TBE_Vector.hh"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stddef.h>
+#include <stdint.h>
+
+// Define TBE_SPATIAL_BATCH_SCALAR to build the scalar fallback on any target, e.g. to test it
+#if defined(TBE_SPATIAL_BATCH_SCALAR)
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define TBE_SPATIAL_BATCH_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TBE_SPATIAL_BATCH_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define TBE_SPATIAL_BATCH_NEON 1
+#endif
+
+namespace TBE
+{
+   /// Spatial parameters for many sources against one listener pose, on structure-of-arrays data.
+   /// This is the batched equivalent of TBQuat::getAedFromQuat and of the attenuation gain for an
+   /// AttenuationMode and AttenuationProps (see getAttenuationGain).
+   ///
+   /// The instruction set is picked at compile time: AVX2 (8 sources at a time) if the translation unit is built
+   /// with AVX2 enabled, SSE2 (4) on x86, NEON (4) on ARM, otherwise scalar. Defining TBE_SPATIAL_BATCH_SCALAR
+   /// selects the scalar path on any target. All paths, including the scalar fallback and the remainder of a
+   /// batch, evaluate the same polynomial approximations, so results do not depend on the instruction set beyond
+   /// floating point rounding. Compared to the scalar functions:
+   /// - azimuth and elevation are within angleToleranceDegrees(), except for the azimuth of sources within a degree
+   ///   of the listener's vertical axis, where it is ill-conditioned in both implementations
+   /// - distance is within relativeTolerance() (relative)
+   /// - attenuation gain is within relativeTolerance() (relative) or 1e-6 (absolute)
+   /// The input and output arrays do not need to be aligned and must not overlap.
+   class TBSpatialBatch
+   {
+    public:
+      /// Maximum absolute difference in degrees between the batched and scalar azimuth and elevation
+      inline static float angleToleranceDegrees()
+      {
+         return 1.e-3f;
+      }
+
+      /// Maximum relative difference between the batched and scalar distance and attenuation gain
+      inline static float relativeTolerance()
+      {
+         return 1.e-5f;
+      }
+
+      /// Linear gain of a source at a distance from the listener. This is the scalar reference for the batched gain.
+      /// Logarithmic: (minimumDistance / distance) ^ factor, i.e. 6dB per doubling of distance for a factor of 1.
+      /// Linear: falls from 1 at minimumDistance to 0 at maximumDistance. In both modes the gain is held at its
+      /// maximumDistance value beyond it, or muted if maxDistanceMute is set.
+      inline static float getAttenuationGain(AttenuationMode mode, const AttenuationProps &props, float distance);
+
+      /// Azimuth, elevation and distance of N sources relative to the listener.
+      /// \param listenerQuat Rotation of the listener
+      /// \param listenerPosition Position of the listener
+      /// \param sourceX, sourceY, sourceZ Positions of the sources
+      /// \param numSources Number of sources
+      /// \param azimuth, elevation Filled in with the angles in degrees, as returned by TBVector::getAedFromVector
+      /// \param distance Filled in with the distances
+      inline static void getAedFromQuat(const TBQuat &listenerQuat, const TBVector &listenerPosition,
+                                        const float *sourceX, const float *sourceY, const float *sourceZ,
+                                        size_t numSources, float *azimuth, float *elevation, float *distance);
+
+      /// Attenuation gain of N sources that share an attenuation model.
+      /// \param distance Distances of the sources from the listener
+      /// \param numSources Number of sources
+      /// \param gain Filled in with the linear gain of each source
+      inline static void getAttenuationGain(AttenuationMode mode, const AttenuationProps &props,
+                                            const float *distance, size_t numSources, float *gain);
+
+      /// Azimuth, elevation, distance and attenuation gain of N sources in a single pass.
+      /// \see getAedFromQuat, getAttenuationGain
+      inline static void getAedAndAttenuationGain(const TBQuat &listenerQuat, const TBVector &listenerPosition,
+                                                  const float *sourceX, const float *sourceY, const float *sourceZ,
+                                                  size_t numSources, AttenuationMode mode,
+                                                  const AttenuationProps &props, float *azimuth, float *elevation,
+                                                  float *distance, float *gain);
+
+    private:
+      struct Params;
+
+      template <typename Ops>
+      inline static size_t run(const Params &params, size_t begin, size_t end);
+   };
+
+   namespace SpatialBatchDetail
+   {
+      const float kRadiansToDegrees = 180.f / 3.14159265358979323846f;
+      const float kHalfPi = 1.57079632679489661923f;
+      const float kPi = 3.14159265358979323846f;
+      const float kMinDistance = 1.e-6f;
+      const float kMinRatio = 1.17549435e-38f; // FLT_MIN, keeps log2 away from denormals
+
+      /// Scalar lanes. Used when no SIMD instruction set is available and for the remainder of a batch.
+      struct ScalarOps
+      {
+         typedef float V;
+         typedef bool M;
+         static const size_t kWidth = 1;
+
+         static V load(const float *p) { return *p; }
+         static void store(float *p, V v) { *p = v; }
+         static V set(float v) { return v; }
+         static V add(V a, V b) { return a + b; }
+         static V sub(V a, V b) { return a - b; }
+         static V mul(V a, V b) { return a * b; }
+         static V div(V a, V b) { return a / b; }
+         static V sqrt(V a) { return std::sqrt(a); }
+         static V min(V a, V b) { return a < b ? a : b; }
+         static V max(V a, V b) { return a > b ? a : b; }
+         static V abs(V a) { return std::fabs(a); }
+         static M lt(V a, V b) { return a < b; }
+         static M gt(V a, V b) { return a > b; }
+         static M ge(V a, V b) { return a >= b; }
+         static V select(M m, V a, V b) { return m ? a : b; }
+         static V floor(V a) { return std::floor(a); }
+
+         /// Split a positive normal float into x = mantissa * 2^exponent with mantissa in [1, 2)
+         static V exponent(V x, V &mantissa)
+         {
+            uint32_t bits;
+            std::memcpy(&bits, &x, sizeof(bits));
+            const int32_t e = static_cast<int32_t>((bits >> 23) & 0xff) - 127;
+            bits = (bits & 0x007fffff) | 0x3f800000;
+            std::memcpy(&mantissa, &bits, sizeof(bits));
+            return static_cast<float>(e);
+         }
+
+         /// 2^n for an integer valued n in [-126, 127]
+         static V pow2i(V n)
+         {
+            const uint32_t bits = static_cast<uint32_t>(static_cast<int32_t>(n) + 127) << 23;
+            float result;
+            std::memcpy(&result, &bits, sizeof(result));
+            return result;
+         }
+      };
+
+#if defined(TBE_SPATIAL_BATCH_AVX2)
+      struct SimdOps
+      {
+         typedef __m256 V;
+         typedef __m256 M;
+         static const size_t kWidth = 8;
+
+         static V load(const float *p) { return _mm256_loadu_ps(p); }
+         static void store(float *p, V v) { _mm256_storeu_ps(p, v); }
+         static V set(float v) { return _mm256_set1_ps(v); }
+         static V add(V a, V b) { return _mm256_add_ps(a, b); }
+         static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+         static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+         static V div(V a, V b) { return _mm256_div_ps(a, b); }
+         static V sqrt(V a) { return _mm256_sqrt_ps(a); }
+         static V min(V a, V b) { return _mm256_min_ps(a, b); }
+         static V max(V a, V b) { return _mm256_max_ps(a, b); }
+         static V abs(V a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a); }
+         static M lt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+         static M gt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+         static M ge(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+         static V select(M m, V a, V b) { return _mm256_blendv_ps(b, a, m); }
+         static V floor(V a) { return _mm256_floor_ps(a); }
+
+         static V exponent(V x, V &mantissa)
+         {
+            const __m256i bits = _mm256_castps_si256(x);
+            const __m256i e = _mm256_sub_epi32(_mm256_and_si256(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(0xff)),
+                                               _mm256_set1_epi32(127));
+            mantissa = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)),
+                                                           _mm256_set1_epi32(0x3f800000)));
+            return _mm256_cvtepi32_ps(e);
+         }
+
+         static V pow2i(V n)
+         {
+            const __m256i e = _mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127));
+            return _mm256_castsi256_ps(_mm256_slli_epi32(e, 23));
+         }
+      };
+#elif defined(TBE_SPATIAL_BATCH_SSE2)
+      struct SimdOps
+      {
+         typedef __m128 V;
+         typedef __m128 M;
+         static const size_t kWidth = 4;
+
+         static V load(const float *p) { return _mm_loadu_ps(p); }
+         static void store(float *p, V v) { _mm_storeu_ps(p, v); }
+         static V set(float v) { return _mm_set1_ps(v); }
+         static V add(V a, V b) { return _mm_add_ps(a, b); }
+         static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+         static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+         static V div(V a, V b) { return _mm_div_ps(a, b); }
+         static V sqrt(V a) { return _mm_sqrt_ps(a); }
+         static V min(V a, V b) { return _mm_min_ps(a, b); }
+         static V max(V a, V b) { return _mm_max_ps(a, b); }
+         static V abs(V a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a); }
+         static M lt(V a, V b) { return _mm_cmplt_ps(a, b); }
+         static M gt(V a, V b) { return _mm_cmpgt_ps(a, b); }
+         static M ge(V a, V b) { return _mm_cmpge_ps(a, b); }
+         static V select(M m, V a, V b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+
+         static V floor(V a)
+         {
+            // SSE2 has no floor: truncate, then step down where truncation rounded up
+            const V truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+            return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a), _mm_set1_ps(1.f)));
+         }
+
+         static V exponent(V x, V &mantissa)
+         {
+            const __m128i bits = _mm_castps_si128(x);
+            const __m128i e =
+                _mm_sub_epi32(_mm_and_si128(_mm_srli_epi32(bits, 23), _mm_set1_epi32(0xff)), _mm_set1_epi32(127));
+            mantissa = _mm_castsi128_ps(
+                _mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f800000)));
+            return _mm_cvtepi32_ps(e);
+         }
+
+         static V pow2i(V n)
+         {
+            const __m128i e = _mm_add_epi32(_mm_cvtps_epi32(n), _mm_set1_epi32(127));
+            return _mm_castsi128_ps(_mm_slli_epi32(e, 23));
+         }
+      };
+#elif defined(TBE_SPATIAL_BATCH_NEON)
+      struct SimdOps
+      {
+         typedef float32x4_t V;
+         typedef uint32x4_t M;
+         static const size_t kWidth = 4;
+
+         static V load(const float *p) { return vld1q_f32(p); }
+         static void store(float *p, V v) { vst1q_f32(p, v); }
+         static V set(float v) { return vdupq_n_f32(v); }
+         static V add(V a, V b) { return vaddq_f32(a, b); }
+         static V sub(V a, V b) { return vsubq_f32(a, b); }
+         static V mul(V a, V b) { return vmulq_f32(a, b); }
+         static V min(V a, V b) { return vminq_f32(a, b); }
+         static V max(V a, V b) { return vmaxq_f32(a, b); }
+         static V abs(V a) { return vabsq_f32(a); }
+         static M lt(V a, V b) { return vcltq_f32(a, b); }
+         static M gt(V a, V b) { return vcgtq_f32(a, b); }
+         static M ge(V a, V b) { return vcgeq_f32(a, b); }
+         static V select(M m, V a, V b) { return vbslq_f32(m, a, b); }
+#if defined(__aarch64__)
+         static V div(V a, V b) { return vdivq_f32(a, b); }
+         static V sqrt(V a) { return vsqrtq_f32(a); }
+         static V floor(V a) { return vrndmq_f32(a); }
+#else
+         static V div(V a, V b)
+         {
+            // Reciprocal estimate refined with two Newton-Raphson steps
+            V reciprocal = vrecpeq_f32(b);
+            reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+            reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+            return vmulq_f32(a, reciprocal);
+         }
+
+         static V sqrt(V a)
+         {
+            V estimate = vrsqrteq_f32(a);
+            estimate = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a, estimate), estimate), estimate);
+            estimate = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a, estimate), estimate), estimate);
+            return select(vcgtq_f32(a, vdupq_n_f32(0.f)), vmulq_f32(a, estimate), vdupq_n_f32(0.f));
+         }
+
+         static V floor(V a)
+         {
+            const V truncated = vcvtq_f32_s32(vcvtq_s32_f32(a));
+            return vsubq_f32(truncated, select(vcgtq_f32(truncated, a), vdupq_n_f32(1.f), vdupq_n_f32(0.f)));
+         }
+#endif
+
+         static V exponent(V x, V &mantissa)
+         {
+            const uint32x4_t bits = vreinterpretq_u32_f32(x);
+            const int32x4_t e = vsubq_s32(vreinterpretq_s32_u32(vandq_u32(vshrq_n_u32(bits, 23), vdupq_n_u32(0xff))),
+                                          vdupq_n_s32(127));
+            mantissa =
+                vreinterpretq_f32_u32(vorrq_u32(vandq_u32(bits, vdupq_n_u32(0x007fffff)), vdupq_n_u32(0x3f800000)));
+            return vcvtq_f32_s32(e);
+         }
+
+         static V pow2i(V n)
+         {
+            const int32x4_t e = vaddq_s32(vcvtq_s32_f32(n), vdupq_n_s32(127));
+            return vreinterpretq_f32_s32(vshlq_n_s32(e, 23));
+         }
+      };
+#else
+      typedef ScalarOps SimdOps;
+#endif
+
+      /// atan(x) for x in [0, 1]. Minimax polynomial, absolute error below 2e-6 radians.
+      template <typename Ops>
+      inline typename Ops::V atanUnit(typename Ops::V x)
+      {
+         typedef typename Ops::V V;
+         const V x2 = Ops::mul(x, x);
+         V p = Ops::set(-0.0117212f);
+         p = Ops::add(Ops::mul(p, x2), Ops::set(0.05265332f));
+         p = Ops::add(Ops::mul(p, x2), Ops::set(-0.11643287f));
+         p = Ops::add(Ops::mul(p, x2), Ops::set(0.19354346f));
+         p = Ops::add(Ops::mul(p, x2), Ops::set(-0.33262347f));
+         p = Ops::add(Ops::mul(p, x2), Ops::set(0.99997723f));
+         return Ops::mul(p, x);
+      }
+
+      /// atan2(y, x) in radians with the quadrant conventions of std::atan2, except that the sign of zero is ignored
+      template <typename Ops>
+      inline typename Ops::V atan2(typename Ops::V y, typename Ops::V x)
+      {
+         typedef typename Ops::V V;
+         const V zero = Ops::set(0.f);
+         const V ax = Ops::abs(x);
+         const V ay = Ops::abs(y);
+         const V largest = Ops::max(ax, ay);
+         const V ratio = Ops::div(Ops::min(ax, ay), Ops::select(Ops::gt(largest, zero), largest, Ops::set(1.f)));
+         V angle = atanUnit<Ops>(ratio);
+         angle = Ops::select(Ops::gt(ay, ax), Ops::sub(Ops::set(kHalfPi), angle), angle);
+         angle = Ops::select(Ops::lt(x, zero), Ops::sub(Ops::set(kPi), angle), angle);
+         return Ops::select(Ops::lt(y, zero), Ops::sub(zero, angle), angle);
+      }
+
+      /// log2(x) for positive normal x
+      template <typename Ops>
+      inline typename Ops::V log2(typename Ops::V x)
+      {
+         typedef typename Ops::V V;
+         V mantissa;
+         V e = Ops::exponent(x, mantissa);
+         // Center the mantissa on 1 so the series below converges quickly
+         const typename Ops::M high = Ops::gt(mantissa, Ops::set(1.41421356f));
+         mantissa = Ops::select(high, Ops::mul(mantissa, Ops::set(0.5f)), mantissa);
+         e = Ops::select(high, Ops::add(e, Ops::set(1.f)), e);
+
+         // ln(m) = 2 atanh(t) with t = (m - 1) / (m + 1), |t| < 0.172
+         const V one = Ops::set(1.f);
+         const V t = Ops::div(Ops::sub(mantissa, one), Ops::add(mantissa, one));
+         const V t2 = Ops::mul(t, t);
+         V p = Ops::set(1.f / 9.f);
+         p = Ops::add(Ops::mul(p, t2), Ops::set(1.f / 7.f));
+         p = Ops::add(Ops::mul(p, t2), Ops::set(1.f / 5.f));
+         p = Ops::add(Ops::mul(p, t2), Ops::set(1.f / 3.f));
+         p = Ops::add(Ops::mul(p, t2), one);
+         const V ln = Ops::mul(Ops::mul(p, t), Ops::set(2.f));
+         return Ops::add(e, Ops::mul(ln, Ops::set(1.44269504f)));
+      }
+
+      /// 2^x, clamped to the range of normal floats
+      template <typename Ops>
+      inline typename Ops::V exp2(typename Ops::V x)
+      {
+         typedef typename Ops::V V;
+         x = Ops::min(Ops::max(x, Ops::set(-126.f)), Ops::set(127.f));
+         const V n = Ops::floor(x);
+         // e^(f ln2) for f in [0, 1), Taylor series to the 7th order
+         const V f = Ops::mul(Ops::sub(x, n), Ops::set(0.69314718f));
+         V p = Ops::set(1.f / 5040.f);
+         p = Ops::add(Ops::mul(p, f), Ops::set(1.f / 720.f));
+         p = Ops::add(Ops::mul(p, f), Ops::set(1.f / 120.f));
+         p = Ops::add(Ops::mul(p, f), Ops::set(1.f / 24.f));
+         p = Ops::add(Ops::mul(p, f), Ops::set(1.f / 6.f));
+         p = Ops::add(Ops::mul(p, f), Ops::set(0.5f));
+         p = Ops::add(Ops::mul(p, f), Ops::set(1.f));
+         p = Ops::add(Ops::mul(p, f), Ops::set(1.f));
+         return Ops::mul(p, Ops::pow2i(n));
+      }
+   } // namespace SpatialBatchDetail
+
+   struct TBSpatialBatch::Params
+   {
+      float rotation[9];
+      float listenerX, listenerY, listenerZ;
+      const float *sourceX;
+      const float *sourceY;
+      const float *sourceZ;
+      const float *inputDistance; // Only used when the Aed is not computed
+      AttenuationMode mode;
+      float minDistance, maxDistance, muteDistance, factor;
+      bool mute;
+      float *azimuth;
+      float *elevation;
+      float *distance;
+      float *gain;
+   };
+
+   template <typename Ops>
+   inline size_t TBSpatialBatch::run(const Params &params, size_t begin, size_t end)
+   {
+      typedef typename Ops::V V;
+      const float *m = params.rotation;
+      size_t i = begin;
+      for (; i + Ops::kWidth <= end; i += Ops::kWidth)
+      {
+         V distance;
+         if (params.azimuth)
+         {
+            const V px = Ops::sub(Ops::load(params.sourceX + i), Ops::set(params.listenerX));
+            const V py = Ops::sub(Ops::load(params.sourceY + i), Ops::set(params.listenerY));
+            const V pz = Ops::sub(Ops::load(params.sourceZ + i), Ops::set(params.listenerZ));
+            const V x = Ops::add(Ops::add(Ops::mul(Ops::set(m[0]), px), Ops::mul(Ops::set(m[1]), py)),
+                                 Ops::mul(Ops::set(m[2]), pz));
+            const V y = Ops::add(Ops::add(Ops::mul(Ops::set(m[3]), px), Ops::mul(Ops::set(m[4]), py)),
+                                 Ops::mul(Ops::set(m[5]), pz));
+            const V z = Ops::add(Ops::add(Ops::mul(Ops::set(m[6]), px), Ops::mul(Ops::set(m[7]), py)),
+                                 Ops::mul(Ops::set(m[8]), pz));
+
+            const V horizontal2 = Ops::add(Ops::mul(x, x), Ops::mul(z, z));
+            distance = Ops::sqrt(Ops::add(horizontal2, Ops::mul(y, y)));
+            const V toDegrees = Ops::set(SpatialBatchDetail::kRadiansToDegrees);
+            Ops::store(params.azimuth + i, Ops::mul(SpatialBatchDetail::atan2<Ops>(x, z), toDegrees));
+            Ops::store(params.elevation + i,
+                       Ops::mul(SpatialBatchDetail::atan2<Ops>(y, Ops::sqrt(horizontal2)), toDegrees));
+            Ops::store(params.distance + i, distance);
+         }
+         else
+         {
+            distance = Ops::load(params.inputDistance + i);
+         }
+
+         if (!params.gain)
+         {
+            continue;
+         }
+
+         V gain = Ops::set(1.f);
+         if (params.mode != AttenuationMode::DISABLE)
+         {
+            const V minDistance = Ops::set(params.minDistance);
+            const V clamped = Ops::min(Ops::max(distance, minDistance), Ops::set(params.maxDistance));
+            if (params.mode == AttenuationMode::LINEAR)
+            {
+               if (params.maxDistance > params.minDistance)
+               {
+                  const V range = Ops::set(params.maxDistance - params.minDistance);
+                  gain = Ops::sub(gain, Ops::div(Ops::sub(clamped, minDistance), range));
+               }
+            }
+            else
+            {
+               // pow(ratio, factor), skipped for the common factor of 1
+               const V ratio = Ops::div(minDistance, clamped);
+               if (params.factor == 1.f)
+               {
+                  gain = ratio;
+               }
+               else
+               {
+                  const V minRatio = Ops::set(SpatialBatchDetail::kMinRatio);
+                  const V log = SpatialBatchDetail::log2<Ops>(Ops::max(ratio, minRatio));
+                  gain = SpatialBatchDetail::exp2<Ops>(Ops::mul(Ops::set(params.factor), log));
+               }
+            }
+            if (params.mute)
+            {
+               gain = Ops::select(Ops::ge(distance, Ops::set(params.muteDistance)), Ops::set(0.f), gain);
+            }
+         }
+         Ops::store(params.gain + i, gain);
+      }
+      return i;
+   }
+
+   inline float TBSpatialBatch::getAttenuationGain(AttenuationMode mode, const AttenuationProps &props, float distance)
+   {
+      if (mode == AttenuationMode::DISABLE)
+      {
+         return 1.f;
+      }
+      if (props.maxDistanceMute && distance >= props.maximumDistance)
+      {
+         return 0.f;
+      }
+
+      const float minDistance = std::max(props.minimumDistance, SpatialBatchDetail::kMinDistance);
+      const float maxDistance = std::max(props.maximumDistance, minDistance);
+      const float clamped = std::min(std::max(distance, minDistance), maxDistance);
+      if (mode == AttenuationMode::LINEAR)
+      {
+         return maxDistance > minDistance ? 1.f - (clamped - minDistance) / (maxDistance - minDistance) : 1.f;
+      }
+      return std::pow(minDistance / clamped, props.factor);
+   }
+
+   inline void TBSpatialBatch::getAedFromQuat(const TBQuat &listenerQuat, const TBVector &listenerPosition,
+                                              const float *sourceX, const float *sourceY, const float *sourceZ,
+                                              size_t numSources, float *azimuth, float *elevation, float *distance)
+   {
+      getAedAndAttenuationGain(listenerQuat, listenerPosition, sourceX, sourceY, sourceZ, numSources,
+                               AttenuationMode::DISABLE, AttenuationProps(), azimuth, elevation, distance, nullptr);
+   }
+
+   inline void TBSpatialBatch::getAttenuationGain(AttenuationMode mode, const AttenuationProps &props,
+                                                  const float *distance, size_t numSources, float *gain)
+   {
+      Params params = Params();
+      params.inputDistance = distance;
+      params.mode = mode;
+      params.minDistance = std::max(props.minimumDistance, SpatialBatchDetail::kMinDistance);
+      params.maxDistance = std::max(props.maximumDistance, params.minDistance);
+      params.muteDistance = props.maximumDistance;
+      params.factor = props.factor;
+      params.mute = props.maxDistanceMute;
+      params.gain = gain;
+
+      const size_t simdEnd = run<SpatialBatchDetail::SimdOps>(params, 0, numSources);
+      run<SpatialBatchDetail::ScalarOps>(params, simdEnd, numSources);
+   }
+
+   inline void TBSpatialBatch::getAedAndAttenuationGain(const TBQuat &listenerQuat, const TBVector &listenerPosition,
+                                                        const float *sourceX, const float *sourceY,
+                                                        const float *sourceZ, size_t numSources, AttenuationMode mode,
+                                                        const AttenuationProps &props, float *azimuth,
+                                                        float *elevation, float *distance, float *gain)
+   {
+      // Rotating by the listener's conjugate, as in TBQuat::getAedFromQuat, expressed as a matrix so it is computed
+      // once per batch. The matrix keeps the |q|^2 scale of the quaternion product for non unit quaternions.
+      const float qx = -listenerQuat.x;
+      const float qy = -listenerQuat.y;
+      const float qz = -listenerQuat.z;
+      const float qw = listenerQuat.w;
+
+      Params params = Params();
+      params.rotation[0] = qw * qw + qx * qx - qy * qy - qz * qz;
+      params.rotation[1] = 2.f * (qx * qy - qw * qz);
+      params.rotation[2] = 2.f * (qx * qz + qw * qy);
+      params.rotation[3] = 2.f * (qx * qy + qw * qz);
+      params.rotation[4] = qw * qw - qx * qx + qy * qy - qz * qz;
+      params.rotation[5] = 2.f * (qy * qz - qw * qx);
+      params.rotation[6] = 2.f * (qx * qz - qw * qy);
+      params.rotation[7] = 2.f * (qy * qz + qw * qx);
+      params.rotation[8] = qw * qw - qx * qx - qy * qy + qz * qz;
+      params.listenerX = listenerPosition.x;
+      params.listenerY = listenerPosition.y;
+      params.listenerZ = listenerPosition.z;
+      params.sourceX = sourceX;
+      params.sourceY = sourceY;
+      params.sourceZ = sourceZ;
+      params.mode = mode;
+      params.minDistance = std::max(props.minimumDistance, SpatialBatchDetail::kMinDistance);
+      params.maxDistance = std::max(props.maximumDistance, params.minDistance);
+      params.muteDistance = props.maximumDistance;
+      params.factor = props.factor;
+      params.mute = props.maxDistanceMute;
+      params.azimuth = azimuth;
+      params.elevation = elevation;
+      params.distance = distance;
+      params.gain = gain;
+
+      const size_t simdEnd = run<SpatialBatchDetail::SimdOps>(params, 0, numSources);
+      run<SpatialBatchDetail::ScalarOps>(params, simdEnd, numSources);
+   }
+} // namespace TBE
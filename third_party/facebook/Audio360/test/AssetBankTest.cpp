@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/include/TBE_AudioEngineExtensions.h"
+#include "third_party/facebook/Audio360/test/TestUtils.h"
+#include "third_party/facebook/Audio360/tools/AssetBankWriter.h"
+
+#include <cstring>
+#include <functional>
+
+using namespace TBE;
+
+namespace {
+const float kSampleRate = 48000.f;
+const int32_t kBufferSize = 512;
+const int32_t kAssetFrames = 4800;
+const int32_t kMaxBlocks = 200; /// Blocks rendered before giving up on the end of an asset
+const size_t kOffsetField = kAssetBankNameSize;
+const size_t kLengthField = kOffsetField + 8;
+const size_t kCodecField = kLengthField + 8;
+
+/// Names sharing prefixes, added out of order
+struct Asset {
+  const char* name;
+  int32_t numChannels;
+};
+const Asset kAssets[] = {{"tone_stereo", 2}, {"tone", 1}, {"tone_ambix", 4}};
+const char* const kSortedNames[] = {"tone", "tone_ambix", "tone_stereo"};
+const char* const kBrokenName = "zz_broken";
+
+void writeLE32(std::vector<char>& data, size_t offset, uint32_t value) {
+  for (size_t i = 0; i < 4; ++i) {
+    data[offset + i] = static_cast<char>((value >> (8 * i)) & 0xff);
+  }
+}
+
+void writeLE64(std::vector<char>& data, size_t offset, uint64_t value) {
+  writeLE32(data, offset, static_cast<uint32_t>(value));
+  writeLE32(data, offset + 4, static_cast<uint32_t>(value >> 32));
+}
+
+size_t getEntryOffset(size_t index) {
+  return kAssetBankHeaderSize + index * kAssetBankEntrySize;
+}
+
+bool writeFile(const std::string& path, const std::vector<char>& data) {
+  FILE* file = std::fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  const bool written = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+  return std::fclose(file) == 0 && written;
+}
+
+/// Add the WAV files of kAssets and an asset that is not a WAV file
+/// \return True if every asset was added
+bool buildBank(AssetBankWriter& writer) {
+  for (const Asset& asset : kAssets) {
+    const std::string path = test::getTempPath(std::string("AssetBankTest_") + asset.name + ".wav");
+    const std::vector<float> tone = test::makeTone(asset.numChannels, kAssetFrames, kSampleRate);
+    const bool added = test::writeWav(path, tone, asset.numChannels, kSampleRate) &&
+        writer.addFile(asset.name, path.c_str()) == EngineError::OK;
+    std::remove(path.c_str());
+    if (!added) {
+      return false;
+    }
+  }
+  return writer.addAsset(kBrokenName, AssetCodec::WAV, 1, std::vector<char>(64, 'x')) ==
+      EngineError::OK;
+}
+
+void testWriter() {
+  AssetBankWriter writer;
+  TBE_CHECK(writer.addAsset("", AssetCodec::WAV, 1, {}) == EngineError::FAIL);
+  TBE_CHECK(
+      writer.addAsset(std::string(kAssetBankNameSize, 'a'), AssetCodec::WAV, 1, {}) ==
+      EngineError::FAIL);
+  TBE_CHECK(
+      writer.addAsset(std::string(kAssetBankNameSize - 1, 'a'), AssetCodec::WAV, 1, {}) ==
+      EngineError::OK);
+  TBE_CHECK(writer.addAsset("a", AssetCodec::OPUS, 1, {}) == EngineError::OK);
+  TBE_CHECK(writer.addAsset("a", AssetCodec::OPUS, 1, {}) == EngineError::FAIL);
+  TBE_CHECK(
+      writer.addFile("b", test::getTempPath("AssetBankTest_missing.wav").c_str()) ==
+      EngineError::ERROR_OPENING_FILE);
+
+  const std::vector<char> bank = writer.build();
+  TBE_CHECK(bank.size() % kAssetBankDataAlignment == 0);
+  TBE_CHECK(std::strcmp(&bank[getEntryOffset(0)], "a") == 0);
+}
+
+void testReader(AssetBank& bank, const std::vector<char>& data) {
+  TBE_CHECK(bank.getNumAssets() == 4);
+  AssetBankEntry entry;
+  for (size_t i = 0; i < 3; ++i) {
+    if (!TBE_CHECK(bank.getAsset(i, entry) == EngineError::OK)) {
+      continue;
+    }
+    TBE_CHECK(std::strcmp(entry.name, kSortedNames[i]) == 0);
+    TBE_CHECK(entry.codec == AssetCodec::WAV);
+    TBE_CHECK(entry.descriptor.offsetInBytes % kAssetBankDataAlignment == 0);
+  }
+  TBE_CHECK(bank.getAsset(4, entry) == EngineError::NO_ASSET);
+
+  for (const Asset& asset : kAssets) {
+    entry = AssetBankEntry();
+    if (TBE_CHECK(bank.findAsset(asset.name, entry) == EngineError::OK)) {
+      TBE_CHECK(std::strcmp(entry.name, asset.name) == 0);
+      TBE_CHECK(entry.numChannels == asset.numChannels);
+    }
+  }
+  TBE_CHECK(bank.findAsset(kBrokenName, entry) == EngineError::OK);
+
+  // Before the first name, after the last, between two names, a prefix of a name, and no name
+  for (const char* name : {"a", "zzz", "tone_b", "tone_a", "ton", ""}) {
+    TBE_CHECK(bank.findAsset(name, entry) == EngineError::NO_ASSET);
+  }
+  TBE_CHECK(bank.findAsset(nullptr, entry) == EngineError::NO_ASSET);
+
+  IOStream* stream = nullptr;
+  if (TBE_CHECK(bank.openStream("tone_stereo", stream) == EngineError::OK)) {
+    TBE_CHECK(bank.findAsset("tone_stereo", entry) == EngineError::OK);
+    TBE_CHECK(stream->getSize() == entry.descriptor.lengthInBytes);
+    size_t numBytes = 0;
+    const void* pointer = stream->getReadPointer(numBytes);
+    TBE_CHECK(numBytes == entry.descriptor.lengthInBytes);
+    TBE_CHECK(
+        pointer != nullptr &&
+        std::memcmp(pointer, &data[entry.descriptor.offsetInBytes], numBytes) == 0);
+    char riff[4] = {};
+    TBE_CHECK(stream->read(riff, sizeof(riff)) == sizeof(riff));
+    TBE_CHECK(std::memcmp(riff, "RIFF", sizeof(riff)) == 0);
+    delete stream;
+  }
+  TBE_CHECK(bank.openStream("missing", stream) == EngineError::NO_ASSET);
+  TBE_CHECK(stream == nullptr);
+}
+
+/// Each corruption of a valid bank is rejected when the bank is opened
+void testIndexValidation(const std::vector<char>& data, const std::string& path) {
+  const uint32_t size = static_cast<uint32_t>(data.size());
+  const std::vector<std::function<void(std::vector<char>&)>> corruptions = {
+      [](std::vector<char>& bank) { bank[0] = 'X'; },
+      [](std::vector<char>& bank) { writeLE32(bank, 4, kAssetBankVersion + 1); },
+      [](std::vector<char>& bank) { writeLE32(bank, 8, 1000); },
+      [](std::vector<char>& bank) { std::strcpy(&bank[getEntryOffset(0)], "tone_zz"); },
+      [](std::vector<char>& bank) { std::strcpy(&bank[getEntryOffset(1)], "tone"); },
+      [](std::vector<char>& bank) { bank[getEntryOffset(1)] = '\0'; },
+      [](std::vector<char>& bank) {
+        std::memset(&bank[getEntryOffset(3)], 'z', kAssetBankNameSize);
+      },
+      [](std::vector<char>& bank) {
+        writeLE64(bank, getEntryOffset(0) + kOffsetField, getEntryOffset(3));
+      },
+      [size](std::vector<char>& bank) {
+        writeLE64(bank, getEntryOffset(2) + kLengthField, size);
+      },
+      [size](std::vector<char>& bank) {
+        writeLE64(bank, getEntryOffset(2) + kOffsetField, size + 1);
+        writeLE64(bank, getEntryOffset(2) + kLengthField, 0);
+      },
+      [](std::vector<char>& bank) {
+        const uint32_t codec = static_cast<uint32_t>(AssetCodec::TBE) + 1;
+        writeLE32(bank, getEntryOffset(0) + kCodecField, codec);
+      },
+      [](std::vector<char>& bank) { bank.resize(getEntryOffset(4) - 1); },
+      [](std::vector<char>& bank) { bank.resize(kAssetBankHeaderSize - 1); },
+  };
+
+  for (const auto& corrupt : corruptions) {
+    std::vector<char> corrupted = data;
+    corrupt(corrupted);
+    AssetBank* bank = nullptr;
+    if (TBE_CHECK(writeFile(path, corrupted))) {
+      TBE_CHECK(TBE_CreateAssetBank(bank, path.c_str()) == EngineError::INVALID_HEADER);
+      TBE_CHECK(bank == nullptr);
+    }
+  }
+
+  AssetBank* bank = nullptr;
+  TBE_CHECK(
+      TBE_CreateAssetBank(bank, test::getTempPath("AssetBankTest_missing.bank").c_str()) ==
+      EngineError::ERROR_OPENING_FILE);
+}
+
+/// Assets opened from the bank play, including after their header has been cached
+void testPlayback(AssetBank* bank) {
+  EngineInitSettings settings;
+  settings.audioSettings.deviceType = AudioDeviceType::DISABLED;
+  settings.audioSettings.sampleRate = kSampleRate;
+  settings.audioSettings.bufferSize = kBufferSize;
+  settings.threads.useDecoderThread = false;
+  settings.threads.useEventThread = false;
+  AudioEngine* engine = nullptr;
+  if (!TBE_CHECK(TBE_CreateAudioEngine(engine, settings) == EngineError::OK)) {
+    return;
+  }
+
+  AudioObject* object = nullptr;
+  TBE_CHECK(engine->createAudioObject(object) == EngineError::OK);
+  AudioObjectExtensions* objectExtensions = TBE_GetAudioObjectExtensions(object);
+  TBE_CHECK(TBE_GetAudioObjectExtensions(nullptr) == nullptr);
+  std::vector<float> mix(kBufferSize * 2);
+  for (int32_t i = 0; i < 2; ++i) {
+    if (!TBE_CHECK(objectExtensions->open(bank, "tone") == EngineError::OK)) {
+      break;
+    }
+    TBE_CHECK(object->getAssetDurationInSamples() == kAssetFrames);
+    TBE_CHECK(object->play() == EngineError::OK);
+    double energy = 0.0;
+    for (int32_t block = 0; block < kMaxBlocks && object->getPlayState() == PlayState::PLAYING;
+         ++block) {
+      TBE_CHECK(
+          engine->getAudioMix(mix.data(), static_cast<int>(mix.size()), 2) == EngineError::OK);
+      for (const float sample : mix) {
+        energy += sample * sample;
+      }
+    }
+    TBE_CHECK(energy > 1.0);
+    TBE_CHECK(object->getPlayState() == PlayState::STOPPED);
+  }
+  TBE_CHECK(objectExtensions->open(bank, "tone_ambix") == EngineError::INVALID_CHANNEL_COUNT);
+  TBE_CHECK(objectExtensions->open(bank, "missing") == EngineError::NO_ASSET);
+  for (int32_t i = 0; i < 2; ++i) {
+    TBE_CHECK(objectExtensions->open(bank, kBrokenName) == EngineError::INVALID_HEADER);
+  }
+  engine->destroyAudioObject(object);
+
+  SpatDecoderFile* spatDecoder = nullptr;
+  TBE_CHECK(engine->createSpatDecoderFile(spatDecoder) == EngineError::OK);
+  SpatDecoderFileExtensions* spatExtensions = TBE_GetSpatDecoderFileExtensions(spatDecoder);
+  TBE_CHECK(TBE_GetSpatDecoderFileExtensions(nullptr) == nullptr);
+  TBE_CHECK(spatExtensions->open(bank, "tone_ambix", ChannelMap::AMBIX_4) == EngineError::OK);
+  TBE_CHECK(spatDecoder->isOpen());
+  TBE_CHECK(spatDecoder->getAssetDurationInSamples() == kAssetFrames);
+  TBE_CHECK(
+      spatExtensions->open(bank, "tone", ChannelMap::AMBIX_4) ==
+      EngineError::INVALID_CHANNEL_COUNT);
+  TBE_CHECK(
+      spatExtensions->open(bank, "tone_stereo", ChannelMap::HEADLOCKED_STEREO) == EngineError::OK);
+  engine->destroySpatDecoderFile(spatDecoder);
+  TBE_DestroyAudioEngine(engine);
+}
+
+/// A decoder created through the AssetBank interface decodes the whole asset after the bank is gone
+void testDecoder(AudioFormatDecoder* decoder) {
+  TBE_CHECK(decoder->getNumOfChannels() == 1);
+  TBE_CHECK(decoder->getNumSamplesPerChannel() == static_cast<size_t>(kAssetFrames));
+  std::vector<float> buffer(kBufferSize);
+  size_t numDecoded = 0;
+  for (int32_t block = 0; block < kMaxBlocks && !decoder->endOfStream(); ++block) {
+    numDecoded += decoder->decode(buffer.data(), kBufferSize);
+  }
+  TBE_CHECK(numDecoded == static_cast<size_t>(kAssetFrames));
+  TBE_CHECK(!decoder->decoderError());
+}
+} // namespace
+
+int main() {
+  testWriter();
+
+  AssetBankWriter writer;
+  const std::string path = test::getTempPath("AssetBankTest.bank");
+  if (!TBE_CHECK(buildBank(writer)) || !TBE_CHECK(writer.write(path.c_str()) == EngineError::OK)) {
+    return test::finish();
+  }
+  const std::vector<char> data = writer.build();
+
+  AssetBank* bank = nullptr;
+  if (TBE_CHECK(TBE_CreateAssetBank(bank, path.c_str()) == EngineError::OK)) {
+    testReader(*bank, data);
+    testPlayback(bank);
+    AudioFormatDecoder* decoder = nullptr;
+    TBE_CHECK(bank->createDecoder(decoder, "tone", kBufferSize, 0.f) == EngineError::OK);
+    AudioFormatDecoder* missing = nullptr;
+    TBE_CHECK(bank->createDecoder(missing, "missing", kBufferSize, 0.f) == EngineError::NO_ASSET);
+    TBE_CHECK(missing == nullptr);
+    delete bank;
+    if (TBE_CHECK(decoder != nullptr)) {
+      testDecoder(decoder);
+      delete decoder;
+    }
+  }
+  testIndexValidation(data, path);
+  std::remove(path.c_str());
+  return test::finish();
+}
@@ -0,0 +1,408 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/include/TBE_AudioEngine.h"
+#include "third_party/facebook/Audio360/include/TBE_AudioEngineExtensions.h"
+#include "third_party/facebook/Audio360/include/TBE_AudioObject.h"
+#include "third_party/facebook/Audio360/test/TestUtils.h"
+
+#include <atomic>
+#include <thread>
+
+using namespace TBE;
+
+namespace {
+const float kSampleRate = 48000.f;
+const int32_t kBufferSize = 512;
+const int32_t kAssetFrames = 24000; /// Half a second
+const int32_t kMaxBlocks = 2000; /// Blocks rendered before giving up on an event
+const int32_t kLongAssetFrames = 48000 * 60; /// Keeps a cache thread busy for a while
+const int32_t kTruncatedFrames = 100;
+const int32_t kVoiceAssetFrames = 48000 * 4; /// Plays through the voice test without ending
+const int32_t kResumeBlocks = 3; /// Blocks for a culled voice to render again, see AudioObjectImpl
+const double kTimingToleranceMs = 1e-3; /// Rounding of the stage timings
+
+struct Events {
+  int32_t count[static_cast<int>(Event::INVALID)] = {};
+
+  int32_t operator[](Event event) const {
+    return count[static_cast<int>(event)];
+  }
+};
+
+void onEvent(Event event, void*, void* userData) {
+  ++static_cast<Events*>(userData)->count[static_cast<int>(event)];
+}
+
+EngineError createEngine(
+    AudioEngine*& engine,
+    bool useDecoderThread,
+    ExtensionSettings extensions = ExtensionSettings()) {
+  EngineInitSettings settings;
+  settings.audioSettings.deviceType = AudioDeviceType::DISABLED;
+  settings.audioSettings.sampleRate = kSampleRate;
+  settings.audioSettings.bufferSize = kBufferSize;
+  settings.threads.useDecoderThread = useDecoderThread;
+  settings.threads.useEventThread = false;
+  settings.extensions = extensions;
+  return TBE_CreateAudioEngine(engine, settings);
+}
+
+/// Play a WAV file to the end through an engine without an audio device
+void testPlayWav(const std::string& path, bool useDecoderThread) {
+  AudioEngine* engine = nullptr;
+  AudioObject* object = nullptr;
+  if (!TBE_CHECK(createEngine(engine, useDecoderThread) == EngineError::OK)) {
+    return;
+  }
+  TBE_CHECK(engine->createAudioObject(object) == EngineError::OK);
+  Events events;
+  object->setEventCallback(onEvent, &events);
+  TBE_CHECK(object->open(path.c_str()) == EngineError::OK);
+  TBE_CHECK(object->isOpen());
+  TBE_CHECK(object->getAssetDurationInSamples() == kAssetFrames);
+  TBE_CHECK(object->play() == EngineError::OK);
+  AudioEngineExtensions* extensions = TBE_GetAudioEngineExtensions(engine);
+  extensions->enableDSPTrace();
+
+  std::vector<float> mix(kBufferSize * 2);
+  double energy = 0.0;
+  int32_t numBlocks = 0;
+  for (; numBlocks < kMaxBlocks && events[Event::END_OF_STREAM] == 0; ++numBlocks) {
+    TBE_CHECK(engine->getAudioMix(mix.data(), static_cast<int>(mix.size()), 2) == EngineError::OK);
+    for (const float sample : mix) {
+      energy += sample * sample;
+    }
+    engine->processEventsOnThisThread();
+    if (useDecoderThread) {
+      // Leave the decoder thread time to keep up, as a real audio device would
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+  }
+
+  TBE_CHECK(events[Event::DECODER_INIT] == 1);
+  TBE_CHECK(events[Event::END_OF_STREAM] == 1);
+  TBE_CHECK(numBlocks >= kAssetFrames / kBufferSize);
+  TBE_CHECK(energy > 1.0);
+  TBE_CHECK(object->getPlayState() == PlayState::STOPPED);
+
+  // The stages are parts of the block
+  const DSPStatistics statistics = extensions->getDSPStatistics();
+  TBE_CHECK(statistics.block.numBlocks == static_cast<uint64_t>(numBlocks));
+  TBE_CHECK(statistics.spatialise.numBlocks == static_cast<uint64_t>(numBlocks));
+  TBE_CHECK(
+      statistics.decode.totalMs + statistics.spatialise.totalMs + statistics.mix.totalMs <=
+      statistics.block.totalMs + kTimingToleranceMs);
+  TBE_CHECK(statistics.numVoices == 1);
+  DSPTraceEntry trace[kDSPTraceSize];
+  const size_t numEntries = extensions->getDSPTrace(trace, kDSPTraceSize);
+  TBE_CHECK(numEntries == static_cast<size_t>(std::min(numBlocks, kDSPTraceSize)));
+  for (size_t i = 0; i < numEntries; ++i) {
+    TBE_CHECK(trace[i].numFrames == kBufferSize);
+    TBE_CHECK(
+        trace[i].decodeMs + trace[i].spatialiseMs + trace[i].mixMs <=
+        trace[i].blockMs + kTimingToleranceMs);
+  }
+
+  // Once stopped, the mix is silent
+  TBE_CHECK(engine->getAudioMix(mix.data(), static_cast<int>(mix.size()), 2) == EngineError::OK);
+  double tail = 0.0;
+  for (const float sample : mix) {
+    tail += sample * sample;
+  }
+  TBE_CHECK(tail == 0.0);
+  TBE_CHECK(!TBE_GetAudioObjectExtensions(object)->getSourceStatistics().active);
+
+  engine->destroyAudioObject(object);
+  TBE_DestroyAudioEngine(engine);
+}
+
+/// Create and destroy objects while another thread renders, so that sources are removed while the
+/// decoder thread and the mixer are using them
+void testCreateAndDestroyWhileRendering(const std::string& path) {
+  AudioEngine* engine = nullptr;
+  if (!TBE_CHECK(createEngine(engine, true) == EngineError::OK)) {
+    return;
+  }
+  std::atomic<bool> quit{false};
+  std::atomic<int32_t> numMixes{0};
+  std::thread audioThread([&] {
+    std::vector<float> mix(kBufferSize * 2);
+    while (!quit) {
+      engine->getAudioMix(mix.data(), static_cast<int>(mix.size()), 2);
+      ++numMixes;
+    }
+  });
+
+  for (int32_t i = 0; i < 200; ++i) {
+    AudioObject* object = nullptr;
+    if (!TBE_CHECK(engine->createAudioObject(object) == EngineError::OK)) {
+      break;
+    }
+    TBE_CHECK(object->open(path.c_str()) == EngineError::OK);
+    object->play();
+    std::this_thread::yield();
+    engine->destroyAudioObject(object);
+  }
+  quit = true;
+  audioThread.join();
+  TBE_CHECK(numMixes > 0);
+  TBE_DestroyAudioEngine(engine);
+}
+
+/// Planar enqueues reject null buffers instead of reading through them
+void testPlanarNullBuffers() {
+  AudioEngine* engine = nullptr;
+  if (!TBE_CHECK(createEngine(engine, false) == EngineError::OK)) {
+    return;
+  }
+  const float left[4] = {};
+  const float* const missingRight[2] = {left, nullptr};
+
+  SpeakersVirtualizer* virtualizer = nullptr;
+  const SpeakerPosition layout[] = {
+      SpeakerPosition::LEFT, SpeakerPosition::RIGHT, SpeakerPosition::END_ENUM};
+  TBE_CHECK(engine->createSpeakersVirtualizer(virtualizer, layout) == EngineError::OK);
+  SpeakersVirtualizerExtensions* speakers = TBE_GetSpeakersVirtualizerExtensions(virtualizer);
+  TBE_CHECK(TBE_GetSpeakersVirtualizerExtensions(nullptr) == nullptr);
+  int32_t numEnqueued = -1;
+  TBE_CHECK(
+      speakers->enqueuePlanarData(static_cast<const float* const*>(nullptr), 4, numEnqueued) ==
+      EngineError::INVALID_BUFFER);
+  TBE_CHECK(numEnqueued == 0);
+  TBE_CHECK(
+      speakers->enqueuePlanarData(missingRight, 4, numEnqueued) == EngineError::INVALID_BUFFER);
+  TBE_CHECK(numEnqueued == 0);
+  engine->destroySpeakersVirtualizer(virtualizer);
+
+  SpatDecoderQueue* queue = nullptr;
+  TBE_CHECK(engine->createSpatDecoderQueue(queue) == EngineError::OK);
+  SpatDecoderQueueExtensions* queueExtensions = TBE_GetSpatDecoderQueueExtensions(queue);
+  TBE_CHECK(
+      queueExtensions->enqueuePlanarData(missingRight, 4, ChannelMap::HEADLOCKED_STEREO) == 0);
+  engine->destroySpatDecoderQueue(queue);
+  TBE_DestroyAudioEngine(engine);
+}
+
+/// Poses are validated and can be queued from several threads while the engine renders
+void testListenerPoses() {
+  AudioEngine* engine = nullptr;
+  if (!TBE_CHECK(createEngine(engine, false) == EngineError::OK)) {
+    return;
+  }
+  AudioEngineExtensions* extensions = TBE_GetAudioEngineExtensions(engine);
+  ListenerPose pose;
+  pose.dspTime = 1;
+  TBE_CHECK(extensions->pushListenerPose(pose) == EngineError::NOT_SUPPORTED);
+  ListenerPoseSettings settings;
+  settings.enabled = true;
+  settings.subBlockSize = -1;
+  TBE_CHECK(extensions->setListenerPoseSettings(settings) == EngineError::INVALID_BUFFER_SIZE);
+  settings.subBlockSize = kBufferSize / 4;
+  TBE_CHECK(extensions->setListenerPoseSettings(settings) == EngineError::OK);
+  TBE_CHECK(extensions->getListenerPoseSettings().subBlockSize == kBufferSize / 4);
+  TBE_CHECK(extensions->pushListenerPose(pose) == EngineError::OK);
+  TBE_CHECK(extensions->pushListenerPose(pose) == EngineError::FAIL);
+
+  // Producers race for the DSP times, so a pose can arrive after a later one and be refused
+  const int32_t kNumProducers = 2;
+  const int32_t kNumPoses = 2000;
+  std::atomic<int64_t> nextTime{2};
+  std::atomic<int32_t> numQueued{0};
+  std::atomic<bool> quit{false};
+  std::thread audioThread([&] {
+    std::vector<float> mix(kBufferSize * 2);
+    while (!quit) {
+      engine->getAudioMix(mix.data(), static_cast<int>(mix.size()), 2);
+    }
+  });
+  std::vector<std::thread> producers;
+  for (int32_t i = 0; i < kNumProducers; ++i) {
+    producers.emplace_back([&] {
+      for (int32_t j = 0; j < kNumPoses; ++j) {
+        ListenerPose next;
+        next.rotation = TBQuat::getQuatFromForwardAndUpVectors(
+            TBVector(std::sin(0.01f * j), 0.f, std::cos(0.01f * j)), TBVector::up());
+        next.dspTime = nextTime++;
+        const EngineError error = extensions->pushListenerPose(next);
+        numQueued += error == EngineError::OK ? 1 : 0;
+        TBE_CHECK(
+            error == EngineError::OK || error == EngineError::FAIL ||
+            error == EngineError::QUEUE_FULL);
+      }
+    });
+  }
+  for (std::thread& producer : producers) {
+    producer.join();
+  }
+  quit = true;
+  audioThread.join();
+  TBE_CHECK(numQueued > 0);
+
+  // The queue can still be full, as the producers may have run after the audio thread's last
+  // block. Render until a block has taken every pose they queued, however far ahead the DSP time.
+  std::vector<float> mix(kBufferSize * 2);
+  int32_t numBlocks = 0;
+  do {
+    engine->getAudioMix(mix.data(), static_cast<int>(mix.size()), 2);
+  } while (++numBlocks < kMaxBlocks && engine->getDSPTime() < nextTime);
+  TBE_CHECK(engine->getDSPTime() >= nextTime);
+  pose.dspTime = nextTime;
+  TBE_CHECK(extensions->pushListenerPose(pose) == EngineError::OK);
+  TBE_DestroyAudioEngine(engine);
+}
+
+/// A culled voice keeps time and resumes in time: its playhead matches that of a voice rendered
+/// throughout, both while culled and once it renders again
+void testVirtualVoiceResume() {
+  ExtensionSettings extensions;
+  extensions.maxActiveVoices = 1;
+  AudioEngine* engine = nullptr;
+  if (!TBE_CHECK(createEngine(engine, false, extensions) == EngineError::OK)) {
+    return;
+  }
+  AudioEngineExtensions* engineExtensions = TBE_GetAudioEngineExtensions(engine);
+  const std::string path = test::getTempPath("AudioEngineTest_voices.wav");
+  TBE_CHECK(
+      test::writeWav(path, test::makeTone(1, kVoiceAssetFrames, kSampleRate), 1, kSampleRate));
+
+  AudioObject* objects[2] = {nullptr, nullptr};
+  AudioObjectExtensions* objectExtensions[2] = {nullptr, nullptr};
+  for (size_t i = 0; i < 2; ++i) {
+    TBE_CHECK(engine->createAudioObject(objects[i]) == EngineError::OK);
+    TBE_CHECK(objects[i]->open(path.c_str()) == EngineError::OK);
+    objectExtensions[i] = TBE_GetAudioObjectExtensions(objects[i]);
+  }
+  objectExtensions[0]->setPriority(1);
+  TBE_CHECK(objectExtensions[0]->getPriority() == 1);
+  objects[0]->play();
+  objects[1]->play();
+
+  std::vector<float> mix(kBufferSize * 2);
+  auto render = [&](int32_t numBlocks) {
+    for (int32_t i = 0; i < numBlocks; ++i) {
+      engine->getAudioMix(mix.data(), static_cast<int>(mix.size()), 2);
+    }
+  };
+  render(10);
+  TBE_CHECK(engineExtensions->getDSPStatistics().numVoices == 1);
+  TBE_CHECK(engineExtensions->getDSPStatistics().numVirtualVoices == 1);
+  TBE_CHECK(objectExtensions[0]->getSourceStatistics().active);
+  TBE_CHECK(!objectExtensions[1]->getSourceStatistics().active);
+  TBE_CHECK(objects[0]->getElapsedTimeInSamples() > 0);
+  TBE_CHECK(objects[1]->getElapsedTimeInSamples() == objects[0]->getElapsedTimeInSamples());
+
+  // The culled voice takes over
+  objectExtensions[1]->setPriority(2);
+  int32_t numBlocks = 0;
+  for (; numBlocks < kMaxBlocks && !objectExtensions[1]->getSourceStatistics().active;
+       ++numBlocks) {
+    render(1);
+  }
+  TBE_CHECK(numBlocks <= kResumeBlocks);
+  TBE_CHECK(!objectExtensions[0]->getSourceStatistics().active);
+  TBE_CHECK(objects[1]->getElapsedTimeInSamples() == objects[0]->getElapsedTimeInSamples());
+  render(10);
+  TBE_CHECK(objectExtensions[1]->getSourceStatistics().active);
+  TBE_CHECK(objects[1]->getElapsedTimeInSamples() == objects[0]->getElapsedTimeInSamples());
+
+  for (AudioObject*& object : objects) {
+    engine->destroyAudioObject(object);
+  }
+  TBE_DestroyAudioEngine(engine);
+  std::remove(path.c_str());
+}
+
+/// Every way of queueing data agrees on the channel maps it accepts: STEREO has no channel count,
+/// so it is rejected, and HEADLOCKED_STEREO is the map for stereo
+void testQueueChannelMaps() {
+  AudioEngine* engine = nullptr;
+  if (!TBE_CHECK(createEngine(engine, false) == EngineError::OK)) {
+    return;
+  }
+  SpatDecoderQueue* queue = nullptr;
+  TBE_CHECK(engine->createSpatDecoderQueue(queue) == EngineError::OK);
+  SpatDecoderQueueExtensions* extensions = TBE_GetSpatDecoderQueueExtensions(queue);
+  const float left[4] = {0.1f, 0.2f, 0.3f, 0.4f};
+  const float right[4] = {-0.1f, -0.2f, -0.3f, -0.4f};
+  const float* const planar[2] = {left, right};
+  const float interleaved[8] = {};
+  QueueWriteRegion regions[2];
+
+  TBE_CHECK(queue->enqueueData(interleaved, 8, ChannelMap::STEREO) == 0);
+  TBE_CHECK(extensions->enqueuePlanarData(planar, 4, ChannelMap::STEREO) == 0);
+  TBE_CHECK(extensions->acquireWrite(ChannelMap::STEREO, 4, regions, 2) == 0);
+  TBE_CHECK(queue->getFreeSpaceInQueue(ChannelMap::STEREO) == 0);
+
+  TBE_CHECK(queue->enqueueData(interleaved, 8, ChannelMap::HEADLOCKED_STEREO) == 8);
+  TBE_CHECK(extensions->enqueuePlanarData(planar, 4, ChannelMap::HEADLOCKED_STEREO) == 4);
+  TBE_CHECK(extensions->acquireWrite(ChannelMap::HEADLOCKED_STEREO, 4, regions, 2) == 4);
+  TBE_CHECK(regions[0].numChannels == 2);
+  TBE_CHECK(extensions->commitWrite(4) == 4);
+  engine->destroySpatDecoderQueue(queue);
+  TBE_DestroyAudioEngine(engine);
+}
+
+/// An asset whose file is cut short while it is queued for the PCM cache fails to decode. The
+/// failure is returned by the next preload, after which the asset is decoded again.
+void testPreloadFailure() {
+  ExtensionSettings extensions;
+  extensions.pcmCacheSizeInBytes = 64 << 20;
+  extensions.numCacheThreads = 1;
+  AudioEngine* engine = nullptr;
+  if (!TBE_CHECK(createEngine(engine, false, extensions) == EngineError::OK)) {
+    return;
+  }
+  AudioEngineExtensions* engineExtensions = TBE_GetAudioEngineExtensions(engine);
+  TBE_CHECK(TBE_GetAudioEngineExtensions(nullptr) == nullptr);
+
+  const std::string longPath = test::getTempPath("AudioEngineTest_long.wav");
+  const std::string path = test::getTempPath("AudioEngineTest_truncated.wav");
+  const std::vector<float> longTone = test::makeTone(1, kLongAssetFrames, kSampleRate);
+  TBE_CHECK(test::writeWav(longPath, longTone, 1, kSampleRate));
+  TBE_CHECK(test::writeWav(path, test::makeTone(1, kAssetFrames, kSampleRate), 1, kSampleRate));
+
+  // The only cache thread decodes the long asset while the other waits behind it
+  TBE_CHECK(engineExtensions->preloadAsset(longPath.c_str()) == EngineError::OK);
+  TBE_CHECK(engineExtensions->preloadAsset(path.c_str()) == EngineError::OK);
+  TBE_CHECK(
+      test::writeWav(path, test::makeTone(1, kTruncatedFrames, kSampleRate), 1, kSampleRate));
+
+  EngineError error = EngineError::OK;
+  for (int32_t i = 0; i < 10000 && error == EngineError::OK; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    error = engineExtensions->preloadAsset(path.c_str());
+  }
+  TBE_CHECK(error == EngineError::FAIL);
+
+  // Decoded again from the file as it is now
+  TBE_CHECK(engineExtensions->preloadAsset(path.c_str()) == EngineError::OK);
+  AudioObject* object = nullptr;
+  TBE_CHECK(engine->createAudioObject(object) == EngineError::OK);
+  TBE_CHECK(object->open(path.c_str()) == EngineError::OK);
+  TBE_CHECK(object->getAssetDurationInSamples() == kTruncatedFrames);
+  engine->destroyAudioObject(object);
+  TBE_DestroyAudioEngine(engine);
+  std::remove(longPath.c_str());
+  std::remove(path.c_str());
+}
+} // namespace
+
+int main() {
+  const std::string path = test::getTempPath("AudioEngineTest.wav");
+  const std::vector<float> tone = test::makeTone(1, kAssetFrames, kSampleRate);
+  if (!TBE_CHECK(test::writeWav(path, tone, 1, kSampleRate))) {
+    return test::finish();
+  }
+  testPlayWav(path, false);
+  testPlayWav(path, true);
+  testCreateAndDestroyWhileRendering(path);
+  testPlanarNullBuffers();
+  testQueueChannelMaps();
+  testPreloadFailure();
+  testListenerPoses();
+  testVirtualVoiceResume();
+  std::remove(path.c_str());
+  return test::finish();
+}
@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/include/TBE_SessionGroup.h"
+#include "third_party/facebook/Audio360/test/TestUtils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace TBE;
+
+namespace {
+const int32_t kBufferSize = 256;
+const int32_t kNumSamples = kBufferSize * 2;
+const double kDeadlineMs = 20.0;
+const int32_t kMaxAttempts = 5000; /// Renders before giving up on a late session finishing
+
+/// Mix callback that holds up the session's render until released
+struct Gate {
+  std::atomic<bool> closed{false};
+  std::atomic<bool> entered{false};
+};
+
+void waitAtGate(float*, size_t, size_t, void* userData) {
+  Gate& gate = *static_cast<Gate*>(userData);
+  gate.entered = true;
+  while (gate.closed) {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+}
+
+SessionGroupSettings makeSettings(int32_t numThreads) {
+  SessionGroupSettings settings;
+  settings.audioSettings.sampleRate = 48000.f;
+  settings.audioSettings.bufferSize = kBufferSize;
+  settings.numThreads = numThreads;
+  return settings;
+}
+
+double getEnergy(const std::vector<float>& buffer) {
+  double energy = 0.0;
+  for (const float sample : buffer) {
+    energy += sample * sample;
+  }
+  return energy;
+}
+
+void testSettings() {
+  SessionGroup* group = nullptr;
+  TBE_CHECK(TBE_CreateSessionGroup(group, makeSettings(0)) == EngineError::INVALID_SETTINGS);
+  TBE_CHECK(group == nullptr);
+  TBE_CHECK(TBE_CreateSessionGroup(group, makeSettings(-1)) == EngineError::INVALID_SETTINGS);
+  SessionGroupSettings settings = makeSettings(1);
+  settings.numCacheThreads = -1;
+  TBE_CHECK(TBE_CreateSessionGroup(group, settings) == EngineError::INVALID_SETTINGS);
+  TBE_CHECK(group == nullptr);
+}
+
+/// Invalid calls are rejected before anything is rendered
+void testInvalidBlocks() {
+  SessionGroup* group = nullptr;
+  if (!TBE_CHECK(TBE_CreateSessionGroup(group, makeSettings(1)) == EngineError::OK)) {
+    return;
+  }
+  AudioEngine* session = nullptr;
+  TBE_CHECK(group->createSession(session) == EngineError::OK);
+  std::vector<float> buffer(kNumSamples * 2, 1.f);
+  SessionBlock block;
+  block.session = session;
+  block.buffer = buffer.data();
+  block.numOfSamples = kNumSamples;
+
+  TBE_CHECK(group->render(&block, 1, -1.0) == EngineError::INVALID_SETTINGS);
+  TBE_CHECK(group->render(&block, 1, std::nan("")) == EngineError::INVALID_SETTINGS);
+  TBE_CHECK(group->render(nullptr, 1, 0.0) == EngineError::INVALID_SETTINGS);
+  block.buffer = nullptr;
+  TBE_CHECK(group->render(&block, 1, 0.0) == EngineError::INVALID_SETTINGS);
+  block.buffer = buffer.data();
+  block.numOfSamples = kNumSamples + 1;
+  TBE_CHECK(group->render(&block, 1, 0.0) == EngineError::INVALID_BUFFER_SIZE);
+  block.numOfSamples = kNumSamples + 2;
+  TBE_CHECK(group->render(&block, 1, 0.0) == EngineError::INVALID_BUFFER_SIZE);
+  block.session = nullptr;
+  block.numOfSamples = kNumSamples;
+  TBE_CHECK(group->render(&block, 1, 0.0) == EngineError::FAIL);
+  TBE_CHECK(buffer[0] == 1.f);
+  TBE_CHECK(session->getDSPTime() == 0);
+  TBE_DestroySessionGroup(group);
+}
+
+/// Every session renders without a deadline, and a session listed twice is busy the second time
+void testRendered() {
+  SessionGroup* group = nullptr;
+  if (!TBE_CHECK(TBE_CreateSessionGroup(group, makeSettings(4)) == EngineError::OK)) {
+    return;
+  }
+  const size_t kNumSessions = 8;
+  std::vector<std::vector<float>> buffers(kNumSessions + 1, std::vector<float>(kNumSamples));
+  std::vector<SessionBlock> blocks(kNumSessions + 1);
+  for (size_t i = 0; i < kNumSessions; ++i) {
+    TBE_CHECK(group->createSession(blocks[i].session) == EngineError::OK);
+    blocks[i].session->enableTestTone(true);
+  }
+  blocks[kNumSessions].session = blocks[0].session;
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    blocks[i].buffer = buffers[i].data();
+    blocks[i].numOfSamples = kNumSamples;
+  }
+  TBE_CHECK(group->getNumSessions() == kNumSessions);
+
+  for (int32_t call = 0; call < 3; ++call) {
+    TBE_CHECK(group->render(blocks.data(), blocks.size(), 0.0) == EngineError::OK);
+    for (size_t i = 0; i < kNumSessions; ++i) {
+      TBE_CHECK(blocks[i].result == SessionBlockResult::RENDERED);
+      TBE_CHECK(getEnergy(buffers[i]) > 0.0);
+    }
+    TBE_CHECK(blocks[kNumSessions].result == SessionBlockResult::BUSY);
+    TBE_CHECK(getEnergy(buffers[kNumSessions]) == 0.0);
+  }
+  TBE_CHECK(blocks[1].session->getDSPTime() == 3 * kBufferSize);
+
+  // Shorter blocks than the buffer size
+  blocks.resize(1);
+  blocks[0].numOfSamples = kNumSamples / 2;
+  TBE_CHECK(group->render(blocks.data(), 1, 0.0) == EngineError::OK);
+  TBE_CHECK(blocks[0].result == SessionBlockResult::RENDERED);
+  TBE_CHECK(blocks[0].session->getDSPTime() == 3 * kBufferSize + kBufferSize / 2);
+  TBE_DestroySessionGroup(group);
+}
+
+/// More sessions queue behind a stuck one than the worker's queue starts with room for. They are
+/// all dropped at the deadline and all render once the worker is free.
+void testManySessions() {
+  SessionGroup* group = nullptr;
+  if (!TBE_CHECK(TBE_CreateSessionGroup(group, makeSettings(1)) == EngineError::OK)) {
+    return;
+  }
+  const size_t kNumSessions = 200;
+  std::vector<std::vector<float>> buffers(kNumSessions, std::vector<float>(kNumSamples));
+  std::vector<SessionBlock> blocks(kNumSessions);
+  for (size_t i = 0; i < kNumSessions; ++i) {
+    TBE_CHECK(group->createSession(blocks[i].session) == EngineError::OK);
+    blocks[i].session->enableTestTone(true);
+    blocks[i].buffer = buffers[i].data();
+    blocks[i].numOfSamples = kNumSamples;
+  }
+  Gate gate;
+  gate.closed = true;
+  blocks[0].session->setAudioMixCallback(waitAtGate, &gate);
+
+  TBE_CHECK(group->render(blocks.data(), blocks.size(), kDeadlineMs) == EngineError::OK);
+  TBE_CHECK(gate.entered);
+  TBE_CHECK(blocks[0].result == SessionBlockResult::LATE);
+  for (size_t i = 1; i < kNumSessions; ++i) {
+    TBE_CHECK(blocks[i].result == SessionBlockResult::DROPPED);
+  }
+
+  gate.closed = false;
+  std::vector<int32_t> numRendered(kNumSessions, 0);
+  for (int32_t attempt = 0;
+       attempt < kMaxAttempts &&
+       std::find(numRendered.begin(), numRendered.end(), 0) != numRendered.end();
+       ++attempt) {
+    TBE_CHECK(group->render(blocks.data(), blocks.size(), 0.0) == EngineError::OK);
+    for (size_t i = 0; i < kNumSessions; ++i) {
+      if (blocks[i].result == SessionBlockResult::RENDERED) {
+        ++numRendered[i];
+      } else {
+        TBE_CHECK(blocks[i].result == SessionBlockResult::BUSY);
+      }
+    }
+  }
+  TBE_CHECK(std::find(numRendered.begin(), numRendered.end(), 0) == numRendered.end());
+  TBE_DestroySessionGroup(group);
+}
+
+/// A session that is still rendering at the deadline is late, then busy until it finishes. A
+/// session queued behind it is cancelled without advancing.
+void testLateBusyAndCancelled() {
+  SessionGroup* group = nullptr;
+  if (!TBE_CHECK(TBE_CreateSessionGroup(group, makeSettings(1)) == EngineError::OK)) {
+    return;
+  }
+  AudioEngine* slow = nullptr;
+  AudioEngine* queued = nullptr;
+  TBE_CHECK(group->createSession(slow) == EngineError::OK);
+  TBE_CHECK(group->createSession(queued) == EngineError::OK);
+  slow->enableTestTone(true);
+  queued->enableTestTone(true);
+  Gate gate;
+  gate.closed = true;
+  slow->setAudioMixCallback(waitAtGate, &gate);
+
+  std::vector<float> slowBuffer(kNumSamples, 1.f);
+  std::vector<float> queuedBuffer(kNumSamples, 1.f);
+  SessionBlock blocks[2];
+  blocks[0].session = slow;
+  blocks[0].buffer = slowBuffer.data();
+  blocks[0].numOfSamples = kNumSamples;
+  blocks[1].session = queued;
+  blocks[1].buffer = queuedBuffer.data();
+  blocks[1].numOfSamples = kNumSamples;
+
+  // The only worker is stuck in the slow session
+  TBE_CHECK(group->render(blocks, 1, kDeadlineMs) == EngineError::OK);
+  TBE_CHECK(blocks[0].result == SessionBlockResult::LATE);
+  TBE_CHECK(gate.entered);
+  TBE_CHECK(getEnergy(slowBuffer) == 0.0);
+
+  TBE_CHECK(group->render(blocks, 2, kDeadlineMs) == EngineError::OK);
+  TBE_CHECK(blocks[0].result == SessionBlockResult::BUSY);
+  TBE_CHECK(blocks[1].result == SessionBlockResult::DROPPED);
+  TBE_CHECK(getEnergy(queuedBuffer) == 0.0);
+  TBE_CHECK(queued->getDSPTime() == 0);
+
+  // Once released, the late block is discarded and both sessions render again. Each stays busy
+  // until the worker has finished with its previous block.
+  gate.closed = false;
+  int32_t numRendered[2] = {0, 0};
+  for (int32_t attempt = 0;
+       attempt < kMaxAttempts && (numRendered[0] == 0 || numRendered[1] == 0);
+       ++attempt) {
+    TBE_CHECK(group->render(blocks, 2, 0.0) == EngineError::OK);
+    for (size_t i = 0; i < 2; ++i) {
+      if (blocks[i].result == SessionBlockResult::RENDERED) {
+        ++numRendered[i];
+        TBE_CHECK(getEnergy(i == 0 ? slowBuffer : queuedBuffer) > 0.0);
+      } else {
+        TBE_CHECK(blocks[i].result == SessionBlockResult::BUSY);
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  TBE_CHECK(numRendered[0] > 0 && numRendered[1] > 0);
+  // The late block advanced the slow session, the cancelled one did not advance the other
+  TBE_CHECK(slow->getDSPTime() == (numRendered[0] + 1) * kBufferSize);
+  TBE_CHECK(queued->getDSPTime() == numRendered[1] * kBufferSize);
+  TBE_DestroySessionGroup(group);
+}
+
+/// Destroying a session or the group waits for a late block to finish
+void testDestroyWhileLate() {
+  SessionGroup* group = nullptr;
+  if (!TBE_CHECK(TBE_CreateSessionGroup(group, makeSettings(2)) == EngineError::OK)) {
+    return;
+  }
+  AudioEngine* session = nullptr;
+  TBE_CHECK(group->createSession(session) == EngineError::OK);
+  Gate gate;
+  gate.closed = true;
+  session->setAudioMixCallback(waitAtGate, &gate);
+  std::vector<float> buffer(kNumSamples);
+  SessionBlock block;
+  block.session = session;
+  block.buffer = buffer.data();
+  block.numOfSamples = kNumSamples;
+  TBE_CHECK(group->render(&block, 1, kDeadlineMs) == EngineError::OK);
+  TBE_CHECK(block.result == SessionBlockResult::LATE);
+
+  std::thread release([&gate] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    gate.closed = false;
+  });
+  group->destroySession(session);
+  TBE_CHECK(session == nullptr);
+  TBE_CHECK(group->getNumSessions() == 0);
+  release.join();
+  TBE_DestroySessionGroup(group);
+  TBE_CHECK(group == nullptr);
+}
+} // namespace
+
+int main() {
+  testSettings();
+  testInvalidBlocks();
+  testRendered();
+  testManySessions();
+  testLateBusyAndCancelled();
+  testDestroyWhileLate();
+  return test::finish();
+}
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/include/TBE_Quat.hh"
+#include "third_party/facebook/Audio360/include/TBE_SpatialBatch.hh"
+#include "third_party/facebook/Audio360/test/TestUtils.h"
+
+#include <random>
+
+using namespace TBE;
+
+namespace {
+/// Batch sizes, so that every SIMD width (1, 4 and 8) is run with and without a remainder
+const size_t kCounts[] = {1, 3, 4, 5, 7, 8, 13, 64, 259};
+const size_t kMaxCount = 259;
+const size_t kNumPoses = 50;
+const float kGuard = -12345.f; /// Written past the end of the outputs, to catch overruns
+const float kMaxGainError = 1.e-6f;
+const float kVerticalDegrees = 89.f; /// Azimuth is not checked above this elevation
+
+struct Attenuation {
+  AttenuationMode mode;
+  AttenuationProps props;
+};
+
+/// The models cover the linear ramp, the factor 1 shortcut, pow() through log2 and exp2, and muting
+const Attenuation kAttenuations[] = {
+    {AttenuationMode::DISABLE, AttenuationProps()},
+    {AttenuationMode::LINEAR, AttenuationProps(1.f, 40.f, 1.f)},
+    {AttenuationMode::LINEAR, AttenuationProps(2.f, 2.f, 1.f)},
+    {AttenuationMode::LOGARITHMIC, AttenuationProps(1.f, 1000.f, 1.f)},
+    {AttenuationMode::LOGARITHMIC, AttenuationProps(0.5f, 30.f, 2.5f)},
+    {AttenuationMode::LOGARITHMIC, AttenuationProps(3.f, 60.f, 0.3f)},
+    {AttenuationMode::LOGARITHMIC, AttenuationProps(1.f, 25.f, 1.f, true)},
+    {AttenuationMode::LINEAR, AttenuationProps(1.f, 25.f, 1.f, true)},
+};
+
+struct Sources {
+  std::vector<float> x, y, z;
+};
+
+/// Outputs of a batch, one element longer than the batch to hold a guard value
+struct Outputs {
+  std::vector<float> azimuth, elevation, distance, gain;
+
+  explicit Outputs(size_t count)
+      : azimuth(count + 1, kGuard),
+        elevation(count + 1, kGuard),
+        distance(count + 1, kGuard),
+        gain(count + 1, kGuard) {}
+};
+
+bool isRelativelyClose(float value, float reference, float tolerance) {
+  return std::fabs(value - reference) <= tolerance * std::max(std::fabs(reference), 1.e-6f);
+}
+
+/// \return Absolute difference between two angles in degrees, allowing for the wrap at +/-180
+float getAngleError(float angle, float reference) {
+  const float error = std::fabs(angle - reference);
+  return std::min(error, 360.f - error);
+}
+
+void checkAed(
+    const TBQuat& listener,
+    const TBVector& listenerPosition,
+    const Sources& sources,
+    size_t count,
+    const Outputs& out) {
+  for (size_t i = 0; i < count; ++i) {
+    // The scalar reference takes the source position before the listener's
+    const Aed reference = TBQuat::getAedFromQuat(
+        listener, TBVector(sources.x[i], sources.y[i], sources.z[i]), listenerPosition);
+    if (std::fabs(reference.elevation) < kVerticalDegrees) {
+      TBE_CHECK(
+          getAngleError(out.azimuth[i], reference.azimuth) <=
+          TBSpatialBatch::angleToleranceDegrees());
+    }
+    TBE_CHECK(
+        std::fabs(out.elevation[i] - reference.elevation) <=
+        TBSpatialBatch::angleToleranceDegrees());
+    TBE_CHECK(isRelativelyClose(
+        out.distance[i], reference.distance, TBSpatialBatch::relativeTolerance()));
+  }
+  TBE_CHECK(out.azimuth[count] == kGuard);
+  TBE_CHECK(out.elevation[count] == kGuard);
+  TBE_CHECK(out.distance[count] == kGuard);
+}
+
+void checkGain(
+    const Attenuation& attenuation,
+    const std::vector<float>& distance,
+    size_t count,
+    const std::vector<float>& gain) {
+  for (size_t i = 0; i < count; ++i) {
+    const float reference =
+        TBSpatialBatch::getAttenuationGain(attenuation.mode, attenuation.props, distance[i]);
+    TBE_CHECK(
+        std::fabs(gain[i] - reference) <= kMaxGainError ||
+        isRelativelyClose(gain[i], reference, TBSpatialBatch::relativeTolerance()));
+  }
+  TBE_CHECK(gain[count] == kGuard);
+}
+
+/// Random listener poses against random sources within 50 metres, through every entry point
+void testRandomScenes() {
+  std::mt19937 generator(1234);
+  std::uniform_real_distribution<float> angle(-3.14159265f, 3.14159265f);
+  std::uniform_real_distribution<float> coordinate(-50.f, 50.f);
+  std::uniform_real_distribution<float> listenerCoordinate(-5.f, 5.f);
+
+  for (size_t pose = 0; pose < kNumPoses; ++pose) {
+    const TBQuat listener =
+        TBQuat::getQuatFromEulerAngles(angle(generator), angle(generator), angle(generator));
+    const float listenerX = listenerCoordinate(generator);
+    const float listenerY = listenerCoordinate(generator);
+    const float listenerZ = listenerCoordinate(generator);
+    const TBVector listenerPosition(listenerX, listenerY, listenerZ);
+    Sources sources;
+    for (size_t i = 0; i < kMaxCount; ++i) {
+      sources.x.push_back(coordinate(generator));
+      sources.y.push_back(coordinate(generator));
+      sources.z.push_back(coordinate(generator));
+    }
+
+    for (const size_t count : kCounts) {
+      Outputs aed(count);
+      TBSpatialBatch::getAedFromQuat(
+          listener,
+          listenerPosition,
+          sources.x.data(),
+          sources.y.data(),
+          sources.z.data(),
+          count,
+          aed.azimuth.data(),
+          aed.elevation.data(),
+          aed.distance.data());
+      checkAed(listener, listenerPosition, sources, count, aed);
+
+      for (const Attenuation& attenuation : kAttenuations) {
+        Outputs out(count);
+        TBSpatialBatch::getAedAndAttenuationGain(
+            listener,
+            listenerPosition,
+            sources.x.data(),
+            sources.y.data(),
+            sources.z.data(),
+            count,
+            attenuation.mode,
+            attenuation.props,
+            out.azimuth.data(),
+            out.elevation.data(),
+            out.distance.data(),
+            out.gain.data());
+        checkAed(listener, listenerPosition, sources, count, out);
+        checkGain(attenuation, out.distance, count, out.gain);
+
+        std::vector<float> gain(count + 1, kGuard);
+        TBSpatialBatch::getAttenuationGain(
+            attenuation.mode, attenuation.props, aed.distance.data(), count, gain.data());
+        checkGain(attenuation, aed.distance, count, gain);
+      }
+    }
+  }
+}
+
+/// Distances around the edges of the attenuation models: zero, the minimum and maximum distances,
+/// and far beyond them
+void testGainEdges() {
+  const std::vector<float> distance = {
+      0.f, 1.e-7f, 0.5f, 1.f, 2.f, 24.999f, 25.f, 25.001f, 40.f, 1000.f, 1.e6f};
+  for (const Attenuation& attenuation : kAttenuations) {
+    std::vector<float> gain(distance.size() + 1, kGuard);
+    TBSpatialBatch::getAttenuationGain(
+        attenuation.mode, attenuation.props, distance.data(), distance.size(), gain.data());
+    checkGain(attenuation, distance, distance.size(), gain);
+  }
+}
+
+/// Sources on the listener's position and straight above it, where the angles are degenerate
+void testDegenerateSources() {
+  const TBQuat listener = TBQuat::getQuatFromEulerAngles(0.3f, -1.2f, 2.f);
+  const TBVector listenerPosition(1.f, 2.f, 3.f);
+  const TBVector up = TBQuat::rotateVectorByQuat(listener, TBVector(0.f, 1.f, 0.f));
+  Sources sources;
+  for (const float scale : {0.f, 1.f, 10.f, -10.f}) {
+    sources.x.push_back(listenerPosition.x + scale * up.x);
+    sources.y.push_back(listenerPosition.y + scale * up.y);
+    sources.z.push_back(listenerPosition.z + scale * up.z);
+  }
+  const size_t count = sources.x.size();
+  Outputs out(count);
+  TBSpatialBatch::getAedFromQuat(
+      listener,
+      listenerPosition,
+      sources.x.data(),
+      sources.y.data(),
+      sources.z.data(),
+      count,
+      out.azimuth.data(),
+      out.elevation.data(),
+      out.distance.data());
+  checkAed(listener, listenerPosition, sources, count, out);
+  for (size_t i = 0; i < count; ++i) {
+    TBE_CHECK(std::isfinite(out.azimuth[i]));
+    TBE_CHECK(std::isfinite(out.elevation[i]));
+  }
+}
+} // namespace
+
+int main() {
+  testRandomScenes();
+  testGainEdges();
+  testDegenerateSources();
+  return test::finish();
+}
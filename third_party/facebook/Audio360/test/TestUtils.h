@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace TBE {
+namespace test {
+/// Number of failed checks so far
+inline int& getNumFailures() {
+  static int numFailures = 0;
+  return numFailures;
+}
+
+inline bool check(bool condition, const char* expression, const char* file, int line) {
+  if (!condition) {
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+    ++getNumFailures();
+  }
+  return condition;
+}
+
+/// \return Exit code of the test: 0, or 1 if a check failed
+inline int finish() {
+  if (getNumFailures() > 0) {
+    std::fprintf(stderr, "%d check(s) failed\n", getNumFailures());
+    return 1;
+  }
+  return 0;
+}
+
+/// \return Path of a file in the test's temporary directory: TEST_TMPDIR under bazel test, or /tmp
+inline std::string getTempPath(const std::string& name) {
+  const char* directory = std::getenv("TEST_TMPDIR");
+  return std::string(directory != nullptr ? directory : "/tmp") + "/" + name;
+}
+
+/// \return Interleaved sine tone at a quarter of full scale, a different frequency per channel
+inline std::vector<float> makeTone(int32_t numChannels, int32_t numFrames, float sampleRate) {
+  std::vector<float> samples(numChannels * numFrames);
+  for (int32_t i = 0; i < numFrames; ++i) {
+    for (int32_t channel = 0; channel < numChannels; ++channel) {
+      const double frequency = 440.0 * (channel + 1);
+      samples[i * numChannels + channel] =
+          0.25f * static_cast<float>(std::sin(2.0 * M_PI * frequency * i / sampleRate));
+    }
+  }
+  return samples;
+}
+
+/// Write interleaved samples as a 16 bit PCM WAV file
+/// \return True if the file was written
+inline bool writeWav(
+    const std::string& path,
+    const std::vector<float>& samples,
+    int32_t numChannels,
+    float sampleRate) {
+  FILE* file = std::fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  const uint32_t rate = static_cast<uint32_t>(sampleRate);
+  const uint32_t dataSize = static_cast<uint32_t>(samples.size() * sizeof(int16_t));
+  const uint16_t blockAlign = static_cast<uint16_t>(numChannels * sizeof(int16_t));
+  auto write32 = [file](uint32_t value) { std::fwrite(&value, sizeof(value), 1, file); };
+  auto write16 = [file](uint16_t value) { std::fwrite(&value, sizeof(value), 1, file); };
+
+  std::fwrite("RIFF", 1, 4, file);
+  write32(36 + dataSize);
+  std::fwrite("WAVEfmt ", 1, 8, file);
+  write32(16);
+  write16(1); // PCM
+  write16(static_cast<uint16_t>(numChannels));
+  write32(rate);
+  write32(rate * blockAlign);
+  write16(blockAlign);
+  write16(16);
+  std::fwrite("data", 1, 4, file);
+  write32(dataSize);
+  for (const float sample : samples) {
+    write16(static_cast<uint16_t>(static_cast<int16_t>(sample * 32767.f)));
+  }
+  return std::fclose(file) == 0;
+}
+} // namespace test
+} // namespace TBE
+
+/// Record a failure, with the expression and its location, if the condition is false
+#define TBE_CHECK(condition) TBE::test::check((condition), #condition, __FILE__, __LINE__)
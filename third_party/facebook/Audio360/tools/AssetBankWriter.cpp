@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/tools/AssetBankWriter.h"
+#include "third_party/facebook/Audio360/include/TBE_AudioEngine.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <strings.h>
+
+namespace TBE {
+namespace {
+const char kMagic[4] = {'T', 'B', 'E', 'B'};
+const size_t kOffsetField = kAssetBankNameSize;
+const size_t kLengthField = kOffsetField + 8;
+const size_t kCodecField = kLengthField + 8;
+const size_t kChannelsField = kCodecField + 4;
+
+void writeLE32(char* data, uint32_t value) {
+  for (size_t i = 0; i < 4; ++i) {
+    data[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+  }
+}
+
+void writeLE64(char* data, uint64_t value) {
+  writeLE32(data, static_cast<uint32_t>(value));
+  writeLE32(data + 4, static_cast<uint32_t>(value >> 32));
+}
+
+bool hasExtension(const std::string& name, const char* extension) {
+  const size_t length = std::char_traits<char>::length(extension);
+  return name.size() >= length && strcasecmp(name.c_str() + name.size() - length, extension) == 0;
+}
+
+AssetCodec getCodec(const std::string& nameAndPath) {
+  if (hasExtension(nameAndPath, ".opus")) {
+    return AssetCodec::OPUS;
+  }
+  if (hasExtension(nameAndPath, ".tbe")) {
+    return AssetCodec::TBE;
+  }
+  return AssetCodec::WAV;
+}
+
+bool readFile(const char* nameAndPath, std::vector<char>& data) {
+  FILE* file = nameAndPath != nullptr ? std::fopen(nameAndPath, "rb") : nullptr;
+  if (file == nullptr) {
+    return false;
+  }
+  char buffer[65536];
+  size_t numRead = 0;
+  while ((numRead = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    data.insert(data.end(), buffer, buffer + numRead);
+  }
+  const bool ok = std::ferror(file) == 0;
+  std::fclose(file);
+  return ok;
+}
+} // namespace
+
+EngineError AssetBankWriter::addAsset(
+    const std::string& name,
+    AssetCodec codec,
+    int32_t numChannels,
+    std::vector<char> data) {
+  const bool used = std::any_of(
+      assets_.begin(), assets_.end(), [&](const Asset& asset) { return asset.name == name; });
+  if (name.empty() || name.size() >= kAssetBankNameSize || name.find('\0') != std::string::npos ||
+      numChannels < 0 || used) {
+    return EngineError::FAIL;
+  }
+  assets_.push_back(Asset{name, codec, numChannels, std::move(data)});
+  return EngineError::OK;
+}
+
+EngineError AssetBankWriter::addFile(const std::string& name, const char* nameAndPath) {
+  std::vector<char> data;
+  if (!readFile(nameAndPath, data)) {
+    return EngineError::ERROR_OPENING_FILE;
+  }
+
+  const AssetCodec codec = getCodec(nameAndPath);
+  int32_t numChannels = 0;
+  if (codec == AssetCodec::WAV) {
+    // Stored in the index so that players can reject an asset without decoding it
+    AudioFormatDecoder* decoder = nullptr;
+    const EngineError error =
+        TBE_CreateAudioFormatDecoderFromHeader(decoder, data.data(), data.size());
+    if (error != EngineError::OK) {
+      return EngineError::INVALID_HEADER;
+    }
+    numChannels = decoder->getNumOfChannels();
+    delete decoder;
+  }
+  return addAsset(name, codec, numChannels, std::move(data));
+}
+
+std::vector<char> AssetBankWriter::build() const {
+  std::vector<const Asset*> sorted;
+  for (const Asset& asset : assets_) {
+    sorted.push_back(&asset);
+  }
+  // The reader binary searches the index with strcmp
+  std::sort(sorted.begin(), sorted.end(), [](const Asset* a, const Asset* b) {
+    return std::strcmp(a->name.c_str(), b->name.c_str()) < 0;
+  });
+
+  auto align = [](size_t offset) {
+    return (offset + kAssetBankDataAlignment - 1) / kAssetBankDataAlignment *
+        kAssetBankDataAlignment;
+  };
+  size_t size = align(kAssetBankHeaderSize + sorted.size() * kAssetBankEntrySize);
+  std::vector<size_t> offsets;
+  for (const Asset* asset : sorted) {
+    offsets.push_back(size);
+    size = align(size + asset->data.size());
+  }
+
+  std::vector<char> bank(size, 0);
+  std::copy(kMagic, kMagic + sizeof(kMagic), bank.begin());
+  writeLE32(&bank[4], kAssetBankVersion);
+  writeLE32(&bank[8], static_cast<uint32_t>(sorted.size()));
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    const Asset& asset = *sorted[i];
+    char* entry = &bank[kAssetBankHeaderSize + i * kAssetBankEntrySize];
+    std::copy(asset.name.begin(), asset.name.end(), entry);
+    writeLE64(entry + kOffsetField, offsets[i]);
+    writeLE64(entry + kLengthField, asset.data.size());
+    writeLE32(entry + kCodecField, static_cast<uint32_t>(asset.codec));
+    writeLE32(entry + kChannelsField, static_cast<uint32_t>(asset.numChannels));
+    std::copy(asset.data.begin(), asset.data.end(), bank.begin() + offsets[i]);
+  }
+  return bank;
+}
+
+EngineError AssetBankWriter::write(const char* nameAndPath) const {
+  FILE* file = nameAndPath != nullptr ? std::fopen(nameAndPath, "wb") : nullptr;
+  if (file == nullptr) {
+    return EngineError::ERROR_OPENING_FILE;
+  }
+  const std::vector<char> bank = build();
+  const bool written = std::fwrite(bank.data(), 1, bank.size(), file) == bank.size();
+  const bool closed = std::fclose(file) == 0;
+  return written && closed ? EngineError::OK : EngineError::ERROR_OPENING_FILE;
+}
+} // namespace TBE
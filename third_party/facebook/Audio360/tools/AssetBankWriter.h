@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#pragma once
+
+#include "third_party/facebook/Audio360/include/TBE_AssetBank.h"
+
+#include <string>
+#include <vector>
+
+namespace TBE {
+/// Alignment of the data of each asset in the banks written by AssetBankWriter
+const size_t kAssetBankDataAlignment = 16;
+
+/// Builds asset banks in the layout read by TBE_CreateAssetBank (see TBE_AssetBank.h). Assets are
+/// added in any order and written sorted by name, each aligned to kAssetBankDataAlignment bytes.
+class AssetBankWriter {
+ public:
+  /// Add an encoded asset.
+  /// \param name Name of the asset. Must be shorter than kAssetBankNameSize and unique.
+  /// \param codec Codec of the asset
+  /// \param numChannels Number of channels of the asset, 0 if unknown
+  /// \param data The encoded asset
+  /// \return EngineError::OK or EngineError::FAIL if the name is empty, too long or already used
+  EngineError
+  addAsset(const std::string& name, AssetCodec codec, int32_t numChannels, std::vector<char> data);
+
+  /// Add an asset from a file. The codec comes from the extension of the path, and the channel
+  /// count from the header of WAV files.
+  /// \param name Name of the asset. \see addAsset
+  /// \param nameAndPath Path to the file
+  /// \return EngineError::OK, EngineError::ERROR_OPENING_FILE, EngineError::INVALID_HEADER if a
+  /// WAV file is malformed or EngineError::FAIL if the name cannot be used
+  EngineError addFile(const std::string& name, const char* nameAndPath);
+
+  /// \return The bank file
+  std::vector<char> build() const;
+
+  /// Write the bank file.
+  /// \return EngineError::OK or EngineError::ERROR_OPENING_FILE
+  EngineError write(const char* nameAndPath) const;
+
+ private:
+  struct Asset {
+    std::string name;
+    AssetCodec codec;
+    int32_t numChannels;
+    std::vector<char> data;
+  };
+
+  std::vector<Asset> assets_;
+};
+} // namespace TBE
@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2018-present, Facebook, Inc.
+ */
+
+#include "third_party/facebook/Audio360/tools/AssetBankWriter.h"
+
+#include <cstdio>
+#include <string>
+
+/// Packs audio files into an asset bank. Each asset is named after its file, without the directory.
+///   make_asset_bank <bank> <file>...
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::fprintf(stderr, "usage: %s <bank> <file>...\n", argv[0]);
+    return 2;
+  }
+
+  TBE::AssetBankWriter writer;
+  for (int i = 2; i < argc; ++i) {
+    const std::string path = argv[i];
+    const std::string name = path.substr(path.find_last_of('/') + 1);
+    const TBE::EngineError error = writer.addFile(name, path.c_str());
+    if (error != TBE::EngineError::OK) {
+      std::fprintf(
+          stderr, "%s: cannot add %s, error %d\n", argv[0], path.c_str(), static_cast<int>(error));
+      return 1;
+    }
+  }
+
+  if (writer.write(argv[1]) != TBE::EngineError::OK) {
+    std::fprintf(stderr, "%s: cannot write %s\n", argv[0], argv[1]);
+    return 1;
+  }
+  return 0;
+}